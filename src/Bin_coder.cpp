@@ -0,0 +1,284 @@
+#include "Bin_coder.hpp"
+
+
+//////////////////////////////////////////////////////////
+// Functions from Range_bin_encoder class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Range_bin_encoder(int contexts_cnt, SPL::OutputBitStream* out);
+Description:
+    Range_bin_encoder class constructors
+*******************************************************************************/
+Range_bin_encoder::Range_bin_encoder(int contexts_cnt, SPL::OutputBitStream* out) 
+  : contexts(contexts_cnt), out(out), low(0), range(0xffffffff), cache(0), cache_size(1) {
+}
+
+
+/*******************************************************************************
+Function: int start();
+Description:
+    Starts the encoder
+*******************************************************************************/
+int Range_bin_encoder::start() {
+    low = 0;
+    range = 0xffffffff;
+    cache = 0;
+    cache_size = 1;
+    return 0;
+}
+
+
+/*******************************************************************************
+Function: int terminate();
+Description:
+    Terminates the encoder. The 32 bits of low and the cached bytes are 
+    written out, so the decoder never reads past the end of the coded data.
+*******************************************************************************/
+int Range_bin_encoder::terminate() {
+    for (int i = 0; i < 5; ++i) {
+        if (shift_low()) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+Function: int shift_low();
+Description:
+    Output the top byte of low. A byte is held back in the cache until it is 
+    known whether a carry will be added to it, the 0xff bytes after the cached 
+    byte are counted by cache_size.
+*******************************************************************************/
+int Range_bin_encoder::shift_low() {
+    if (static_cast<std::uint32_t>(low) < 0xff000000 || (low >> 32) != 0) {
+        std::uint8_t carry = static_cast<std::uint8_t>(low >> 32);
+        std::uint8_t byte = cache;
+        do {
+            if (out->putBits(static_cast<std::uint8_t>(byte + carry), 8) < 0) {
+                return -1;
+            }
+            byte = 0xff;
+        } while (--cache_size != 0);
+        cache = static_cast<std::uint8_t>(low >> 24);
+    }
+    ++cache_size;
+    low = (low & 0x00ffffff) << 8;
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////
+// Functions from Range_bin_decoder class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Range_bin_decoder(int contexts_cnt, SPL::InputBitStream* in);
+Description:
+    Range_bin_decoder class constructors
+*******************************************************************************/
+Range_bin_decoder::Range_bin_decoder(int contexts_cnt, SPL::InputBitStream* in) 
+  : contexts(contexts_cnt), in(in), code(0), range(0xffffffff) {
+}
+
+
+/*******************************************************************************
+Function: void setInput(SPL::InputBitStream* in);
+Description:
+    Set the input bit stream
+*******************************************************************************/
+void Range_bin_decoder::setInput(SPL::InputBitStream* in) {
+    this->in = in;
+}
+
+
+/*******************************************************************************
+Function: int start();
+Description:
+    Starts the decoder, reads the first five bytes of the coded data
+*******************************************************************************/
+int Range_bin_decoder::start() {
+    code = 0;
+    range = 0xffffffff;
+    for (int i = 0; i < 5; ++i) {
+        long byte = in->getBits(8);
+        if (byte < 0) {
+            return -1;
+        }
+        code = (code << 8) | static_cast<std::uint32_t>(byte);
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+Function: int terminate();
+Description:
+    Terminates the decoder. All of the coded data has been read already.
+*******************************************************************************/
+int Range_bin_decoder::terminate() {
+    return 0;
+}
+
+
+//////////////////////////////////////////////////////////
+// Functions from Bin_encoder class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Bin_encoder(int contexts_cnt, SPL::OutputBitStream* out);
+Description:
+    Bin_encoder class constructors
+*******************************************************************************/
+Bin_encoder::Bin_encoder(int contexts_cnt, SPL::OutputBitStream* out) 
+  : type(Bin_coder_type::spl), spl_enc(contexts_cnt, out), range_enc(contexts_cnt, out) {
+}
+
+
+/*******************************************************************************
+Function: void set_coder(Bin_coder_type type);
+Description:
+    Selects the coder
+*******************************************************************************/
+void Bin_encoder::set_coder(Bin_coder_type type) {
+    this->type = type;
+}
+
+
+/*******************************************************************************
+Function: Bin_coder_type get_coder() const;
+Description:
+    Get the selected coder
+*******************************************************************************/
+Bin_coder_type Bin_encoder::get_coder() const {
+    return type;
+}
+
+
+/*******************************************************************************
+Function: int start();
+Description:
+    Starts the selected encoder
+*******************************************************************************/
+int Bin_encoder::start() {
+    return (type == Bin_coder_type::range) ? range_enc.start() : spl_enc.start();
+}
+
+
+/*******************************************************************************
+Function: int encodeBypassBits(std::uint32_t value, int bits_cnt);
+Description:
+    Encode the given No. of low bits of value in bypass mode
+*******************************************************************************/
+int Bin_encoder::encodeBypassBits(std::uint32_t value, int bits_cnt) {
+    if (type == Bin_coder_type::range) {
+        return range_enc.encodeBypassBits(value, bits_cnt);
+    }
+    
+    for (int i = bits_cnt - 1; i >= 0; --i) {
+        int retVal = spl_enc.encodeBypass((value >> i) & 1);
+        if (retVal) {
+            return retVal;
+        }
+    }
+    return 0;
+}
+
+
+/*******************************************************************************
+Function: int terminate();
+Description:
+    Terminates the selected encoder
+*******************************************************************************/
+int Bin_encoder::terminate() {
+    return (type == Bin_coder_type::range) ? range_enc.terminate() : spl_enc.terminate();
+}
+
+
+//////////////////////////////////////////////////////////
+// Functions from Bin_decoder class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Bin_decoder(int contexts_cnt, SPL::InputBitStream* in);
+Description:
+    Bin_decoder class constructors
+*******************************************************************************/
+Bin_decoder::Bin_decoder(int contexts_cnt, SPL::InputBitStream* in) 
+  : type(Bin_coder_type::spl), spl_dec(contexts_cnt, in), range_dec(contexts_cnt, in) {
+}
+
+
+/*******************************************************************************
+Function: void set_coder(Bin_coder_type type);
+Description:
+    Selects the coder
+*******************************************************************************/
+void Bin_decoder::set_coder(Bin_coder_type type) {
+    this->type = type;
+}
+
+
+/*******************************************************************************
+Function: Bin_coder_type get_coder() const;
+Description:
+    Get the selected coder
+*******************************************************************************/
+Bin_coder_type Bin_decoder::get_coder() const {
+    return type;
+}
+
+
+/*******************************************************************************
+Function: void setInput(SPL::InputBitStream* in);
+Description:
+    Set the input bit stream of both decoders
+*******************************************************************************/
+void Bin_decoder::setInput(SPL::InputBitStream* in) {
+    spl_dec.setInput(in);
+    range_dec.setInput(in);
+}
+
+
+/*******************************************************************************
+Function: int start();
+Description:
+    Starts the selected decoder
+*******************************************************************************/
+int Bin_decoder::start() {
+    return (type == Bin_coder_type::range) ? range_dec.start() : spl_dec.start();
+}
+
+
+/*******************************************************************************
+Function: long decodeBypassBits(int bits_cnt);
+Description:
+    Decode the given No. of bits in bypass mode
+*******************************************************************************/
+long Bin_decoder::decodeBypassBits(int bits_cnt) {
+    if (type == Bin_coder_type::range) {
+        return range_dec.decodeBypassBits(bits_cnt);
+    }
+    
+    long value = 0;
+    for (int i = 0; i < bits_cnt; ++i) {
+        int bit = spl_dec.decodeBypass();
+        if (bit < 0) {
+            return -1;
+        }
+        value = (value << 1) | bit;
+    }
+    return value;
+}
+
+
+/*******************************************************************************
+Function: int terminate();
+Description:
+    Terminates the selected decoder
+*******************************************************************************/
+int Bin_decoder::terminate() {
+    return (type == Bin_coder_type::range) ? range_dec.terminate() : spl_dec.terminate();
+}
@@ -0,0 +1,433 @@
+// Bin_coder.hpp
+// Description:
+//     The binary arithmetic coders used for the geometry part of the EB file. 
+//     Bin_encoder and Bin_decoder have the same interface as 
+//     SPL::BinArithEncoder and SPL::BinArithDecoder, and code the bits with 
+//     either the SPL coder or a range coder, which is selected per EB file.
+
+#ifndef bin_coder_hpp
+#define bin_coder_hpp
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <SPL/arithCoder.hpp>
+#include <SPL/bitStream.hpp>
+
+
+/*******************************************************************************
+Enum: Bin_coder_type
+Description:
+    The binary arithmetic coder used for the geometry part of the EB file. 
+    spl: SPL::BinArithEncoder/SPL::BinArithDecoder, which use frequency count 
+         models and a division for each coded bit.
+    range: The range coder of Range_bin_encoder/Range_bin_decoder, which use 
+         shift based probability updates and no divisions.
+    The value is stored in the EB file header.
+*******************************************************************************/
+enum class Bin_coder_type {
+    spl = 0,
+    range = 1
+};
+
+
+/*******************************************************************************
+Structure: Range_bin_context
+Description:
+    The adaptive probability of a zero bit for one context. Two estimates with 
+    a fast and a slow adaptation rate are kept, and their average is used for 
+    coding. Both are 15 bit fixed point numbers that are updated with shifts 
+    only. The first bits coded in a context use faster rates (about 1/(n+2) 
+    for the n-th bit), so the estimates warm up like a frequency count.
+*******************************************************************************/
+struct Range_bin_context {
+    // No. of bits of the probabilities
+    static const int prob_bits = 15;
+    
+    // The adaptation rates (shifts) of the two estimates after the warm up
+    static const int fast_rate = 4;
+    static const int slow_rate = 7;
+    
+    // No. of bits coded before the rates reach fast_rate and slow_rate
+    static const int warm_up_cnt = 64;
+    
+    Range_bin_context() : fast(1 << (prob_bits - 1)), slow(1 << (prob_bits - 1)), cnt(0) {}
+    
+    // The probability of a zero bit
+    std::uint32_t prob() const {
+        return (static_cast<std::uint32_t>(fast) + slow) >> 1;
+    }
+    
+    // Update the probabilities with a coded bit
+    void update(int bit) {
+        int fast_shift = fast_rate, slow_shift = slow_rate;
+        if (cnt < warm_up_cnt) {
+            // The shift closest to log2(cnt + 2)
+            static const std::uint8_t warm_up_shift[warm_up_cnt] = {
+                1, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4,
+                4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+                5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 6, 6, 6, 6,
+                6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
+            };
+            int shift = warm_up_shift[cnt++];
+            fast_shift = std::min(fast_shift, shift);
+            slow_shift = std::min(slow_shift, shift);
+        }
+        if (bit) {
+            fast -= fast >> fast_shift;
+            slow -= slow >> slow_shift;
+        }
+        else {
+            fast += ((1 << prob_bits) - fast) >> fast_shift;
+            slow += ((1 << prob_bits) - slow) >> slow_shift;
+        }
+    }
+    
+    std::uint16_t fast;
+    std::uint16_t slow;
+    std::uint8_t cnt;
+};
+
+
+/*******************************************************************************
+Class: Range_bin_encoder
+Description:
+    A binary range encoder (carry propagating, byte oriented, in the style of 
+    the LZMA range coder). Each regular bit costs one multiplication, the 
+    bypass bits cost a shift. A run of bypass bits is coded in chunks of up to 
+    bypass_chunk_bits bits, each chunk scales the range once.
+*******************************************************************************/
+class Range_bin_encoder {
+public:
+    // A constructor create a Range_bin_encoder object with given parameters
+    // Parameters: 
+    //      contexts_cnt: No. of contexts
+    //      out: The output bit stream
+    Range_bin_encoder(int contexts_cnt, SPL::OutputBitStream* out);
+    
+    // Starts the encoder
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int start();
+    
+    // Encode a bit with the given context
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int encodeRegular(int context_id, int bit) {
+        Range_bin_context& ctx = contexts[context_id];
+        std::uint32_t bound = (range >> Range_bin_context::prob_bits) * ctx.prob();
+        if (bit) {
+            low += bound;
+            range -= bound;
+        }
+        else {
+            range = bound;
+        }
+        ctx.update(bit);
+        return normalize();
+    }
+    
+    // Encode a bit with the probability of 1/2
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int encodeBypass(int bit) {
+        range >>= 1;
+        if (bit) {
+            low += range;
+        }
+        return normalize();
+    }
+    
+    // Encode the given No. of low bits of value with the probability of 1/2, 
+    // from the most significant bit to the least significant bit
+    // Parameters: 
+    //      value: The bits to encode
+    //      bits_cnt: No. of bits to encode, in the range of [0, 31]
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int encodeBypassBits(std::uint32_t value, int bits_cnt) {
+        while (bits_cnt > 0) {
+            int chunk = std::min(bits_cnt, bypass_chunk_bits);
+            bits_cnt -= chunk;
+            range >>= chunk;
+            low += static_cast<std::uint64_t>(range) * ((value >> bits_cnt) & ((1u << chunk) - 1));
+            if (normalize()) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    
+    // Terminates the encoder, and writes out all of the pending bytes
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int terminate();
+    
+private:
+    // Keep the range at least 2^24
+    int normalize() {
+        while (range < top_value) {
+            range <<= 8;
+            if (shift_low()) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    
+    // Output the top byte of low, the carry is propagated through the 
+    // pending 0xff bytes
+    int shift_low();
+    
+    static const std::uint32_t top_value = 1 << 24;
+    
+    // Maximum No. of bypass bits coded with one range scaling, the range 
+    // stays at least 2^16 so the chunk wastes less than 2^-16 bits
+    static const int bypass_chunk_bits = 8;
+    
+    // The contexts
+    std::vector<Range_bin_context> contexts;
+    
+    // The output bit stream
+    SPL::OutputBitStream* out;
+    
+    // The lower end of the interval (33 bits including the carry)
+    std::uint64_t low;
+    
+    // The length of the interval
+    std::uint32_t range;
+    
+    // The byte waiting for the carry, and No. of bytes waiting (the cached 
+    // byte and the 0xff bytes after it)
+    std::uint8_t cache;
+    std::uint64_t cache_size;
+};
+
+
+/*******************************************************************************
+Class: Range_bin_decoder
+Description:
+    The decoder of Range_bin_encoder
+*******************************************************************************/
+class Range_bin_decoder {
+public:
+    // A constructor create a Range_bin_decoder object with given parameters
+    // Parameters: 
+    //      contexts_cnt: No. of contexts
+    //      in: The input bit stream
+    Range_bin_decoder(int contexts_cnt, SPL::InputBitStream* in);
+    
+    // Set the input bit stream
+    void setInput(SPL::InputBitStream* in);
+    
+    // Starts the decoder
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int start();
+    
+    // Decode a bit with the given context
+    // Returns: 
+    //      The decoded bit upon success; otherwise, a negative value
+    int decodeRegular(int context_id) {
+        Range_bin_context& ctx = contexts[context_id];
+        std::uint32_t bound = (range >> Range_bin_context::prob_bits) * ctx.prob();
+        int bit;
+        if (code < bound) {
+            range = bound;
+            bit = 0;
+        }
+        else {
+            code -= bound;
+            range -= bound;
+            bit = 1;
+        }
+        ctx.update(bit);
+        return normalize() ? -1 : bit;
+    }
+    
+    // Decode a bit with the probability of 1/2
+    // Returns: 
+    //      The decoded bit upon success; otherwise, a negative value
+    int decodeBypass() {
+        range >>= 1;
+        int bit = 0;
+        if (code >= range) {
+            code -= range;
+            bit = 1;
+        }
+        return normalize() ? -1 : bit;
+    }
+    
+    // Decode the given No. of bits with the probability of 1/2, the first bit 
+    // decoded is the most significant bit of the result
+    // Parameters: 
+    //      bits_cnt: No. of bits to decode, in the range of [0, 31]
+    // Returns: 
+    //      The decoded bits upon success; otherwise, a negative value
+    long decodeBypassBits(int bits_cnt) {
+        long value = 0;
+        while (bits_cnt > 0) {
+            int chunk = std::min(bits_cnt, bypass_chunk_bits);
+            bits_cnt -= chunk;
+            range >>= chunk;
+            std::uint32_t bits = code / range;
+            if (bits >> chunk) {
+                // The coded data is corrupted
+                return -1;
+            }
+            code -= bits * range;
+            value = (value << chunk) | bits;
+            if (normalize()) {
+                return -1;
+            }
+        }
+        return value;
+    }
+    
+    // Terminates the decoder
+    // Returns: 
+    //      Zero upon success; otherwise, a negative value
+    int terminate();
+    
+private:
+    // Keep the range at least 2^24
+    int normalize() {
+        while (range < top_value) {
+            long byte = in->getBits(8);
+            if (byte < 0) {
+                return -1;
+            }
+            range <<= 8;
+            code = (code << 8) | static_cast<std::uint32_t>(byte);
+        }
+        return 0;
+    }
+    
+    static const std::uint32_t top_value = 1 << 24;
+    
+    // Maximum No. of bypass bits decoded with one range scaling
+    static const int bypass_chunk_bits = 8;
+    
+    // The contexts
+    std::vector<Range_bin_context> contexts;
+    
+    // The input bit stream
+    SPL::InputBitStream* in;
+    
+    // The coded value relative to the lower end of the interval
+    std::uint32_t code;
+    
+    // The length of the interval
+    std::uint32_t range;
+};
+
+
+/*******************************************************************************
+Class: Bin_encoder
+Description:
+    The binary arithmetic encoder of the geometry part. The bits are coded 
+    with the coder selected by set_coder(), SPL::BinArithEncoder by default.
+*******************************************************************************/
+class Bin_encoder {
+public:
+    // A constructor create a Bin_encoder object with given parameters
+    // Parameters: 
+    //      contexts_cnt: No. of contexts
+    //      out: The output bit stream
+    Bin_encoder(int contexts_cnt, SPL::OutputBitStream* out);
+    
+    // Selects the coder, must be called before start()
+    // Parameters: 
+    //      type: The coder type
+    void set_coder(Bin_coder_type type);
+    
+    // Get the selected coder
+    Bin_coder_type get_coder() const;
+    
+    // The same functions as SPL::BinArithEncoder
+    int start();
+    int encodeRegular(int context_id, int bit) {
+        return (type == Bin_coder_type::range) ? range_enc.encodeRegular(context_id, bit) : 
+                                                 spl_enc.encodeRegular(context_id, bit);
+    }
+    int encodeBypass(int bit) {
+        return (type == Bin_coder_type::range) ? range_enc.encodeBypass(bit) : 
+                                                 spl_enc.encodeBypass(bit);
+    }
+    
+    // Encode the given No. of low bits of value in bypass mode, from the most 
+    // significant bit to the least significant bit. The range coder codes the 
+    // bits in chunks, the SPL coder codes them one at a time.
+    // Parameters: 
+    //      value: The bits to encode
+    //      bits_cnt: No. of bits to encode, in the range of [0, 31]
+    // Returns: 
+    //      Zero upon success; otherwise, a nonzero value
+    int encodeBypassBits(std::uint32_t value, int bits_cnt);
+    int terminate();
+    
+private:
+    // The selected coder
+    Bin_coder_type type;
+    
+    // The coders
+    SPL::BinArithEncoder spl_enc;
+    Range_bin_encoder range_enc;
+};
+
+
+/*******************************************************************************
+Class: Bin_decoder
+Description:
+    The binary arithmetic decoder of the geometry part. The bits are decoded 
+    with the coder selected by set_coder(), SPL::BinArithDecoder by default.
+*******************************************************************************/
+class Bin_decoder {
+public:
+    // A constructor create a Bin_decoder object with given parameters
+    // Parameters: 
+    //      contexts_cnt: No. of contexts
+    //      in: The input bit stream
+    Bin_decoder(int contexts_cnt, SPL::InputBitStream* in = nullptr);
+    
+    // Selects the coder, must be called before start()
+    // Parameters: 
+    //      type: The coder type
+    void set_coder(Bin_coder_type type);
+    
+    // Get the selected coder
+    Bin_coder_type get_coder() const;
+    
+    // The same functions as SPL::BinArithDecoder
+    void setInput(SPL::InputBitStream* in);
+    int start();
+    int decodeRegular(int context_id) {
+        return (type == Bin_coder_type::range) ? range_dec.decodeRegular(context_id) : 
+                                                 spl_dec.decodeRegular(context_id);
+    }
+    int decodeBypass() {
+        return (type == Bin_coder_type::range) ? range_dec.decodeBypass() : 
+                                                 spl_dec.decodeBypass();
+    }
+    
+    // Decode the given No. of bits in bypass mode, the first bit decoded is 
+    // the most significant bit of the result
+    // Parameters: 
+    //      bits_cnt: No. of bits to decode, in the range of [0, 31]
+    // Returns: 
+    //      The decoded bits upon success; otherwise, a negative value
+    long decodeBypassBits(int bits_cnt);
+    int terminate();
+    
+private:
+    // The selected coder
+    Bin_coder_type type;
+    
+    // The coders
+    SPL::BinArithDecoder spl_dec;
+    Range_bin_decoder range_dec;
+};
+
+
+// #include "Bin_coder.cpp"
+#endif
@@ -0,0 +1,81 @@
+#include "Binary_mesh_writer.hpp"
+#include <cstring>
+#include <limits>
+
+
+//////////////////////////////////////////////////////////
+// Public functions from Binary_mesh_writer class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Binary_mesh_writer(int fd, std::uint32_t real_size);
+Description:
+    Binary_mesh_writer class constructors
+*******************************************************************************/
+Binary_mesh_writer::Binary_mesh_writer(int fd, std::uint32_t real_size)
+  : writer(fd), real_size(real_size) {
+}
+
+
+/*******************************************************************************
+Function: bool write_header(std::size_t vertices_cnt, std::size_t faces_cnt);
+Description:
+    Write the file header
+*******************************************************************************/
+bool Binary_mesh_writer::write_header(std::size_t vertices_cnt, std::size_t faces_cnt) {
+    if (vertices_cnt > std::numeric_limits<std::uint32_t>::max()) {
+        return false;
+    }
+    
+    Binary_mesh_header header;
+    std::memcpy(header.magic, "EBMB", 4);
+    header.version = 1;
+    header.real_size = real_size;
+    header.index_size = sizeof(std::uint32_t);
+    header.vertices_cnt = vertices_cnt;
+    header.faces_cnt = faces_cnt;
+    
+    writer.write_bytes(&header, sizeof(header));
+    return true;
+}
+
+
+/*******************************************************************************
+Function: void write_vertex(const Point& p);
+Description:
+    Write the vertex coordinates
+*******************************************************************************/
+void Binary_mesh_writer::write_vertex(const Point& p) {
+    if (real_size == sizeof(float)) {
+        float coord[3] = {static_cast<float>(p.x()), static_cast<float>(p.y()), 
+                          static_cast<float>(p.z())};
+        writer.write_bytes(coord, sizeof(coord));
+    }
+    else {
+        double coord[3] = {p.x(), p.y(), p.z()};
+        writer.write_bytes(coord, sizeof(coord));
+    }
+}
+
+
+/*******************************************************************************
+Function: void write_face(const Triangle_facet& tri_label);
+Description:
+    Write the three vertex indices of a triangle face
+*******************************************************************************/
+void Binary_mesh_writer::write_face(const Triangle_facet& tri_label) {
+    std::uint32_t index[3] = {static_cast<std::uint32_t>(tri_label.get_index(0)), 
+                              static_cast<std::uint32_t>(tri_label.get_index(1)), 
+                              static_cast<std::uint32_t>(tri_label.get_index(2))};
+    writer.write_bytes(index, sizeof(index));
+}
+
+
+/*******************************************************************************
+Function: bool flush();
+Description:
+    Write out the buffered data
+*******************************************************************************/
+bool Binary_mesh_writer::flush() {
+    return writer.flush();
+}
@@ -0,0 +1,102 @@
+// Binary_mesh_writer.hpp
+// Description:
+//     The Binary_mesh_writer class writes a triangle mesh in a raw binary 
+//     layout, which can be memory mapped by the program reading the mesh 
+//     instead of parsing an OFF file.
+//
+//     Layout of the binary mesh file (all values in host byte order):
+//         Offset 0: Binary_mesh_header (32 bytes)
+//         Offset 32: vertices_cnt * 3 coordinates (float32 or float64)
+//         Offset 32 + vertices_cnt * 3 * real_size: faces_cnt * 3 vertex 
+//                    indices (uint32)
+//     Every array starts at an offset aligned to the size of its elements.
+
+#ifndef binary_mesh_writer_hpp
+#define binary_mesh_writer_hpp
+
+#include "Utility.hpp"
+#include "Off_writer.hpp"
+#include <cstddef>
+#include <cstdint>
+
+
+/*******************************************************************************
+Structure: Binary_mesh_header
+Description:
+    The header of the binary mesh file
+*******************************************************************************/
+struct Binary_mesh_header {
+    // The file signature: 'E', 'B', 'M', 'B'
+    char magic[4];
+    
+    // The layout version, currently 1
+    std::uint32_t version;
+    
+    // No. of bytes of each vertex coordinate: 4 (float32) or 8 (float64)
+    std::uint32_t real_size;
+    
+    // No. of bytes of each vertex index: 4 (uint32)
+    std::uint32_t index_size;
+    
+    // No. of vertices and faces in the mesh
+    std::uint64_t vertices_cnt;
+    std::uint64_t faces_cnt;
+};
+
+static_assert(sizeof(Binary_mesh_header) == 32, "Binary_mesh_header must not be padded");
+
+
+/*******************************************************************************
+Class: Binary_mesh_writer
+Description:
+    A class uses for writing a triangle mesh in the binary mesh layout. The 
+    header must be written first, then all of the vertices, then all of the 
+    faces.
+    
+Preconditions:
+    The file descriptor must be opened for writing. The file descriptor is not 
+    closed by the Binary_mesh_writer object.
+*******************************************************************************/
+class Binary_mesh_writer {
+public:
+    // A constructor create a Binary_mesh_writer object with given parameter
+    // Parameters: 
+    //      fd: The output file descriptor
+    //      real_size: No. of bytes of each vertex coordinate, 4 or 8
+    Binary_mesh_writer(int fd, std::uint32_t real_size);
+    
+    // Write the file header
+    // Parameters: 
+    //      vertices_cnt: No. of vertices in the mesh
+    //      faces_cnt: No. of faces in the mesh
+    // Returns: 
+    //      Upon success, true is returned; otherwise (the vertex indices do 
+    //      not fit into 32 bits), false is returned
+    bool write_header(std::size_t vertices_cnt, std::size_t faces_cnt);
+    
+    // Write the vertex coordinates
+    // Parameters: 
+    //      p: The vertex coordinates
+    void write_vertex(const Point& p);
+    
+    // Write the three vertex indices of a triangle face
+    // Parameters: 
+    //      tri_label: The triangle's three vertices index
+    void write_face(const Triangle_facet& tri_label);
+    
+    // Write out the buffered data
+    // Returns: 
+    //      Upon success, true is returned; otherwise, false is returned
+    bool flush();
+    
+private:
+    // The buffered output
+    Off_writer writer;
+    
+    // No. of bytes of each vertex coordinate
+    std::uint32_t real_size;
+};
+
+
+// #include "Binary_mesh_writer.cpp"
+#endif
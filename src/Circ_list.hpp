@@ -1,28 +1,42 @@
 // Circ_list.hpp
 // Description:
 //     This head file includes the circular doubly linked list data structure 
-//     which is used by the decompression program.
+//     which is used by the decompression program. The nodes of all lists are 
+//     stored in a shared node pool (a single vector), and linked by their 
+//     index in the pool.
 
 #ifndef circlist_hpp
 #define circlist_hpp
 
 #include <iostream>
+#include <vector>
+#include <cstdint>
 
 
 // Forward classes declaration
+template <class> class Circ_pool;
 template <class> class Circ_list;
 template <class> class Circ_list_circulator;
 template <class> class Circ_list_const_circulator;
 
 
+// The node index used to represent a null node (e.g. the head of an empty list
+// or the end of the free list)
+const std::int32_t null_node = -1;
+
+
 /*******************************************************************************
 Class: Circ_node
 Description:
-    The circular doubly linked list node class.
+    The circular doubly linked list node class. A node refers to its previous
+    and next node by their index in the node pool.
 *******************************************************************************/
 template <class T>
 class Circ_node {
 public:    
+    // Friend node pool class
+    friend class Circ_pool<T>;
+    
     // Friend circular doubly linked list class
     friend class Circ_list<T>;
     
@@ -37,24 +51,77 @@ private:
     // The node's data
     T data;
     
-    // The previous node
-    Circ_node<T>* prev;
+    // The index of the previous node
+    std::int32_t prev;
     
-    // The next node
-    Circ_node<T>* next;
+    // The index of the next node (also links the free nodes in the pool)
+    std::int32_t next;
     
     
     // A constructor create a Circ_node object with given parameters
     // Parameters: 
     //      val: The circ_node value
     Circ_node(T val);
+};
+
+
+/*******************************************************************************
+Class: Circ_pool
+Description:
+    The node pool shared by the circular doubly linked lists. All nodes are 
+    stored in a single vector, the released nodes are kept in a free list and 
+    reused by the later insertions. So the lists do not allocate memory once 
+    the pool is large enough. The nodes can be moved between the lists using 
+    the same pool in O(1) time.
+*******************************************************************************/
+template <class T>
+class Circ_pool {
+public:
+    // Friend circular doubly linked list class
+    friend class Circ_list<T>;
     
-    // A constructor create a Circ_node object with given parameters
+    // Friend circulator class for circular doubly linked list class 
+    friend class Circ_list_circulator<T>;
+    
+    // Friend constant circulator class for circular doubly linked list class 
+    friend class Circ_list_const_circulator<T>;
+    
+    // Default constructor create an empty pool
+    Circ_pool();
+    
+    // Requests the pool capacity to be at least enough to contain count nodes
     // Parameters: 
-    //      val: The circ_node value
-    //      prev_node: The previous circ_node
-    //      next_node: The next circ_node
-    Circ_node(T val, Circ_node<T>* prev_node, Circ_node<T>* next_node);
+    //      count: The No. of nodes
+    void reserve(int count);
+    
+    // Returns the No. of nodes allocated from the pool (including the free 
+    // nodes)
+    int size() const;
+    
+    
+private:
+    // All nodes in the pool
+    std::vector<Circ_node<T>> nodes;
+    
+    // The first node of the free list
+    std::int32_t free_head;
+    
+    // Copy constructor and copy assignment operator, the lists refer to the 
+    // pool by address
+    Circ_pool(const Circ_pool<T>& c) = delete;
+    Circ_pool<T>& operator=(const Circ_pool<T>& c) = delete;
+    
+    // Gets a node from the free list (or appends a new node to the pool)
+    // Parameters: 
+    //      value: The node value
+    // Returns:
+    //      The index of the node
+    std::int32_t allocate(T value);
+    
+    // Returns all nodes of a circular list to the free list
+    // Parameters: 
+    //      head: Any node of the circular list
+    void release_loop(std::int32_t head);
 };
 
 
@@ -73,15 +140,16 @@ public:
     using Circulator = Circ_list_circulator<T>;
     using Const_circulator = Circ_list_const_circulator<T>;
     
-    // Default constructor create an empty container, with no elements
+    // Default constructor create an empty container, with no elements. The 
+    // list takes the node pool of the first list spliced into it
     Circ_list();
     
-    // A constructor create a Circ_list object with given parameters
+    // A constructor create an empty Circ_list object with the given node pool
     // Parameters: 
-    //      circ_node: A doubly linked node 
-    Circ_list(Circ_node<T>* node);
+    //      node_pool: The node pool used by the list
+    explicit Circ_list(Circ_pool<T>& node_pool);
     
-    // Copy constructor
+    // Copy constructor. The new list refers to the same nodes as list c
     Circ_list(const Circ_list<T>& c);
     
     // Move constructor
@@ -145,7 +213,8 @@ public:
     
     // Transfers the elements in the range [first, last) from Circ_list C into 
     // this list, inserting them before the element pointed by circulator pos
-    // No destructor or copy constructors are called
+    // No destructor or copy constructors are called. Both lists must use the 
+    // same node pool, the nodes are relinked in O(1) time
     // Parameters: 
     //      pos: Circulator pointing to the position where the elements of C are 
     //           inserted. pos must point to an element contained by this list
@@ -159,8 +228,11 @@ public:
 
 
 private:
-    // The head node of the circular doubly linked list
-	Circ_node<T>* head;
+    // The node pool used by the list
+    Circ_pool<T>* pool;
+    
+    // The index of the head node of the circular doubly linked list
+	std::int32_t head;
     
     // The length of the list
     int length;
@@ -186,16 +258,18 @@ public:
     friend class Circ_list_const_circulator<T>;
     
     // Constructor
-	Circ_list_circulator() {}
+	Circ_list_circulator() : pool(nullptr), cur_node(null_node) {}
     
     // A constructor create a circulator object with given parameters
     // Parameters: 
-    //      node: A pointer pointing to the circular node
-	Circ_list_circulator(Circ_node<T>* node) : cur_node(node) {}
+    //      node_pool: The node pool of the list
+    //      node: The index of the circular node
+	Circ_list_circulator(Circ_pool<T>* node_pool, std::int32_t node) 
+      : pool(node_pool), cur_node(node) {}
     
     // Copy constructor
     Circ_list_circulator(const Circ_list_circulator& other)
-      : cur_node(other.cur_node) {}
+      : pool(other.pool), cur_node(other.cur_node) {}
     
     // Destructor
 	~Circ_list_circulator() {}
@@ -222,8 +296,11 @@ public:
     
     
 private:
-    // The circulator for the circular doubly linked list class
-    Circ_node<T>* cur_node;
+    // The node pool of the list
+    Circ_pool<T>* pool;
+    
+    // The circulator for the circular doubly linked list class (node index)
+    std::int32_t cur_node;
 };
 
 
@@ -240,22 +317,24 @@ public:
     friend class Circ_list<T>;
     
     // Constructor
-	Circ_list_const_circulator() {}
+	Circ_list_const_circulator() : pool(nullptr), cur_node(null_node) {}
     
     // A constructor create a constant circulator object with given parameters
     // Parameters: 
-    //      node: A pointer pointing to the circ_node  
-	Circ_list_const_circulator(Circ_node<T>* node): cur_node(node) {}
+    //      node_pool: The node pool of the list
+    //      node: The index of the circ_node  
+	Circ_list_const_circulator(const Circ_pool<T>* node_pool, std::int32_t node)
+      : pool(node_pool), cur_node(node) {}
     
     // A constructor create a constant circulator object with given parameters
     // Parameters: 
     //      other: A pointer pointing to the  regular circulator 
 	Circ_list_const_circulator(Circ_list_circulator<T> other)
-      : cur_node(other.cur_node) {}
+      : pool(other.pool), cur_node(other.cur_node) {}
     
     // Copy constructor
     Circ_list_const_circulator(const Circ_list_const_circulator& other)
-      : cur_node(other.cur_node) {}    
+      : pool(other.pool), cur_node(other.cur_node) {}    
     
     // Destructor
 	~Circ_list_const_circulator() {}
@@ -282,8 +361,12 @@ public:
 
     
 private:
-    // The constant circulator for the circular doubly linked list class
-    Circ_node<T>* cur_node;
+    // The node pool of the list
+    const Circ_pool<T>* pool;
+    
+    // The constant circulator for the circular doubly linked list class (node 
+    // index)
+    std::int32_t cur_node;
 };
 
 
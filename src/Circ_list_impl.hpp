@@ -13,17 +13,79 @@ Description:
     Circ_list class constructor
 *******************************************************************************/
 template <class T>
-Circ_node<T>::Circ_node(T val) : data(val), prev(nullptr), next(nullptr) {}
+Circ_node<T>::Circ_node(T val) : data(val), prev(null_node), next(null_node) {}
 
 
+
+//////////////////////////////////////////////////////////
+// A node pool class 
+//////////////////////////////////////////////////////////
+
 /*******************************************************************************
-Function: Circ_node(T val, Circ_node<T>* prev_node, Circ_node<T>* next_node);
+Function: Circ_pool();
 Description:
-    Circ_list class constructor
+    Circ_pool class default constructor
+*******************************************************************************/
+template <class T>
+Circ_pool<T>::Circ_pool() : free_head(null_node) {}
+
+
+/*******************************************************************************
+Function: void reserve(int count);
+Description:
+    Requests the pool capacity to be at least enough to contain count nodes
 *******************************************************************************/
 template <class T>
-Circ_node<T>::Circ_node(T val, Circ_node<T>* prev_node, Circ_node<T>* next_node)
-  : data(val), prev(prev_node), next(next_node) {}
+void Circ_pool<T>::reserve(int count) {
+    nodes.reserve(count);
+}
+
+
+/*******************************************************************************
+Function: int size() const;
+Description:
+    Returns the No. of nodes allocated from the pool (including the free nodes)
+*******************************************************************************/
+template <class T>
+int Circ_pool<T>::size() const {
+    return nodes.size();
+}
+
+
+/*******************************************************************************
+Function: std::int32_t allocate(T value);
+Description:
+    Gets a node from the free list, a new node is appended to the pool only if 
+    the free list is empty. The links of the returned node are not set.
+*******************************************************************************/
+template <class T>
+std::int32_t Circ_pool<T>::allocate(T value) {
+    if (free_head == null_node) {
+        nodes.push_back(Circ_node<T>(value));
+        return nodes.size() - 1;
+    }
+    
+    std::int32_t node = free_head;
+    free_head = nodes[node].next;
+    nodes[node].data = value;
+    
+    return node;
+}
+
+
+/*******************************************************************************
+Function: void release_loop(std::int32_t head);
+Description:
+    Returns all nodes of a circular list to the free list. The circle is cut 
+    before the head node and linked to the front of the free list, so it takes
+    O(1) time regardless of the list length.
+*******************************************************************************/
+template <class T>
+void Circ_pool<T>::release_loop(std::int32_t head) {
+    std::int32_t tail = nodes[head].prev;
+    nodes[tail].next = free_head;
+    free_head = head;
+}
 
 
 
@@ -37,25 +99,17 @@ Description:
     Circ_list class default constructor
 *******************************************************************************/
 template <class T>
-Circ_list<T>::Circ_list() : head(nullptr), length(0) {}
+Circ_list<T>::Circ_list() : pool(nullptr), head(null_node), length(0) {}
 
 
 /*******************************************************************************
-Function: Circ_list(Circ_node<T>* node);
+Function: Circ_list(Circ_pool<T>& node_pool);
 Description:
     Circ_list class constructor
 *******************************************************************************/
 template <class T>
-Circ_list<T>::Circ_list(Circ_node<T>* node) : head(node) {
-    Circ_node<T>* current = head -> next;
-    
-    // Update the list length
-    length = 1;
-    while (current != head) {
-        ++length;
-        current = current -> next;
-    }
-}
+Circ_list<T>::Circ_list(Circ_pool<T>& node_pool) 
+  : pool(&node_pool), head(null_node), length(0) {}
 
 
 /*******************************************************************************
@@ -64,7 +118,8 @@ Description:
     Circ_list class copy constructor
 *******************************************************************************/
 template <class T>
-Circ_list<T>::Circ_list(const Circ_list<T>& c) : head(c.head), length(c.length) {}
+Circ_list<T>::Circ_list(const Circ_list<T>& c) 
+  : pool(c.pool), head(c.head), length(c.length) {}
 
 
 /*******************************************************************************
@@ -73,7 +128,7 @@ Description:
     Circ_list class move constructor
 *******************************************************************************/
 template <class T>
-Circ_list<T>::Circ_list(Circ_list<T>&& c) : head(nullptr), length(0) {
+Circ_list<T>::Circ_list(Circ_list<T>&& c) : pool(c.pool), head(null_node), length(0) {
     // Swap the current list with list c
     std::swap(head, c.head);
     std::swap(length, c.length);
@@ -88,10 +143,10 @@ Description:
 template <class T>
 Circ_list<T>& Circ_list<T>::operator=(Circ_list<T>&& c) {
     // Clear current list
-    head = nullptr;
-    length = 0;
+    clear();
     
     // Swap the current list with list c
+    pool = c.pool;
     std::swap(head, c.head);
     std::swap(length, c.length);
 	return *this;
@@ -101,31 +156,10 @@ Circ_list<T>& Circ_list<T>::operator=(Circ_list<T>&& c) {
 /*******************************************************************************
 Function: ~Circ_list();
 Description:
-    Circ_list class destructor
+    Circ_list class destructor. The nodes are owned by the node pool.
 *******************************************************************************/
 template <class T>
 Circ_list<T>::~Circ_list() {
-    // clear();
-    
-    // if (length == 0) {
-        // return;
-    // }
-    
-    // Circ_node<T>* current = head;
-    // while (length != 1) {
-        // Circ_node<T>* next_node = current -> next;
-        
-        // next_node -> prev = current -> prev;
-        // current -> prev -> next = current;
-        
-        // delete current;
-        // --length;
-        
-        // current = next_node;
-    // }
-    
-    // current = nullptr;
-    // length = 0;
 }
 
 
@@ -154,37 +188,17 @@ int Circ_list<T>::size() const {
 /*******************************************************************************
 Function: void clear();
 Description:
-    Removes all elements from the list and leaving the list with a size of 0
+    Removes all elements from the list and leaving the list with a size of 0.
+    The nodes are returned to the node pool.
 *******************************************************************************/
 template <class T>
 void Circ_list<T>::clear() {
-    if (length == 0) {
-        // List is empty
-        head = nullptr;
-        return;
-    }
-    else {
-        Circ_node<T>* del_node = head;
-        
-        while (length != 1) {
-            Circ_node<T>* next_node = del_node -> next;
-            
-            next_node -> prev = del_node -> prev;
-            del_node -> prev -> next = next_node;
-            
-            delete del_node;
-            --length;
-
-            del_node = next_node;
-        }
-        
-        delete del_node;
-        
-        assert(length == 1);
-        --length;
-        
-        head = nullptr;
+    if (length != 0) {
+        pool -> release_loop(head);
     }
+    
+    head = null_node;
+    length = 0;
 }
 
 
@@ -195,18 +209,21 @@ Description:
 *******************************************************************************/
 template <class T>
 void Circ_list<T>::push_back(T value) {
+    std::int32_t insert_node = pool -> allocate(value);
+    std::vector<Circ_node<T>>& nodes = pool -> nodes;
+    
     if (length == 0) {
         // Push back to an empty list
-        head = new Circ_node<T>(value);
-        head -> prev = head -> next = head;
+        head = insert_node;
+        nodes[head].prev = nodes[head].next = head;
         ++length;
     }
     else {
-        Circ_node<T>* insert_node = new Circ_node<T>(value);
-        insert_node -> prev = head -> prev;
-        insert_node -> next = head;
-        head -> prev -> next = insert_node;
-        head -> prev = insert_node;
+        std::int32_t tail = nodes[head].prev;
+        nodes[insert_node].prev = tail;
+        nodes[insert_node].next = head;
+        nodes[tail].next = insert_node;
+        nodes[head].prev = insert_node;
         ++length;
     }
 }
@@ -223,34 +240,35 @@ typename Circ_list<T>::Circulator Circ_list<T>::erase(Const_circulator pos) {
     }
     else if (length == 1) {
         if (pos.cur_node == head) {
-            head = nullptr;
+            pool -> release_loop(head);
+            head = null_node;
             length = 0;
             
-            return Circ_list_circulator<T>(head);
+            return Circ_list_circulator<T>(pool, head);
         }
         else {
             std::cerr << "ERROR: Invalid erase position!\n";
         }
     }
     
-    Circ_node<T>* current = pos.cur_node; 
-    Circ_node<T>* return_node = current -> next; 
+    std::vector<Circ_node<T>>& nodes = pool -> nodes;
+    std::int32_t current = pos.cur_node; 
+    std::int32_t return_node = nodes[current].next; 
+    std::int32_t prev_node = nodes[current].prev;
+    
+    nodes[prev_node].next = return_node;
+    nodes[return_node].prev = prev_node;
     
     if (current == head) {
-        head -> prev -> next = return_node;
-        return_node -> prev = head -> prev;
-        
         head = return_node;
     }
-    else {
-        current -> prev -> next = return_node;
-        return_node -> prev = current -> prev;
-    }
     
-    delete current;
+    // Return the node to the pool
+    nodes[current].next = pool -> free_head;
+    pool -> free_head = current;
     --length;
     
-    return Circ_list_circulator<T>(return_node);
+    return Circ_list_circulator<T>(pool, return_node);
 }
 
 
@@ -262,42 +280,35 @@ Description:
 *******************************************************************************/
 template <class T>
 typename Circ_list<T>::Circulator Circ_list<T>::insert(Const_circulator pos, T value) {
+    std::int32_t insert_node = pool -> allocate(value);
+    std::vector<Circ_node<T>>& nodes = pool -> nodes;
+    
     // Insert into empty list
     if (length == 0) {
         // Ignore the pos parameter
-        head = new Circ_node<T>(value);
-        head -> prev = head -> next = head;
+        head = insert_node;
+        nodes[head].prev = nodes[head].next = head;
         ++length;
         
-        return Circ_list_circulator<T>(head);
+        return Circ_list_circulator<T>(pool, head);
     }
     
     // Insert into non-empty list
-    Circ_node<T>* current = pos.cur_node; 
-    Circ_node<T>* insert_node = new Circ_node<T>(value);
+    std::int32_t current = pos.cur_node; 
+    std::int32_t prev_node = nodes[current].prev;
+    
+    // Update links
+    nodes[insert_node].prev = prev_node;
+    nodes[insert_node].next = current;
+    nodes[prev_node].next = insert_node;
+    nodes[current].prev = insert_node;
+    ++length;
     
     if (current == head) {
-        insert_node -> prev = head -> prev;
-        insert_node -> next = head;
-        head -> prev -> next = insert_node;
-        head -> prev = insert_node;
-        
-        ++length;
-        // head = head -> prev;
-        
-        return Circ_list_circulator<T>(head);
+        return Circ_list_circulator<T>(pool, head);
     }
     else {
-        // Update links
-        insert_node -> prev = current -> prev;
-        insert_node -> next = current;
-        current -> prev -> next = insert_node;
-        current -> prev = insert_node;
-        
-        ++length;
-        current = current -> prev;
-
-        return Circ_list_circulator<T>(current); 
+        return Circ_list_circulator<T>(pool, insert_node); 
     }
 }
 
@@ -309,7 +320,7 @@ Description:
 *******************************************************************************/
 template <class T>
 typename Circ_list<T>::Circulator Circ_list<T>::begin() {
-    return Circ_list_circulator<T>(head);
+    return Circ_list_circulator<T>(pool, head);
 }
 
 
@@ -320,7 +331,7 @@ Description:
 *******************************************************************************/
 template <class T>
 typename Circ_list<T>::Const_circulator Circ_list<T>::begin() const {
-    return Circ_list_const_circulator<T>(head);
+    return Circ_list_const_circulator<T>(pool, head);
 }
 
 
@@ -336,12 +347,13 @@ void Circ_list<T>::print(std::ostream& ofile_stream) const {
         return;
     }
     
-    Circ_node<T>* current = head;
-    ofile_stream << current -> data << " ";
+    const std::vector<Circ_node<T>>& nodes = pool -> nodes;
+    std::int32_t current = head;
+    ofile_stream << nodes[current].data << " ";
     
-    while(current -> next != head) {
-        current = current -> next;
-        ofile_stream << current -> data << " ";
+    while(nodes[current].next != head) {
+        current = nodes[current].next;
+        ofile_stream << nodes[current].data << " ";
     }
     
     ofile_stream << "\n";
@@ -354,38 +366,50 @@ Function: void splice(Const_circulator pos, Circ_list& c, Const_circulator first
 Description:
     Transfers the elements in the range [first, last) from Circ_list C into 
     this list, inserting them before the element pointed by circulator pos. 
+    The count is only used to update the list lengths, the range is never 
+    walked.
 *******************************************************************************/
 template <class T>
 void Circ_list<T>::splice(Const_circulator pos, Circ_list& c, Const_circulator first, 
 Const_circulator last, int count) {
-    Circ_node<T>* end = last.cur_node -> prev;
+    // Splice into a list without node pool
+    if (pool == nullptr) {
+        pool = c.pool;
+    }
+    assert(pool == c.pool);
+    
+    std::vector<Circ_node<T>>& nodes = pool -> nodes;
+    std::int32_t first_node = first.cur_node;
+    std::int32_t last_node = last.cur_node;
+    std::int32_t end = nodes[last_node].prev;
     
     // Update inside c list
-    first.cur_node -> prev -> next = last.cur_node;
-    last.cur_node -> prev = first.cur_node -> prev;
+    nodes[nodes[first_node].prev].next = last_node;
+    nodes[last_node].prev = nodes[first_node].prev;
     c.length -= count;
-    c.head = last.cur_node;
+    c.head = last_node;
     
     // Update the current list
     if (length == 0) {
         // Splice into an empty list
-        head = first.cur_node;
-        first.cur_node -> prev = end;
-        end -> next = first.cur_node;
+        head = first_node;
+        nodes[first_node].prev = end;
+        nodes[end].next = first_node;
         length += count;
         
         return;
     }
     
-    first.cur_node -> prev = pos.cur_node -> prev;
-    end -> next = pos.cur_node;
-    pos.cur_node -> prev -> next = first.cur_node;
-    pos.cur_node -> prev = end;
+    std::int32_t pos_node = pos.cur_node;
+    nodes[first_node].prev = nodes[pos_node].prev;
+    nodes[end].next = pos_node;
+    nodes[nodes[pos_node].prev].next = first_node;
+    nodes[pos_node].prev = end;
     length += count;
     
     // Update the head node
-    if(pos.cur_node == head) {
-        head = first.cur_node;
+    if(pos_node == head) {
+        head = first_node;
     }
 }
 
@@ -401,7 +425,7 @@ Description:
 *******************************************************************************/
 template <class T>
 Circ_list_circulator<T>& Circ_list_circulator<T>::operator++() {
-    cur_node = cur_node -> next;
+    cur_node = pool -> nodes[cur_node].next;
     return *this;
 }
 
@@ -413,7 +437,7 @@ Description:
 *******************************************************************************/
 template <class T>
 Circ_list_circulator<T>& Circ_list_circulator<T>::operator--() {
-    cur_node = cur_node -> prev;
+    cur_node = pool -> nodes[cur_node].prev;
     return *this;
 }
 
@@ -425,7 +449,7 @@ Description:
 *******************************************************************************/
 template <class T>
 T& Circ_list_circulator<T>::operator*() {
-    return cur_node -> data;
+    return pool -> nodes[cur_node].data;
 }
 
 
@@ -436,6 +460,7 @@ Description:
 *******************************************************************************/
 template <class T>
 Circ_list_circulator<T>& Circ_list_circulator<T>::operator=(const Circ_list_circulator& other) {
+    pool = other.pool;
     cur_node = other.cur_node; 
 	return *this;
 }
@@ -474,7 +499,7 @@ Description:
 *******************************************************************************/
 template <class T>
 Circ_list_const_circulator<T>& Circ_list_const_circulator<T>::operator++() {
-    cur_node = cur_node -> next;
+    cur_node = pool -> nodes[cur_node].next;
     return *this;
 }
 
@@ -486,7 +511,7 @@ Description:
 *******************************************************************************/
 template <class T>
 Circ_list_const_circulator<T>& Circ_list_const_circulator<T>::operator--() {
-    cur_node = cur_node -> prev;
+    cur_node = pool -> nodes[cur_node].prev;
     return *this;
 }
 
@@ -498,7 +523,7 @@ Description:
 *******************************************************************************/
 template <class T>
 const T& Circ_list_const_circulator<T>::operator*() {
-    return cur_node -> data;
+    return pool -> nodes[cur_node].data;
 }
 
 
@@ -509,6 +534,7 @@ Description:
 *******************************************************************************/
 template <class T>
 Circ_list_const_circulator<T>& Circ_list_const_circulator<T>::operator=(const Circ_list_const_circulator<T>& other) {
+    pool = other.pool;
     cur_node = other.cur_node; 
 	return *this;
 }
@@ -0,0 +1,278 @@
+#include "Component_container.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace {
+
+// The container signature
+const char container_magic[4] = {'E', 'B', 'C', 'T'};
+
+// No. of bytes of the container header
+const std::size_t header_size = 16;
+
+// No. of bytes of the directory entries without the weld map fields, which
+// are also accepted
+const std::size_t short_entry_size = 24 + 8 * eb_sections_cnt;
+
+
+/*******************************************************************************
+Function: void put_uint(std::string& buf, std::uint64_t value, int bytes);
+Description:
+    Appends the given No. of low bytes of value in big endian byte order
+*******************************************************************************/
+void put_uint(std::string& buf, std::uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        buf.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+
+/*******************************************************************************
+Function: std::uint64_t get_uint(const char* data, int bytes);
+Description:
+    Reads an unsigned integer with the given No. of bytes in big endian byte
+    order
+*******************************************************************************/
+std::uint64_t get_uint(const char* data, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+}
+
+
+//////////////////////////////////////////////////////////
+// Container functions
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: bool is_component_container(const char* data, std::size_t size);
+Description:
+    Checks the container signature
+*******************************************************************************/
+bool is_component_container(const char* data, std::size_t size) {
+    return size >= sizeof(container_magic) &&
+           std::memcmp(data, container_magic, sizeof(container_magic)) == 0;
+}
+
+
+/*******************************************************************************
+Function: std::size_t component_index_size(std::size_t components_cnt);
+Description:
+    Returns No. of bytes of the container header and directory
+*******************************************************************************/
+std::size_t component_index_size(std::size_t components_cnt) {
+    return header_size + components_cnt * chunk_entry_size;
+}
+
+
+/*******************************************************************************
+Function: bool write_component_container(std::ostream& out,
+                                         const std::vector<Component_entry>& entries,
+                                         const std::vector<std::string>& streams,
+                                         const std::vector<std::vector<Weld_entry>>& welds);
+Description:
+    Writes the container header, the directory, the weld maps and the EB 
+    streams
+*******************************************************************************/
+bool write_component_container(std::ostream& out, const std::vector<Component_entry>& entries,
+                               const std::vector<std::string>& streams,
+                               const std::vector<std::vector<Weld_entry>>& welds) {
+    if (entries.size() != streams.size() || entries.size() > UINT32_MAX ||
+        (!welds.empty() && welds.size() != entries.size())) {
+        return false;
+    }
+
+    // The weld maps follow the directory
+    std::uint64_t weld_offset = component_index_size(entries.size());
+    std::uint64_t offset = weld_offset;
+    for (auto it = welds.begin(); it != welds.end(); ++it) {
+        if (it->size() > UINT32_MAX) {
+            return false;
+        }
+        offset += weld_entry_size * it->size();
+    }
+
+    std::string header(container_magic, sizeof(container_magic));
+    put_uint(header, container_version, 4);
+    put_uint(header, entries.size(), 4);
+    put_uint(header, chunk_entry_size, 4);
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        std::size_t welds_cnt = welds.empty() ? 0 : welds[i].size();
+        put_uint(header, offset, 8);
+        put_uint(header, streams[i].size(), 8);
+        put_uint(header, entries[i].vertices_cnt, 4);
+        put_uint(header, entries[i].faces_cnt, 4);
+        for (int s = 0; s < eb_sections_cnt; ++s) {
+            put_uint(header, entries[i].section_offset[s], 8);
+        }
+        put_uint(header, weld_offset, 8);
+        put_uint(header, welds_cnt, 4);
+        put_uint(header, 0, 4);
+        offset += streams[i].size();
+        weld_offset += weld_entry_size * welds_cnt;
+    }
+
+    for (auto it = welds.begin(); it != welds.end(); ++it) {
+        for (auto weld = it->begin(); weld != it->end(); ++weld) {
+            put_uint(header, weld->position, 4);
+            put_uint(header, weld->seam_vertex, 4);
+        }
+    }
+
+    out.write(header.data(), header.size());
+    for (auto it = streams.begin(); it != streams.end(); ++it) {
+        out.write(it->data(), it->size());
+    }
+
+    return static_cast<bool>(out.flush());
+}
+
+
+/*******************************************************************************
+Function: bool read_component_container(const char* data, std::size_t size,
+                                        std::vector<Component_entry>& entries);
+Description:
+    Reads the directory. Directory entries longer than the current entry size
+    are accepted, the extra bytes are skipped. Directory entries without the
+    weld map fields are accepted too, the chunks have no seam vertices.
+*******************************************************************************/
+bool read_component_container(const char* data, std::size_t size,
+                              std::vector<Component_entry>& entries) {
+    entries.clear();
+    if (!is_component_container(data, size) || size < header_size) {
+        return false;
+    }
+
+    std::uint64_t version = get_uint(data + 4, 4);
+    std::uint64_t chunks_cnt = get_uint(data + 8, 4);
+    std::uint64_t entry_size = get_uint(data + 12, 4);
+    if (version != container_version || entry_size < short_entry_size || chunks_cnt == 0 ||
+        chunks_cnt > (size - header_size) / entry_size) {
+        return false;
+    }
+
+    std::uint64_t index_size = header_size + chunks_cnt * entry_size;
+    entries.resize(chunks_cnt);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const char* entry = data + header_size + i * entry_size;
+        Component_entry& chunk = entries[i];
+        chunk.offset = get_uint(entry, 8);
+        chunk.size = get_uint(entry + 8, 8);
+        chunk.vertices_cnt = get_uint(entry + 16, 4);
+        chunk.faces_cnt = get_uint(entry + 20, 4);
+
+        bool valid = chunk.offset >= index_size && chunk.offset <= size &&
+                     chunk.size <= size - chunk.offset;
+        for (int s = 0; s < eb_sections_cnt; ++s) {
+            chunk.section_offset[s] = get_uint(entry + 24 + 8 * s, 8);
+            std::uint64_t begin = (s == 0) ? 0 : chunk.section_offset[s - 1];
+            valid = valid && chunk.section_offset[s] >= begin &&
+                    chunk.section_offset[s] <= chunk.size;
+        }
+
+        chunk.weld_offset = 0;
+        chunk.welds_cnt = 0;
+        if (entry_size >= chunk_entry_size) {
+            chunk.weld_offset = get_uint(entry + short_entry_size, 8);
+            chunk.welds_cnt = get_uint(entry + short_entry_size + 8, 4);
+            valid = valid && chunk.weld_offset >= index_size && chunk.weld_offset <= size &&
+                    chunk.welds_cnt <= (size - chunk.weld_offset) / weld_entry_size;
+        }
+
+        if (!valid) {
+            entries.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+Function: void read_weld_map(const char* data, const Component_entry& entry,
+                             std::vector<Weld_entry>& welds);
+Description:
+    Reads the weld map of a chunk, its position has been checked by 
+    read_component_container()
+*******************************************************************************/
+void read_weld_map(const char* data, const Component_entry& entry,
+                   std::vector<Weld_entry>& welds) {
+    welds.resize(entry.welds_cnt);
+    const char* weld = data + entry.weld_offset;
+    for (auto it = welds.begin(); it != welds.end(); ++it, weld += weld_entry_size) {
+        it->position = get_uint(weld, 4);
+        it->seam_vertex = get_uint(weld + 4, 4);
+    }
+}
+
+
+//////////////////////////////////////////////////////////
+// Public functions from Eb_input class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Eb_input();
+Description:
+    Eb_input class constructors
+*******************************************************************************/
+Eb_input::Eb_input()
+  : data_(nullptr), size_(0), mapped(nullptr) {
+}
+
+
+/*******************************************************************************
+Function: ~Eb_input();
+Description:
+    Eb_input class deconstructors
+*******************************************************************************/
+Eb_input::~Eb_input() {
+    if (mapped != nullptr) {
+        munmap(mapped, size_);
+    }
+}
+
+
+/*******************************************************************************
+Function: bool open(int fd);
+Description:
+    Maps a regular file, or reads any other file into memory
+*******************************************************************************/
+bool Eb_input::open(int fd) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            mapped = addr;
+            data_ = static_cast<const char*>(addr);
+            size_ = info.st_size;
+            return true;
+        }
+    }
+
+    char block[1 << 16];
+    ssize_t cnt;
+    while ((cnt = read(fd, block, sizeof(block))) != 0) {
+        if (cnt < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        buffer.append(block, cnt);
+    }
+
+    data_ = buffer.data();
+    size_ = buffer.size();
+    return true;
+}
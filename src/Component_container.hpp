@@ -0,0 +1,256 @@
+// Component_container.hpp
+// Description:
+//     Functions and classes which read and write the EB v2 container. The
+//     container stores a triangle mesh as one or more chunks, each chunk is a
+//     connected component compressed into its own EB (version 1) stream. A
+//     chunk directory at a fixed location gives the position of every chunk
+//     and of the sections inside it, so a reader can decode one chunk without
+//     reading the others. When a mesh is cut into patches, the vertices on the
+//     cuts are coded by every patch that contains them, and the weld map of
+//     each chunk tells which of its vertices are the same seam vertex.
+//
+//     Layout of the container (all values in big endian byte order, like the
+//     EB file header):
+//         Offset 0: The signature 'E', 'B', 'C', 'T'
+//         Offset 4: The container version (uint32), currently 2
+//         Offset 8: No. of chunks (uint32)
+//         Offset 12: No. of bytes of each directory entry (uint32)
+//         Offset 16: The chunk directory, chunks_cnt entries of
+//                    chunk_entry_size bytes, see Component_entry
+//         Offset 16 + chunks_cnt * chunk_entry_size: The weld maps of the
+//                    chunks, one after another, see Weld_entry
+//         Then: The EB streams of the chunks, one after another
+//     An EB version 1 file starts with the signature 696610198 instead, it is
+//     the same as the EB stream of a single chunk.
+
+#ifndef component_container_hpp
+#define component_container_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+
+/*******************************************************************************
+Enum: Eb_section
+Description:
+    The byte aligned sections of an EB stream, in the order they are stored.
+*******************************************************************************/
+enum Eb_section {
+    eb_header = 0,
+    eb_history = 1,
+    eb_m_table = 2,
+    eb_h_table = 3,
+    eb_offset_table = 4,
+    eb_geometry = 5,
+    eb_sections_cnt = 6
+};
+
+
+/*******************************************************************************
+Structure: Weld_entry
+Description:
+    A vertex of a chunk which lies on a cut between patches. It is stored as
+    two uint32 values.
+*******************************************************************************/
+struct Weld_entry {
+    // The position of the vertex in the order the chunk's vertex coordinates
+    // are coded (see Encoder::get_coding_order())
+    std::uint32_t position;
+
+    // The seam vertex, every chunk vertex with the same seam vertex is welded
+    // into a single vertex
+    std::uint32_t seam_vertex;
+};
+
+
+/*******************************************************************************
+Structure: Component_entry
+Description:
+    The directory entry of a chunk in the container. Each entry is stored as
+    the chunk offset and size (uint64), No. of vertices and faces (uint32),
+    the offset of each section (uint64), then the offset of the weld map
+    (uint64) and No. of weld entries (uint32, followed by 4 zero bytes).
+*******************************************************************************/
+struct Component_entry {
+    // The position of the EB stream from the beginning of the container
+    std::uint64_t offset;
+
+    // No. of bytes of the EB stream
+    std::uint64_t size;
+
+    // No. of vertices and faces in the component
+    std::uint32_t vertices_cnt;
+    std::uint32_t faces_cnt;
+
+    // The position of each section from the beginning of the EB stream, a
+    // section ends where the next one begins
+    std::uint64_t section_offset[eb_sections_cnt];
+
+    // The position of the weld map from the beginning of the container
+    std::uint64_t weld_offset;
+
+    // No. of weld entries of the chunk, 0 if the chunk has no seam vertex
+    std::uint32_t welds_cnt;
+};
+
+// The current container version, No. of bytes of each directory entry and 
+// of each weld entry
+const std::uint32_t container_version = 2;
+const std::uint32_t chunk_entry_size = 40 + 8 * eb_sections_cnt;
+const std::uint32_t weld_entry_size = 8;
+
+
+/*******************************************************************************
+Function: is_component_container()
+Description:
+    The function checks whether the given data starts with the signature of
+    the EB v2 container.
+
+Parameters:
+    data: The beginning of the compressed data
+    size: No. of bytes of data
+
+Return:
+    True if the data is an EB v2 container; otherwise, false is returned
+*******************************************************************************/
+bool is_component_container(const char* data, std::size_t size);
+
+
+/*******************************************************************************
+Function: component_index_size()
+Description:
+    The function returns No. of bytes of the container header and directory.
+
+Parameters:
+    components_cnt: No. of chunks
+
+Return:
+    No. of bytes before the first EB stream
+*******************************************************************************/
+std::size_t component_index_size(std::size_t components_cnt);
+
+
+/*******************************************************************************
+Function: write_component_container()
+Description:
+    The function writes the header, the directory, the weld maps and the EB
+    streams of the chunks to the output stream.
+
+Parameters:
+    out: The output stream
+    entries: The directory entries, the positions and sizes are taken from
+             streams and welds
+    streams: The EB stream of each chunk
+    welds: The weld map of each chunk, or empty if no chunk has seam vertices
+
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool write_component_container(std::ostream& out, const std::vector<Component_entry>& entries,
+                               const std::vector<std::string>& streams,
+                               const std::vector<std::vector<Weld_entry>>& welds =
+                                   std::vector<std::vector<Weld_entry>>());
+
+
+/*******************************************************************************
+Function: read_component_container()
+Description:
+    The function reads the directory of the container, and checks that every
+    chunk and section is inside the container. Only the header and the
+    directory are read.
+
+Parameters:
+    data: The whole container
+    size: No. of bytes of data
+    entries: The directory entry of each chunk (output)
+
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool read_component_container(const char* data, std::size_t size,
+                              std::vector<Component_entry>& entries);
+
+
+/*******************************************************************************
+Function: read_weld_map()
+Description:
+    The function reads the weld map of a chunk.
+
+Parameters:
+    data: The whole container
+    entry: The directory entry of the chunk, see read_component_container()
+    welds: The weld map of the chunk (output)
+*******************************************************************************/
+void read_weld_map(const char* data, const Component_entry& entry,
+                   std::vector<Weld_entry>& welds);
+
+
+/*******************************************************************************
+Class: Eb_input
+Description:
+    The compressed data read by the decoder. A regular file is memory mapped,
+    so only the pages of the data which is used are read from the file. Any
+    other file (e.g. a pipe) is read into memory.
+*******************************************************************************/
+class Eb_input {
+public:
+    // Constructor, creates an empty input
+    Eb_input();
+
+    // Destructor, unmaps the file
+    ~Eb_input();
+
+    Eb_input(const Eb_input&) = delete;
+    Eb_input& operator=(const Eb_input&) = delete;
+
+    // Opens the compressed data
+    // Parameters:
+    //      fd: The input file descriptor, it can be closed after the call
+    // Returns:
+    //      Upon success, true is returned; otherwise, false is returned
+    bool open(int fd);
+
+    // Returns the compressed data
+    const char* data() const { return data_; }
+
+    // Returns No. of bytes of the compressed data
+    std::size_t size() const { return size_; }
+
+private:
+    // The compressed data
+    const char* data_;
+    std::size_t size_;
+
+    // The mapped file, null if the data is read into buffer
+    void* mapped;
+
+    // The data read from a file which cannot be mapped
+    std::string buffer;
+};
+
+
+/*******************************************************************************
+Class: Chunk_buffer
+Description:
+    A read only stream buffer over a chunk of memory, which is used to decode
+    an EB stream without copying it.
+*******************************************************************************/
+class Chunk_buffer : public std::streambuf {
+public:
+    // A constructor create a Chunk_buffer object with given parameters
+    // Parameters:
+    //      data: The beginning of the chunk
+    //      size: No. of bytes of the chunk
+    Chunk_buffer(const char* data, std::size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+};
+
+
+// #include "Component_container.cpp"
+#endif
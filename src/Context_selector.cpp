@@ -1,51 +1,58 @@
 #include "Context_selector.hpp"
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 
 
 /*******************************************************************************
-Function: Context_selector(int no_of_bits, int full_trees);
+Function: Context_selector();
 Description:
-    Context_selector class constructor
+    Context_selector class constructor, creates an empty selector
 *******************************************************************************/
-Context_selector::Context_selector(int no_of_bits, int full_trees_level) 
-: n_bits(no_of_bits), f_levels(full_trees_level), delta(0), context_id(0), encode_bits(0) {
+Context_selector::Context_selector()
+: n_bits(0), f_levels(0), context_base(0), root_state(0), nodes(1, Context_node{-1, {0, 0}}) {
+}
+
+
+/*******************************************************************************
+Function: Context_selector(int no_of_bits, int full_trees_level, int first_context);
+Description:
+    Context_selector class constructor. The binarization tree is walked from
+    its root, and the transitions of every node are stored in the table.
+*******************************************************************************/
+Context_selector::Context_selector(int no_of_bits, int full_trees_level, int first_context)
+: n_bits(no_of_bits), f_levels(full_trees_level), context_base(first_context), root_state(0) {
     // make sure 1 <= f_levels <= n_bits
     assert(f_levels >= 1 && f_levels <= n_bits);
-    
+
+    int delta = 0;
+
     // UI function is n levels full tree
     if (n_bits == f_levels) {
-        context_id = (1 << (n_bits - 1));
-        delta = context_id / 2;
+        root_state = (1 << (n_bits - 1));
+        delta = root_state / 2;
     }
-    
+
     // UI function has (n - f) levels linear tree and f levels full tree
     else {
-        context_id = (1 << f_levels) + n_bits - f_levels - 1;
-        
+        root_state = (1 << f_levels) + n_bits - f_levels - 1;
+
         if (n_bits - f_levels == 1) {
             // Current UI function only has one level linear tree
-            delta = context_id / 2;
+            delta = root_state / 2;
         }
         else {
             delta = 1;
         }
     }
-    
-    // Update encode bit 
-    ++encode_bits;
-}
 
+    // State 0 is the bypass mode, it stays in bypass mode for the later bits
+    nodes.assign(std::max(root_state, total_contexts(n_bits, f_levels)) + 1,
+                 Context_node{-1, {0, 0}});
 
-/*******************************************************************************
-Function: ~Context_selector();
-Description:
-    Context_selector class deconstructor
-*******************************************************************************/
-Context_selector::~Context_selector() {
-    --delta;
-    --context_id;
-    --encode_bits;
+    if (n_bits > 0) {
+        build(root_state, delta, 1);
+    }
 }
 
 
@@ -60,63 +67,57 @@ int Context_selector::total_contexts(int no_of_bits, int full_trees_level) {
 
 
 /*******************************************************************************
-Function: int get_context() const;
+Function: void build(int state, int delta, int encode_bits);
 Description:
-    Gets Context_selector id for the current input bit
+    Adds the transitions of the given state, then the states of its children.
+    The next state of each bit is the context id + 1 of the child node, it is
+    0 if the bit enters bypass mode. The states of the last bit go to state 0,
+    since they are never used.
 *******************************************************************************/
-int Context_selector::get_context() const {
-    return (context_id - 1);
-}
-
-
-/*******************************************************************************
-Function: bool encode_bit(int input_bit);
-Description:
-    Reads the bit that needs to encode, updates the context id for the next bit
-*******************************************************************************/
-bool Context_selector::encode_bit(int input_bit) {
-    // Make sure input bit is binary
-    if (input_bit != 0 && input_bit != 1) {
-        return false;
+void Context_selector::build(int state, int delta, int encode_bits) {
+    if (state >= static_cast<int>(nodes.size())) {
+        nodes.resize(state + 1, Context_node{-1, {0, 0}});
     }
-    
-    // Bypass mode
-    if (context_id == 0) {
-        return true;
-    }
-    
-    // Regular mode
-    if (input_bit == 0) {
-        // Context go to left child
-        context_id -= delta;
+    nodes[state].context_id = context_base + state - 1;
+
+    if (encode_bits == n_bits) {
+        return;
     }
-    else if (input_bit == 1) {
-        // Context go to right child
-        context_id += delta;
-        
-        if (n_bits - f_levels >= encode_bits) {
-            // Enter bypass mode
-            context_id = 0;
+
+    for (int bit = 0; bit < 2; ++bit) {
+        int next_state = state;
+        int next_delta = delta;
+
+        if (bit == 0) {
+            // Context go to left child
+            next_state -= delta;
         }
-    }
-    
-    // Update adjust value for the next input bit
-    if (delta != 1) { delta /= 2; }
-    else {
-        if (context_id  == (1 << f_levels)) {
-            // Current node is L node (node with its left child is full tree) 
-            delta = context_id / 2;
+        else {
+            // Context go to right child
+            next_state += delta;
+
+            if (n_bits - f_levels >= encode_bits) {
+                // Enter bypass mode
+                next_state = 0;
+            }
         }
+
+        // Update adjust value for the next input bit
+        if (next_delta != 1) { next_delta /= 2; }
         else {
-            // Context id still in the range of linear tree or encode the last bit
-            delta = 1;
+            if (next_state == (1 << f_levels)) {
+                // Current node is L node (node with its left child is full tree)
+                next_delta = next_state / 2;
+            }
+            else {
+                // Context id still in the range of linear tree or encode the last bit
+                next_delta = 1;
+            }
+        }
+
+        nodes[state].next[bit] = next_state;
+        if (next_state > 0) {
+            build(next_state, next_delta, encode_bits + 1);
         }
     }
-    
-    // Update encode bit 
-    ++encode_bits;
-    
-    return true;
 }
-    
-    
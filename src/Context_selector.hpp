@@ -1,6 +1,6 @@
 // Context_selector.hpp
 // Description:
-//     This head file includes the implementation of the binarization scheme 
+//     This head file includes the implementation of the binarization scheme
 //     which is used by the arithmetic coding
 
 #ifndef context_hpp
@@ -8,67 +8,101 @@
 
 #include <iostream>
 #include <iterator>
+#include <vector>
 
 
 /*******************************************************************************
 Class: Context_selector
 Description:
-    The implementation of binarization scheme which is used with the arithmetic 
-    encoder and decoder class
+    The implementation of binarization scheme which is used with the arithmetic
+    encoder and decoder class. The binarization tree of a value only depends on
+    the No. of bits and the levels of full trees, which are fixed for each
+    coordinate of a file. So the whole tree is built once as a state transition
+    table, and the same selector is used for every value of the coordinate.
+    Each state is a node of the tree, it knows the context id used to code the
+    bit of the node and the next state for each bit value.
 *******************************************************************************/
 class Context_selector {
 public:
-    
-    // A constructor create a Context_selector object with given parameters, 
-    // and initialize the binarization function
-    // Parameters: 
+
+    // Constructor, creates an empty selector
+    Context_selector();
+
+    // A constructor create a Context_selector object with given parameters,
+    // and builds the state transition table of the binarization function
+    // Parameters:
     //      no_of_bits: No. of bits need to be encode (i.e. n)
     //      full_trees_level: Full tree with given levels (i.e. f)
-    Context_selector(int no_of_bits, int full_trees_level);
-    
-    // Destructor
-    ~Context_selector();
-    
+    //      first_context: The context id of the arithmetic coder used for the
+    //                     first context of this selector
+    Context_selector(int no_of_bits, int full_trees_level, int first_context = 0);
+
     // Returns the total number of contexts used to encode all bits
-    // Parameters: 
+    // Parameters:
     //      no_of_bits: No. of bits need to be encode (i.e. n)
     //      full_trees_level: Full tree with given levels (i.e. f)
-    // Formula: 
+    // Formula:
     //      total_context = 2 ^ f + n - f - 1
     // Returns:
     //      The total number of contexts used to encode all bits
     static int total_contexts(int no_of_bits, int full_trees_level);
-    
-    // Gets context id for the current input bit
+
+    // Returns No. of bits need to be encode (i.e. n)
+    int bits() const { return n_bits; }
+
+    // Returns the state of the first (most significant) bit
+    int root() const { return root_state; }
+
+    // Gets the context id of the arithmetic coder for the bit of the state
+    // Parameters:
+    //      state: The current state
+    // Returns:
+    //      The context id used to encode the bit. If -1 returned, the bit and
+    //      the later bits are encode in bypass mode
+    int get_context(int state) const { return nodes[state].context_id; }
+
+    // Gets the state of the next bit
+    // Parameters:
+    //      state: The current state
+    //      bit: The bit coded in the current state (0 or 1)
     // Returns:
-    //      The context id used to encode the current input bit. The range of 
-    //      context id is: [-1, 2^f + n - f - 2]. If -1 returned, the later 
-    //      input bits are encode in bypass mode
-    int get_context() const;
-    
-    // Reads a bit that needs to encode, updates the context id for the next bit
-    // Parameters: 
-    //      input_bit: Input binary bit
-    bool encode_bit(int input_bit);
-
-	
+    //      The state of the next bit
+    int next(int state, int bit) const { return nodes[state].next[bit]; }
+
+
 private:
+    // A state of the binarization tree
+    struct Context_node {
+        // The context id of the arithmetic coder, -1 for bypass mode
+        int context_id;
+
+        // The next state for bit 0 and bit 1
+        int next[2];
+    };
+
+    // Adds the transitions of the given state and the states below it
+    // Parameters:
+    //      state: The current state (i.e. the context id + 1 of the node)
+    //      delta: The adjust value for the bit of the state
+    //      encode_bits: No. of bits encoded when the bit of the state is coded
+    void build(int state, int delta, int encode_bits);
+
     // No. of bits need to be encode (i.e. n)
     int n_bits;
-    
+
     // Full trees with f levels (i.e. f)
     int f_levels;
-    
-    // The adjust value for the next input bit
-    int delta;
-    
-    // Current context id
-    int context_id;
-    
-    // No. of bits encoded so far
-    int encode_bits;
+
+    // The context id of the arithmetic coder for the first context
+    int context_base;
+
+    // The state of the first bit
+    int root_state;
+
+    // The state transition table, state 0 is the bypass mode
+    std::vector<Context_node> nodes;
 };
 
 
 // #include "Context_selector_impl.hpp"
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,255 @@
+#include "Corner_table.hpp"
+#include <cassert>
+
+
+//////////////////////////////////////////////////////////
+// Functions from Corner_table class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Corner_table();
+Description:
+    Corner_table class constructor
+*******************************************************************************/
+Corner_table::Corner_table() : border_edges(0) {
+}
+
+
+/*******************************************************************************
+Function: bool build(std::vector<Point>&& points,
+                     std::vector<Corner_index>&& vertex_table);
+Description:
+    Builds the corner table from the given vertices and triangles. For each
+    corner c, the edge facing c goes from V[c.n] to V[c.p], its opposite
+    corner is the corner whose edge goes from V[c.p] to V[c.n]. The opposite
+    corners are found with the help of the vertex-corner incidence lists and
+    per vertex lookup arrays, so the whole construction is linear in the size
+    of the mesh (independent of the vertex degrees).
+*******************************************************************************/
+bool Corner_table::build(std::vector<Point>&& points, std::vector<Corner_index>&& vertex_table) {
+    geometry = std::move(points);
+    V = std::move(vertex_table);
+    O.assign(V.size(), null_corner);
+    border_edges = 0;
+
+    if (V.size() % 3 != 0) {
+        std::cerr << "ERROR: Corner table size is not a multiple of 3!\n";
+        return false;
+    }
+
+    // Check the vertex indices of each triangle
+    Corner_index vertices_cnt = geometry.size();
+    for (Corner_index t = 0; t < static_cast<Corner_index>(V.size()); t += 3) {
+        for (int i = 0; i < 3; ++i) {
+            if (V[t + i] < 0 || V[t + i] >= vertices_cnt) {
+                std::cerr << "ERROR: Triangle vertex index out of range!\n";
+                return false;
+            }
+        }
+
+        if (V[t] == V[t + 1] || V[t + 1] == V[t + 2] || V[t + 2] == V[t]) {
+            std::cerr << "ERROR: Mesh contains degenerated triangle!\n";
+            return false;
+        }
+    }
+
+    // Vertex-corner incidence lists
+    std::vector<Corner_index> offsets;
+    std::vector<Corner_index> corners;
+    incident_corners(offsets, corners);
+
+    // For each vertex a, in_corner[b] is the corner whose edge goes from b to
+    // a, and out_corner[b] is the corner whose edge goes from a to b. Both 
+    // arrays are only valid for the entries stamped with the current vertex
+    std::vector<Corner_index> in_corner(geometry.size(), null_corner);
+    std::vector<Corner_index> out_corner(geometry.size(), null_corner);
+    std::vector<Corner_index> stamp(geometry.size(), -1);
+
+    for (Corner_index a = 0; a < vertices_cnt; ++a) {
+        // For a corner k of vertex a, the edge facing prev(k) goes from a to
+        // V[k.n], and the edge facing next(k) goes from V[k.p] to a.
+        for (Corner_index i = offsets[a]; i < offsets[a + 1]; ++i) {
+            Corner_index k = corners[i];
+            Corner_index b_out = V[next(k)];
+            Corner_index b_in = V[prev(k)];
+
+            if (stamp[b_out] != a) {
+                stamp[b_out] = a;
+                in_corner[b_out] = null_corner;
+                out_corner[b_out] = null_corner;
+            }
+            if (stamp[b_in] != a) {
+                stamp[b_in] = a;
+                in_corner[b_in] = null_corner;
+                out_corner[b_in] = null_corner;
+            }
+
+            // Each oriented edge can only appear once
+            if (out_corner[b_out] != null_corner || in_corner[b_in] != null_corner) {
+                std::cerr << "ERROR: Input mesh is not an oriented manifold triangle mesh!\n";
+                return false;
+            }
+            out_corner[b_out] = prev(k);
+            in_corner[b_in] = next(k);
+        }
+
+        // Match the edges a -> b with the edges b -> a
+        int border_out = 0;
+        for (Corner_index i = offsets[a]; i < offsets[a + 1]; ++i) {
+            Corner_index c = prev(corners[i]);
+            Corner_index b = V[prev(c)];
+
+            if (in_corner[b] != null_corner) {
+                O[c] = in_corner[b];
+            }
+            else {
+                // Each vertex can only have one border fan
+                if (++border_out > 1) {
+                    std::cerr << "ERROR: Input mesh contains non-manifold vertex!\n";
+                    return false;
+                }
+                ++border_edges;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+Function: Vertex_index size_of_vertices() const;
+Description:
+    Returns the No. of vertices in the mesh
+*******************************************************************************/
+Vertex_index Corner_table::size_of_vertices() const {
+    return geometry.size();
+}
+
+
+/*******************************************************************************
+Function: Vertex_index size_of_facets() const;
+Description:
+    Returns the No. of triangles in the mesh
+*******************************************************************************/
+Vertex_index Corner_table::size_of_facets() const {
+    return V.size() / 3;
+}
+
+
+/*******************************************************************************
+Function: Vertex_index size_of_corners() const;
+Description:
+    Returns the No. of corners in the mesh
+*******************************************************************************/
+Vertex_index Corner_table::size_of_corners() const {
+    return V.size();
+}
+
+
+/*******************************************************************************
+Function: Vertex_index size_of_halfedges() const;
+Description:
+    Returns the No. of halfedges in the mesh
+*******************************************************************************/
+Vertex_index Corner_table::size_of_halfedges() const {
+    return V.size() + border_edges;
+}
+
+
+/*******************************************************************************
+Function: Vertex_index size_of_border_edges() const;
+Description:
+    Returns the No. of border edges in the mesh
+*******************************************************************************/
+Vertex_index Corner_table::size_of_border_edges() const {
+    return border_edges;
+}
+
+
+/*******************************************************************************
+Function: bool is_closed() const;
+Description:
+    Returns true if the mesh has no border edge
+*******************************************************************************/
+bool Corner_table::is_closed() const {
+    return border_edges == 0;
+}
+
+
+/*******************************************************************************
+Function: const std::vector<Point>& points() const;
+Description:
+    Returns all mesh vertices
+*******************************************************************************/
+const std::vector<Point>& Corner_table::points() const {
+    return geometry;
+}
+
+
+/*******************************************************************************
+Function: Corner_index border_prev(Corner_index c) const;
+Description:
+    Finds the border edge which precedes the given border edge. The edge of
+    corner c goes from a to b, the function swings around vertex a (through
+    the triangles on the left side of each swung edge) until it reaches the
+    border edge that ends at a.
+*******************************************************************************/
+Corner_index Corner_table::border_prev(Corner_index c) const {
+    assert(is_border(c));
+
+    Corner_index k = prev(c);
+    while (O[k] != null_corner) {
+        k = prev(O[k]);
+    }
+
+    return k;
+}
+
+
+/*******************************************************************************
+Function: Corner_index border_next(Corner_index c) const;
+Description:
+    Finds the border edge which follows the given border edge. The edge of
+    corner c goes from a to b, the function swings around vertex b until it
+    reaches the border edge that starts at b.
+*******************************************************************************/
+Corner_index Corner_table::border_next(Corner_index c) const {
+    assert(is_border(c));
+
+    Corner_index k = next(c);
+    while (O[k] != null_corner) {
+        k = next(O[k]);
+    }
+
+    return k;
+}
+
+
+/*******************************************************************************
+Function: void incident_corners(std::vector<Corner_index>& offsets,
+                                std::vector<Corner_index>& corners) const;
+Description:
+    Generates the vertex-corner incidence lists (counting sort on the V table)
+*******************************************************************************/
+void Corner_table::incident_corners(std::vector<Corner_index>& offsets,
+                                    std::vector<Corner_index>& corners) const {
+    offsets.assign(geometry.size() + 1, 0);
+    corners.resize(V.size());
+
+    // Count the corners of each vertex
+    for (auto it = V.begin(); it != V.end(); ++it) {
+        ++offsets[*it + 1];
+    }
+
+    // Prefix sum for the start position of each list
+    for (std::size_t v = 0; v < geometry.size(); ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+
+    // Fill the lists
+    std::vector<Corner_index> fill(offsets.begin(), offsets.end() - 1);
+    for (Corner_index c = 0; c < static_cast<Corner_index>(V.size()); ++c) {
+        corners[fill[V[c]]++] = c;
+    }
+}
@@ -0,0 +1,199 @@
+// Corner_table.hpp
+// Description:
+//     A compact index based triangle mesh representation (corner table) that
+//     is used by the Encoder class. Each triangle t owns the three corners
+//     3t, 3t+1 and 3t+2. The mesh connectivity is stored in two flat integer
+//     arrays: V (corner -> vertex) and O (corner -> opposite corner).
+
+#ifndef corner_table_hpp
+#define corner_table_hpp
+
+#include "Utility.hpp"
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+
+//////////////////////////////////////////////////////////
+// Symbolic type name
+//////////////////////////////////////////////////////////
+typedef std::int32_t Corner_index;
+
+// The corner index used to represent a null corner (e.g. the opposite corner
+// of a border edge, or an empty active gate)
+const Corner_index null_corner = -1;
+
+
+/*******************************************************************************
+Class: Corner_table
+Description:
+    A class stores a manifold oriented triangle mesh in corner table form.
+
+    Corner c is the corner of vertex V[c] in triangle c / 3. The corner c is
+    also used to represent the oriented edge that faces it, which goes from
+    vertex V[next(c)] to vertex V[prev(c)]. This edge plays the same role as
+    the halfedge of a halfedge data structure:
+        halfedge -> next()            <=>  next(c)
+        halfedge -> prev()            <=>  prev(c)
+        halfedge -> opposite()        <=>  opposite(c)
+        halfedge -> vertex()          <=>  vertex(prev(c))
+        halfedge -> next() -> vertex() <=> vertex(c)
+
+    Edges on the mesh border have no opposite corner, opposite(c) returns
+    null_corner for them.
+
+Preconditions:
+    The input mesh must be a consistently oriented manifold triangle mesh
+*******************************************************************************/
+class Corner_table {
+public:
+    // Constructor
+    Corner_table();
+
+    // Destructor
+    ~Corner_table() {}
+
+    // The tables are moved without copying
+    Corner_table(const Corner_table&) = default;
+    Corner_table(Corner_table&&) = default;
+    Corner_table& operator=(const Corner_table&) = default;
+    Corner_table& operator=(Corner_table&&) = default;
+
+    // Builds the corner table from the given vertices and triangles. The
+    // opposite corner table is computed inside the function
+    // Parameters:
+    //      points: The mesh vertices
+    //      vertex_table: Three vertex indices for each triangle (V table)
+    // Returns:
+    //      Upon success, true is returned; otherwise (the input mesh is not a
+    //      consistently oriented manifold triangle mesh), false is returned
+    bool build(std::vector<Point>&& points, std::vector<Corner_index>&& vertex_table);
+
+    // Returns the No. of vertices in the mesh
+    Vertex_index size_of_vertices() const;
+
+    // Returns the No. of triangles in the mesh
+    Vertex_index size_of_facets() const;
+
+    // Returns the No. of corners in the mesh
+    Vertex_index size_of_corners() const;
+
+    // Returns the No. of halfedges in the mesh. The same counting rule as the
+    // CGAL Polyhedron_3 is used, i.e. each border edge counts two halfedges
+    Vertex_index size_of_halfedges() const;
+
+    // Returns the No. of border edges in the mesh
+    Vertex_index size_of_border_edges() const;
+
+    // Returns true if the mesh has no border edge
+    bool is_closed() const;
+
+    // Returns the point of the given vertex
+    // Parameters:
+    //      v: The vertex index
+    const Point& point(Corner_index v) const;
+
+    // Returns a reference to the point of the given vertex
+    // Parameters:
+    //      v: The vertex index
+    Point& point(Corner_index v);
+
+    // Returns all mesh vertices
+    const std::vector<Point>& points() const;
+
+    // Returns the vertex of the given corner (c.v)
+    Corner_index vertex(Corner_index c) const;
+
+    // Returns the opposite corner of the given corner (c.o), null_corner is
+    // returned if the edge facing c is a border edge
+    Corner_index opposite(Corner_index c) const;
+
+    // Returns true if the edge facing corner c is a border edge
+    bool is_border(Corner_index c) const;
+
+    // Returns the next corner in the same triangle (c.n)
+    static Corner_index next(Corner_index c);
+
+    // Returns the previous corner in the same triangle (c.p)
+    static Corner_index prev(Corner_index c);
+
+    // Returns the triangle of the given corner (c.t)
+    static Corner_index triangle(Corner_index c);
+
+    // Returns the border edge which precedes the given border edge on its
+    // border loop (corresponds to the halfedge h -> opposite() -> next() ->
+    // opposite() of a halfedge data structure)
+    // Parameters:
+    //      c: A corner whose edge is a border edge
+    Corner_index border_prev(Corner_index c) const;
+
+    // Returns the border edge which follows the given border edge on its
+    // border loop (corresponds to the halfedge h -> opposite() -> prev() ->
+    // opposite() of a halfedge data structure)
+    // Parameters:
+    //      c: A corner whose edge is a border edge
+    Corner_index border_next(Corner_index c) const;
+
+    // Generates the vertex-corner incidence lists. The corners of vertex v
+    // are stored in corners[offsets[v]] ... corners[offsets[v + 1] - 1]
+    // Parameters:
+    //      offsets: The start position of each vertex's corner list
+    //      corners: The incident corners of all vertices
+    void incident_corners(std::vector<Corner_index>& offsets,
+                          std::vector<Corner_index>& corners) const;
+
+
+private:
+    // The mesh vertices
+    std::vector<Point> geometry;
+
+    // The vertex table (corner -> vertex)
+    std::vector<Corner_index> V;
+
+    // The opposite corner table (corner -> opposite corner)
+    std::vector<Corner_index> O;
+
+    // No. of border edges
+    Vertex_index border_edges;
+};
+
+
+//////////////////////////////////////////////////////////
+// Inline functions from Corner_table class
+//////////////////////////////////////////////////////////
+
+inline const Point& Corner_table::point(Corner_index v) const {
+    return geometry[v];
+}
+
+inline Point& Corner_table::point(Corner_index v) {
+    return geometry[v];
+}
+
+inline Corner_index Corner_table::vertex(Corner_index c) const {
+    return V[c];
+}
+
+inline Corner_index Corner_table::opposite(Corner_index c) const {
+    return O[c];
+}
+
+inline bool Corner_table::is_border(Corner_index c) const {
+    return O[c] == null_corner;
+}
+
+inline Corner_index Corner_table::next(Corner_index c) {
+    return (c % 3 == 2) ? c - 2 : c + 1;
+}
+
+inline Corner_index Corner_table::prev(Corner_index c) {
+    return (c % 3 == 0) ? c + 2 : c - 1;
+}
+
+inline Corner_index Corner_table::triangle(Corner_index c) {
+    return c / 3;
+}
+
+
+// #include "Corner_table.cpp"
+#endif
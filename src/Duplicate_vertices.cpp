@@ -0,0 +1,195 @@
+#include "Duplicate_vertices.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+
+//////////////////////////////////////////////////////////
+// Hashing of the vertex positions
+//////////////////////////////////////////////////////////
+
+namespace {
+
+// Minimum No. of vertices handled by each thread
+const std::size_t min_vertices_per_thread = 1 << 16;
+
+// Returns the bit pattern of a coordinate, -0.0 is mapped to 0.0
+inline std::uint64_t coordinate_bits(double x) {
+    if (x == 0.0) {
+        x = 0.0;
+    }
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+
+/*******************************************************************************
+Function: std::uint64_t position_hash(const Point& p);
+Description:
+    Hash value of the exact position of a vertex
+*******************************************************************************/
+inline std::uint64_t position_hash(const Point& p) {
+    std::uint64_t h = coordinate_bits(p.x()) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 29) ^ coordinate_bits(p.y())) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 32) ^ coordinate_bits(p.z())) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+
+/*******************************************************************************
+Function: std::uint64_t position_hash(const Quant_point& p);
+Description:
+    Hash value of the position of a quantized vertex
+*******************************************************************************/
+inline std::uint64_t position_hash(const Quant_point& p) {
+    std::uint64_t h = static_cast<std::uint32_t>(p.x()) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 29) ^ static_cast<std::uint32_t>(p.y())) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 32) ^ static_cast<std::uint32_t>(p.z())) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+
+// Returns the partition (0 ... partitions_cnt - 1) of a hash value. The high 
+// bits are used, the low bits select the hash table slot
+inline unsigned hash_partition(std::uint64_t h, unsigned partitions_cnt) {
+    return static_cast<unsigned>(((h >> 32) * partitions_cnt) >> 32);
+}
+
+
+/*******************************************************************************
+Function: Vertex_index find_duplicates(const Points& points, 
+                                       std::vector<Corner_index>& remap,
+                                       unsigned threads_cnt);
+Description:
+    The vertices are distributed to one partition per thread by their hash 
+    values (a stable counting sort, so each partition lists its vertices in 
+    increasing order). Each thread then inserts the vertices of its partition 
+    into a linear probing hash table. A vertex which finds an equal position 
+    in the table is a duplicate of the vertex stored there, which is the first 
+    vertex at that position. Points is std::vector<Point> or Quant_point_array.
+*******************************************************************************/
+template <class Points>
+Vertex_index find_duplicates(const Points& points, std::vector<Corner_index>& remap, 
+                             unsigned threads_cnt) {
+    const std::size_t vertices_cnt = points.size();
+    remap.resize(vertices_cnt);
+    
+    // No. of threads, each thread works on one vertex range and one partition
+    if (threads_cnt == 0) {
+        threads_cnt = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::size_t max_threads = std::max<std::size_t>(1, vertices_cnt / min_vertices_per_thread);
+    threads_cnt = static_cast<unsigned>(std::min<std::size_t>(threads_cnt, max_threads));
+    const unsigned partitions_cnt = threads_cnt;
+    
+    // The vertex range of each thread
+    auto range_begin = [&](unsigned t) {
+        return vertices_cnt * t / threads_cnt;
+    };
+    
+    // No. of vertices of each partition in the vertex range of each thread
+    std::vector<std::size_t> counts(threads_cnt * partitions_cnt, 0);
+    run_threads(threads_cnt, [&](unsigned t) {
+        std::size_t* count = &counts[t * partitions_cnt];
+        for (std::size_t v = range_begin(t); v < range_begin(t + 1); ++v) {
+            ++count[hash_partition(position_hash(points[v]), partitions_cnt)];
+        }
+    });
+    
+    // The position of each (partition, thread) block in the sorted order
+    std::vector<std::size_t> offsets(threads_cnt * partitions_cnt + 1);
+    std::vector<std::size_t> partition_begin(partitions_cnt + 1);
+    std::size_t offset = 0;
+    for (unsigned p = 0; p < partitions_cnt; ++p) {
+        partition_begin[p] = offset;
+        for (unsigned t = 0; t < threads_cnt; ++t) {
+            offsets[t * partitions_cnt + p] = offset;
+            offset += counts[t * partitions_cnt + p];
+        }
+    }
+    partition_begin[partitions_cnt] = offset;
+    
+    // Distribute the vertices to the partitions
+    std::vector<Corner_index> order(vertices_cnt);
+    run_threads(threads_cnt, [&](unsigned t) {
+        std::size_t* position = &offsets[t * partitions_cnt];
+        for (std::size_t v = range_begin(t); v < range_begin(t + 1); ++v) {
+            unsigned p = hash_partition(position_hash(points[v]), partitions_cnt);
+            order[position[p]++] = static_cast<Corner_index>(v);
+        }
+    });
+    
+    // Find the duplicates in each partition
+    std::vector<Vertex_index> duplicated_cnt(partitions_cnt, 0);
+    run_threads(threads_cnt, [&](unsigned p) {
+        std::size_t size = partition_begin[p + 1] - partition_begin[p];
+        
+        // The hash table, at most half full
+        std::size_t table_size = 1;
+        while (table_size < 2 * size) {
+            table_size <<= 1;
+        }
+        const std::size_t mask = table_size - 1;
+        std::vector<Corner_index> table(table_size, null_corner);
+        
+        for (std::size_t i = partition_begin[p]; i < partition_begin[p + 1]; ++i) {
+            Corner_index v = order[i];
+            const auto& point = points[v];
+            std::size_t slot = position_hash(point) & mask;
+            
+            remap[v] = v;
+            while (table[slot] != null_corner) {
+                const auto& other = points[table[slot]];
+                if (other.x() == point.x() && other.y() == point.y() && other.z() == point.z()) {
+                    remap[v] = table[slot];
+                    ++duplicated_cnt[p];
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            
+            if (remap[v] == v) {
+                table[slot] = v;
+            }
+        }
+    });
+    
+    Vertex_index total_cnt = 0;
+    for (auto it = duplicated_cnt.begin(); it != duplicated_cnt.end(); ++it) {
+        total_cnt += *it;
+    }
+    
+    return total_cnt;
+}
+
+}
+
+
+/*******************************************************************************
+Function: Vertex_index find_duplicate_vertices(const std::vector<Point>& points,
+                                               std::vector<Corner_index>& remap,
+                                               unsigned threads_cnt);
+Description:
+    Finds the duplicated vertices of the mesh
+*******************************************************************************/
+Vertex_index find_duplicate_vertices(const std::vector<Point>& points, 
+                                     std::vector<Corner_index>& remap, 
+                                     unsigned threads_cnt) {
+    return find_duplicates(points, remap, threads_cnt);
+}
+
+
+/*******************************************************************************
+Function: Vertex_index find_duplicate_vertices(const Quant_point_array& points,
+                                               std::vector<Corner_index>& remap,
+                                               unsigned threads_cnt);
+Description:
+    Finds the duplicated vertices of the quantized mesh
+*******************************************************************************/
+Vertex_index find_duplicate_vertices(const Quant_point_array& points, 
+                                     std::vector<Corner_index>& remap, 
+                                     unsigned threads_cnt) {
+    return find_duplicates(points, remap, threads_cnt);
+}
@@ -0,0 +1,58 @@
+// Duplicate_vertices.hpp
+// Description:
+//     The function finds the vertices of a triangle mesh which have the same 
+//     position as a previous vertex. The vertices are hashed on their exact 
+//     coordinates into open addressing hash tables, which are built in 
+//     parallel for disjoint partitions of the hash values.
+
+#ifndef duplicate_vertices_hpp
+#define duplicate_vertices_hpp
+
+#include "Utility.hpp"
+#include "Corner_table.hpp"
+#include <vector>
+
+
+/*******************************************************************************
+Function: find_duplicate_vertices()
+Description:
+    The function finds the duplicated vertices. Two vertices are duplicated if 
+    their coordinates are equal (0.0 and -0.0 are equal). The first vertex of 
+    each position is kept, all of the following vertices at the same position 
+    are reported as its duplicates through the remap array.
+
+Parameters:
+    points: The vertices of the mesh
+    remap: For each vertex v, remap[v] is the first vertex with the same 
+           position as v. remap[v] == v if v is not a duplicate.
+    threads_cnt: No. of threads used, 0 means the No. of hardware threads
+
+Return:
+    The No. of duplicated vertices (the vertices v with remap[v] != v)
+*******************************************************************************/
+Vertex_index find_duplicate_vertices(const std::vector<Point>& points, 
+                                     std::vector<Corner_index>& remap, 
+                                     unsigned threads_cnt = 0);
+
+
+/*******************************************************************************
+Function: find_duplicate_vertices()
+Description:
+    The same function as above for the vertices in quantization indices. 
+
+Parameters:
+    points: The quantized vertices of the mesh
+    remap: For each vertex v, remap[v] is the first vertex with the same 
+           position as v. remap[v] == v if v is not a duplicate.
+    threads_cnt: No. of threads used, 0 means the No. of hardware threads
+
+Return:
+    The No. of duplicated vertices (the vertices v with remap[v] != v)
+*******************************************************************************/
+Vertex_index find_duplicate_vertices(const Quant_point_array& points, 
+                                     std::vector<Corner_index>& remap, 
+                                     unsigned threads_cnt = 0);
+
+
+// #include "Duplicate_vertices.cpp"
+#endif
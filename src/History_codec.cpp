@@ -0,0 +1,283 @@
+#include "History_codec.hpp"
+#include <cassert>
+#include <cstring>
+
+
+//////////////////////////////////////////////////////////
+// Codeword tables
+//////////////////////////////////////////////////////////
+
+namespace {
+
+// No. of op-codes that have a codeword
+const int opcode_cnt = 5;
+
+// The op-codes in the order used by the codeword tables
+const Triangle_type opcode_list[opcode_cnt] = {C, L, E, R, S};
+
+// No. of bits consumed by each decoding table lookup
+const int lookup_bits = 8;
+
+// A codeword: the code in the lowest len bits. A zero length means the op-code 
+// cannot appear in that position
+struct Codeword {
+    std::uint8_t code;
+    std::uint8_t len;
+};
+
+// The codewords of each code series. The second index is 1 if the previous 
+// op-code is C, otherwise 0. The third index follows opcode_list
+const Codeword codeword_table[3][2][opcode_cnt] = {
+    // Code series 1
+    {
+        // C: 0, L: 110, E: 111, R: 101, S: 100
+        {{0x0, 1}, {0x6, 3}, {0x7, 3}, {0x5, 3}, {0x4, 3}},
+        // C: 0, R: 11, S: 10
+        {{0x0, 1}, {0x0, 0}, {0x0, 0}, {0x3, 2}, {0x2, 2}}
+    },
+    // Code series 2
+    {
+        // C: 00, L: 110, E: 01, R: 10, S: 111
+        {{0x0, 2}, {0x6, 3}, {0x1, 2}, {0x2, 2}, {0x7, 3}},
+        // C: 0, R: 11, S: 10
+        {{0x0, 1}, {0x0, 0}, {0x0, 0}, {0x3, 2}, {0x2, 2}}
+    },
+    // Code series 3
+    {
+        // C: 00, L: 10, E: 11, R: 011, S: 010
+        {{0x0, 2}, {0x2, 2}, {0x3, 2}, {0x3, 3}, {0x2, 3}},
+        // C: 0, R: 11, S: 10
+        {{0x0, 1}, {0x0, 0}, {0x0, 0}, {0x3, 2}, {0x2, 2}}
+    }
+};
+
+
+/*******************************************************************************
+Structure: Lookup_entry
+Description:
+    The result of decoding a lookup_bits wide window of the codewords. Every 
+    codeword is at least one bit long, so a window holds at most lookup_bits 
+    op-codes.
+*******************************************************************************/
+struct Lookup_entry {
+    // The op-codes whose codewords are completely inside the window
+    Triangle_type opcode[lookup_bits];
+    
+    // No. of op-codes
+    std::uint8_t count;
+    
+    // No. of bits used by the op-codes
+    std::uint8_t bits;
+    
+    // 1 if the last op-code is C, otherwise 0
+    std::uint8_t prev_c;
+};
+
+
+/*******************************************************************************
+Class: Lookup_table
+Description:
+    The decoding tables of all the code series. There is one table for each 
+    code series and each state (the previous op-code is C or not), indexed by 
+    the next lookup_bits bits of the codewords.
+*******************************************************************************/
+class Lookup_table {
+public:
+    Lookup_table() {
+        for (int series = 0; series < 3; ++series) {
+            for (int state = 0; state < 2; ++state) {
+                for (int window = 0; window < (1 << lookup_bits); ++window) {
+                    build_entry(series, state, window);
+                }
+            }
+        }
+    }
+    
+    const Lookup_entry& get(int series, int state, unsigned int window) const {
+        return table[series][state][window];
+    }
+    
+private:
+    // Decode the op-codes one by one from the window
+    void build_entry(int series, int state, int window) {
+        Lookup_entry& entry = table[series][state][window];
+        entry.count = 0;
+        entry.bits = 0;
+        
+        bool decoded = true;
+        while (decoded) {
+            decoded = false;
+            for (int op = 0; op < opcode_cnt; ++op) {
+                const Codeword& cw = codeword_table[series][state][op];
+                if (cw.len == 0 || entry.bits + cw.len > lookup_bits) {
+                    continue;
+                }
+                
+                int code = (window >> (lookup_bits - entry.bits - cw.len)) & ((1 << cw.len) - 1);
+                if (code == cw.code) {
+                    entry.opcode[entry.count++] = opcode_list[op];
+                    entry.bits += cw.len;
+                    state = (opcode_list[op] == C);
+                    decoded = true;
+                    break;
+                }
+            }
+        }
+        
+        entry.prev_c = state;
+    }
+    
+    Lookup_entry table[3][2][1 << lookup_bits];
+};
+
+
+// Get the position of the op-code in opcode_list
+inline int opcode_position(Triangle_type opcode) {
+    switch (opcode) {
+        case C: return 0;
+        case L: return 1;
+        case E: return 2;
+        case R: return 3;
+        case S: return 4;
+        default: return -1;
+    }
+}
+
+}
+
+
+//////////////////////////////////////////////////////////
+// Functions from History_bit_writer class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: History_bit_writer();
+Description:
+    History_bit_writer class constructors
+*******************************************************************************/
+History_bit_writer::History_bit_writer() : acc(0), acc_len(0), bit_cnt(0) {
+}
+
+
+/*******************************************************************************
+Function: void finish();
+Description:
+    Write the remaining bits into the buffer
+*******************************************************************************/
+void History_bit_writer::finish() {
+    if (acc_len > 0) {
+        data.push_back(static_cast<std::uint8_t>(acc << (8 - acc_len)));
+        acc_len = 0;
+    }
+}
+
+
+/*******************************************************************************
+Function: const std::vector<std::uint8_t>& bytes() const;
+Description:
+    Get the packed bytes
+*******************************************************************************/
+const std::vector<std::uint8_t>& History_bit_writer::bytes() const {
+    return data;
+}
+
+
+/*******************************************************************************
+Function: std::size_t size() const;
+Description:
+    Get the No. of bits written
+*******************************************************************************/
+std::size_t History_bit_writer::size() const {
+    return bit_cnt;
+}
+
+
+//////////////////////////////////////////////////////////
+// History coding functions
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: void encode_history(const std::vector<Triangle_type>& hist_vec, 
+                              int code_series, History_bit_writer& writer);
+Description:
+    Writes the codewords of the op-code sequence
+*******************************************************************************/
+void encode_history(const std::vector<Triangle_type>& hist_vec, int code_series, 
+                    History_bit_writer& writer) {
+    assert(code_series >= 1 && code_series <= 3);
+    const Codeword (*table)[opcode_cnt] = codeword_table[code_series - 1];
+    
+    int state = 0;
+    for (auto it = hist_vec.begin(); it != hist_vec.end(); ++it) {
+        int op = opcode_position(*it);
+        assert(op >= 0 && table[state][op].len != 0);
+        
+        const Codeword& cw = table[state][op];
+        writer.put_bits(cw.code, cw.len);
+        state = (*it == C);
+    }
+}
+
+
+/*******************************************************************************
+Function: bool decode_history(const std::uint8_t* data, std::size_t bit_cnt, 
+                              int code_series, 
+                              std::vector<Triangle_type>& hist_vec);
+Description:
+    Decodes the op-code sequence from the packed codewords
+*******************************************************************************/
+bool decode_history(const std::uint8_t* data, std::size_t bit_cnt, int code_series, 
+                    std::vector<Triangle_type>& hist_vec) {
+    assert(code_series >= 1 && code_series <= 3);
+    static const Lookup_table lookup;
+    const int series = code_series - 1;
+    
+    // Every codeword is at least one bit, so there are at most bit_cnt 
+    // op-codes. The extra space lets every lookup copy a whole entry
+    std::size_t out = hist_vec.size();
+    hist_vec.resize(out + bit_cnt + lookup_bits);
+    
+    std::size_t byte_cnt = (bit_cnt + 7) / 8;
+    std::size_t pos = 0;
+    int state = 0;
+    
+    while (pos < bit_cnt) {
+        // The next lookup_bits bits, padded with zeros after the last byte
+        std::size_t byte = pos >> 3;
+        unsigned int pair = static_cast<unsigned int>(data[byte]) << 8;
+        if (byte + 1 < byte_cnt) {
+            pair |= data[byte + 1];
+        }
+        unsigned int window = (pair >> (8 - (pos & 7))) & ((1 << lookup_bits) - 1);
+        
+        const Lookup_entry& entry = lookup.get(series, state, window);
+        if (pos + entry.bits <= bit_cnt) {
+            std::memcpy(&hist_vec[out], entry.opcode, lookup_bits);
+            out += entry.count;
+            pos += entry.bits;
+            state = entry.prev_c;
+            continue;
+        }
+        
+        // The window crosses the end of the codewords, only keep the op-codes 
+        // before the end
+        for (int i = 0; i < entry.count; ++i) {
+            int len = codeword_table[series][state][opcode_position(entry.opcode[i])].len;
+            if (pos + len > bit_cnt) {
+                break;
+            }
+            
+            hist_vec[out++] = entry.opcode[i];
+            pos += len;
+            state = (entry.opcode[i] == C);
+        }
+        
+        if (pos != bit_cnt) {
+            hist_vec.resize(out);
+            return false;
+        }
+    }
+    
+    hist_vec.resize(out);
+    return true;
+}
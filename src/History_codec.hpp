@@ -0,0 +1,107 @@
+// History_codec.hpp
+// Description:
+//     The op-code history coder. The op-code sequence is written with the 
+//     codewords of the three code series from D. King's 3.67V bit paper into a 
+//     packed bit buffer (most significant bit first), and decoded with lookup 
+//     tables that consume a whole byte of the buffer per lookup.
+
+#ifndef history_codec_hpp
+#define history_codec_hpp
+
+#include "Utility.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/*******************************************************************************
+Class: History_bit_writer
+Description:
+    A class uses for packing variable length codewords into a byte buffer. The 
+    bits are stored from the most significant bit to the least significant bit 
+    of each byte, which is the same order as SPL::OutputBitStream::putBits().
+*******************************************************************************/
+class History_bit_writer {
+public:
+    // A constructor create an empty History_bit_writer object
+    History_bit_writer();
+    
+    // Append a codeword to the buffer
+    // Parameters: 
+    //      code: The codeword, stored in the lowest len bits
+    //      len: No. of bits in the codeword (at most 24)
+    void put_bits(std::uint32_t code, int len) {
+        acc = (acc << len) | code;
+        acc_len += len;
+        bit_cnt += len;
+        while (acc_len >= 8) {
+            acc_len -= 8;
+            data.push_back(static_cast<std::uint8_t>(acc >> acc_len));
+        }
+    }
+    
+    // Write the remaining bits into the buffer. The unused low bits of the 
+    // last byte are zero
+    void finish();
+    
+    // Get the packed bytes
+    // Returns: 
+    //      The bytes of the buffer, (size() + 7) / 8 bytes after finish()
+    const std::vector<std::uint8_t>& bytes() const;
+    
+    // Get the No. of bits written
+    // Returns: 
+    //      The No. of bits in the buffer
+    std::size_t size() const;
+    
+private:
+    // The packed bytes
+    std::vector<std::uint8_t> data;
+    
+    // The bits that do not fill a whole byte yet
+    std::uint32_t acc;
+    int acc_len;
+    
+    // No. of bits written
+    std::size_t bit_cnt;
+};
+
+
+/*******************************************************************************
+Function: encode_history()
+Description:
+    The function writes the codewords of the op-code sequence using the given 
+    code series.
+
+Parameters:
+    hist_vec: The op-code sequence vector (C, L, E, R and S types only)
+    code_series: The code series, 1, 2 or 3
+    writer: The bit buffer to append the codewords to
+*******************************************************************************/
+void encode_history(const std::vector<Triangle_type>& hist_vec, int code_series, 
+                    History_bit_writer& writer);
+
+
+/*******************************************************************************
+Function: decode_history()
+Description:
+    The function decodes the op-code sequence from the packed codewords. Each 
+    table lookup consumes up to 8 bits and outputs every op-code whose 
+    codeword is completely inside those bits.
+
+Parameters:
+    data: The packed codewords, (bit_cnt + 7) / 8 bytes
+    bit_cnt: No. of bits of codewords
+    code_series: The code series, 1, 2 or 3
+    hist_vec: The op-code sequence vector, the decoded op-codes are appended
+
+Return:
+    Upon success, true is returned; otherwise (the last codeword is 
+    incomplete), false is returned
+*******************************************************************************/
+bool decode_history(const std::uint8_t* data, std::size_t bit_cnt, int code_series, 
+                    std::vector<Triangle_type>& hist_vec);
+
+
+// #include "History_codec.cpp"
+#endif
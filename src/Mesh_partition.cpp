@@ -0,0 +1,312 @@
+#include "Mesh_partition.hpp"
+#include "Union_find.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+
+
+/*******************************************************************************
+Function: Corner_index find_components(std::size_t vertices_cnt,
+                                       const std::vector<Corner_index>& vertex_table,
+                                       std::vector<Corner_index>& component);
+Description:
+    Unites the vertices of each triangle, then numbers the components by
+    their roots
+*******************************************************************************/
+Corner_index find_components(std::size_t vertices_cnt, const std::vector<Corner_index>& vertex_table,
+                             std::vector<Corner_index>& component) {
+    Union_find sets(vertices_cnt);
+    for (std::size_t t = 0; t < vertex_table.size(); t += 3) {
+        sets.unite(vertex_table[t], vertex_table[t + 1]);
+        sets.unite(vertex_table[t], vertex_table[t + 2]);
+    }
+
+    // Number the components by their roots
+    std::vector<Corner_index> root_component(vertices_cnt, null_corner);
+    Corner_index components_cnt = 0;
+    component.resize(vertices_cnt);
+    for (std::size_t v = 0; v < vertices_cnt; ++v) {
+        Corner_index root = sets.find(v);
+        if (root_component[root] == null_corner) {
+            root_component[root] = components_cnt++;
+        }
+        component[v] = root_component[root];
+    }
+
+    return components_cnt;
+}
+
+
+/*******************************************************************************
+Function: void split_components(const std::vector<Point>& points,
+                                const std::vector<Corner_index>& vertex_table,
+                                const std::vector<Corner_index>& component,
+                                std::vector<Mesh_component>& components);
+Description:
+    Copies each vertex and triangle into its component
+*******************************************************************************/
+void split_components(const std::vector<Point>& points, const std::vector<Corner_index>& vertex_table,
+                      const std::vector<Corner_index>& component,
+                      std::vector<Mesh_component>& components) {
+    // The index of each vertex in its component
+    std::vector<Corner_index> new_index(points.size());
+    for (std::size_t v = 0; v < points.size(); ++v) {
+        std::vector<Point>& part_points = components[component[v]].points;
+        new_index[v] = part_points.size();
+        part_points.push_back(points[v]);
+    }
+
+    for (std::size_t t = 0; t < vertex_table.size(); t += 3) {
+        std::vector<Corner_index>& part_table = components[component[vertex_table[t]]].vertex_table;
+        part_table.push_back(new_index[vertex_table[t]]);
+        part_table.push_back(new_index[vertex_table[t + 1]]);
+        part_table.push_back(new_index[vertex_table[t + 2]]);
+    }
+}
+
+
+namespace {
+
+/*******************************************************************************
+Function: void cut_slabs(const Corner_table& mesh, std::vector<Corner_index>& triangles,
+                         unsigned slabs_cnt, unsigned first_slab,
+                         std::vector<unsigned>& slab);
+Description:
+    Cuts the given triangles into slabs first_slab ... first_slab +
+    slabs_cnt - 1 across the longest side of their bounding box. The
+    triangles are sorted on the centroid coordinate along that side, and the
+    slabs have the same No. of triangles.
+*******************************************************************************/
+void cut_slabs(const Corner_table& mesh, std::vector<Corner_index>& triangles,
+               unsigned slabs_cnt, unsigned first_slab, std::vector<unsigned>& slab) {
+    if (triangles.empty()) {
+        return;
+    }
+
+    // The longest side of the bounding box
+    const Point& first = mesh.point(mesh.vertex(3 * triangles.front()));
+    double low[3] = {first.x(), first.y(), first.z()};
+    double high[3] = {first.x(), first.y(), first.z()};
+    for (auto t = triangles.begin(); t != triangles.end(); ++t) {
+        for (int k = 0; k < 3; ++k) {
+            const Point& p = mesh.point(mesh.vertex(3 * *t + k));
+            for (int i = 0; i < 3; ++i) {
+                low[i] = std::min(low[i], p[i]);
+                high[i] = std::max(high[i], p[i]);
+            }
+        }
+    }
+    int axis = 0;
+    for (int i = 1; i < 3; ++i) {
+        if (high[i] - low[i] > high[axis] - low[axis]) {
+            axis = i;
+        }
+    }
+
+    // The centroids are compared without the division by 3
+    std::vector<std::pair<double, Corner_index>> centroid(triangles.size());
+    for (std::size_t k = 0; k < triangles.size(); ++k) {
+        Corner_index t = triangles[k];
+        centroid[k].first = mesh.point(mesh.vertex(3 * t))[axis] +
+                            mesh.point(mesh.vertex(3 * t + 1))[axis] +
+                            mesh.point(mesh.vertex(3 * t + 2))[axis];
+        centroid[k].second = t;
+    }
+    std::sort(centroid.begin(), centroid.end());
+
+    for (std::size_t k = 0; k < centroid.size(); ++k) {
+        slab[centroid[k].second] = first_slab +
+            static_cast<unsigned>(static_cast<std::uint64_t>(k) * slabs_cnt / centroid.size());
+    }
+}
+
+}
+
+
+/*******************************************************************************
+Function: bool partition_mesh(const Corner_table& mesh, unsigned slabs_cnt,
+                              std::vector<Mesh_component>& patches,
+                              Corner_index& seams_cnt, Corner_index& cut_edges);
+Description:
+    The triangles are cut into slabs by cut_slabs(). Then the triangles on
+    the two sides of each edge inside a slab are united, and so are the two
+    corners at each end of the edge. The sets of triangles are the patches,
+    and the sets of corners are the vertices of the patches. The slab of a
+    patch with both handles and holes, or with two vertices from the same
+    mesh vertex, is cut in two, and the patches are found again.
+*******************************************************************************/
+bool partition_mesh(const Corner_table& mesh, unsigned slabs_cnt,
+                    std::vector<Mesh_component>& patches, Corner_index& seams_cnt,
+                    Corner_index& cut_edges) {
+    Corner_index facets_cnt = mesh.size_of_facets();
+    Corner_index corners_cnt = mesh.size_of_corners();
+    Corner_index vertices_cnt = mesh.size_of_vertices();
+
+    std::vector<unsigned> slab(facets_cnt);
+    std::vector<Corner_index> triangles(facets_cnt);
+    std::iota(triangles.begin(), triangles.end(), 0);
+    cut_slabs(mesh, triangles, slabs_cnt, 0, slab);
+    unsigned next_slab = slabs_cnt;
+
+    std::vector<Corner_index> patch(facets_cnt);
+    Corner_index patches_cnt = 0;
+    std::vector<Corner_index> root_index(std::max(facets_cnt, corners_cnt), null_corner);
+    Union_find corner_sets(corners_cnt);
+    while (true) {
+        // Unite the triangles and the corners across the edges inside the
+        // slabs. The edge facing c goes from V[c.n] to V[c.p], and the edge
+        // facing its opposite corner o goes from V[o.n] = V[c.p] to
+        // V[o.p] = V[c.n].
+        Union_find triangle_sets(facets_cnt);
+        corner_sets = Union_find(corners_cnt);
+        cut_edges = 0;
+        for (Corner_index c = 0; c < corners_cnt; ++c) {
+            Corner_index o = mesh.opposite(c);
+            if (o == null_corner || o < c) {
+                continue;
+            }
+
+            if (slab[Corner_table::triangle(c)] != slab[Corner_table::triangle(o)]) {
+                ++cut_edges;
+                continue;
+            }
+
+            triangle_sets.unite(Corner_table::triangle(c), Corner_table::triangle(o));
+            corner_sets.unite(Corner_table::next(c), Corner_table::prev(o));
+            corner_sets.unite(Corner_table::prev(c), Corner_table::next(o));
+        }
+
+        // Number the patches in the order of the triangles
+        std::fill(root_index.begin(), root_index.end(), null_corner);
+        patches_cnt = 0;
+        for (Corner_index t = 0; t < facets_cnt; ++t) {
+            Corner_index root = triangle_sets.find(t);
+            if (root_index[root] == null_corner) {
+                root_index[root] = patches_cnt++;
+            }
+            patch[t] = root_index[root];
+        }
+
+        // No. of vertices, triangles, border edges and border loops of each
+        // patch. The border edges of a patch are the border edges of the
+        // mesh and the cut edges, the ends of each border edge are united to
+        // find the loops.
+        std::vector<long long> patch_vertices(patches_cnt, 0), patch_facets(patches_cnt, 0);
+        std::vector<long long> patch_borders(patches_cnt, 0), patch_loops(patches_cnt, 0);
+        Union_find loop_sets(corners_cnt);
+        for (Corner_index c = 0; c < corners_cnt; ++c) {
+            Corner_index p = patch[Corner_table::triangle(c)];
+            if (corner_sets.find(c) == c) {
+                ++patch_vertices[p];
+            }
+
+            Corner_index o = mesh.opposite(c);
+            if (o == null_corner || slab[Corner_table::triangle(c)] != slab[Corner_table::triangle(o)]) {
+                ++patch_borders[p];
+                loop_sets.unite(corner_sets.find(Corner_table::next(c)),
+                                corner_sets.find(Corner_table::prev(c)));
+            }
+        }
+        for (Corner_index t = 0; t < facets_cnt; ++t) {
+            ++patch_facets[patch[t]];
+        }
+
+        std::fill(root_index.begin(), root_index.end(), null_corner);
+        for (Corner_index c = 0; c < corners_cnt; ++c) {
+            Corner_index o = mesh.opposite(c);
+            if (o == null_corner || slab[Corner_table::triangle(c)] != slab[Corner_table::triangle(o)]) {
+                Corner_index root = loop_sets.find(corner_sets.find(Corner_table::next(c)));
+                if (root_index[root] == null_corner) {
+                    root_index[root] = 0;
+                    ++patch_loops[patch[Corner_table::triangle(c)]];
+                }
+            }
+        }
+
+        // The encoder cannot always compress a mesh with both handles and
+        // holes. A patch with holes has handles if its Euler characteristic
+        // V - E + F = 2 - 2 * genus - loops is less than 2 - loops
+        std::vector<char> recut(patches_cnt, 0);
+        for (Corner_index p = 0; p < patches_cnt; ++p) {
+            long long edges = (3 * patch_facets[p] + patch_borders[p]) / 2;
+            long long euler = patch_vertices[p] - edges + patch_facets[p];
+            recut[p] = patch_loops[p] > 0 && euler < 2 - patch_loops[p];
+        }
+
+        // Neither can the encoder compress two vertices at the same position,
+        // which a patch has if two fans of triangles around a vertex belong 
+        // to the patch
+        std::vector<std::pair<Corner_index, Corner_index>> fans;
+        for (Corner_index c = 0; c < corners_cnt; ++c) {
+            if (corner_sets.find(c) == c) {
+                fans.emplace_back(mesh.vertex(c), patch[Corner_table::triangle(c)]);
+            }
+        }
+        std::sort(fans.begin(), fans.end());
+        for (std::size_t k = 1; k < fans.size(); ++k) {
+            if (fans[k] == fans[k - 1]) {
+                recut[fans[k].second] = 1;
+            }
+        }
+        if (std::find(recut.begin(), recut.end(), 1) == recut.end()) {
+            break;
+        }
+
+        std::vector<std::vector<Corner_index>> split(patches_cnt);
+        for (Corner_index t = 0; t < facets_cnt; ++t) {
+            if (recut[patch[t]]) {
+                split[patch[t]].push_back(t);
+            }
+        }
+        for (auto it = split.begin(); it != split.end(); ++it) {
+            if (!it->empty()) {
+                cut_slabs(mesh, *it, 2, next_slab, slab);
+                next_slab += 2;
+            }
+        }
+    }
+
+    // Number the vertices of the patches in the order of the triangles, the
+    // seam of each patch vertex is its mesh vertex for now
+    std::vector<Corner_index> copies(vertices_cnt, 0);
+    patches.assign(patches_cnt, Mesh_component());
+    std::fill(root_index.begin(), root_index.end(), null_corner);
+    for (Corner_index c = 0; c < corners_cnt; ++c) {
+        Mesh_component& part = patches[patch[Corner_table::triangle(c)]];
+        Corner_index root = corner_sets.find(c);
+        if (root_index[root] == null_corner) {
+            Corner_index v = mesh.vertex(c);
+            root_index[root] = part.points.size();
+            part.points.push_back(mesh.point(v));
+            part.seam.push_back(v);
+            ++copies[v];
+        }
+        part.vertex_table.push_back(root_index[root]);
+    }
+
+    // Number the seam vertices
+    std::vector<Corner_index> seam_index(vertices_cnt, null_corner);
+    seams_cnt = 0;
+    for (Corner_index v = 0; v < vertices_cnt; ++v) {
+        if (copies[v] == 0) {
+            return false;
+        }
+        if (copies[v] > 1) {
+            seam_index[v] = seams_cnt++;
+        }
+    }
+
+    for (auto it = patches.begin(); it != patches.end(); ++it) {
+        bool has_seam = false;
+        for (auto v = it->seam.begin(); v != it->seam.end(); ++v) {
+            *v = seam_index[*v];
+            has_seam = has_seam || *v != null_corner;
+        }
+        if (!has_seam) {
+            it->seam.clear();
+        }
+    }
+
+    return true;
+}
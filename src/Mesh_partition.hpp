@@ -0,0 +1,105 @@
+// Mesh_partition.hpp
+// Description:
+//     Functions which split a triangle mesh into parts that are compressed on
+//     their own: the connected components of the mesh, or spatial patches of
+//     it. The vertices on the cuts between the patches are duplicated into
+//     every patch that contains them, and numbered as seam vertices so that
+//     the patches can be welded together again.
+
+#ifndef mesh_partition_hpp
+#define mesh_partition_hpp
+
+#include "Corner_table.hpp"
+#include <vector>
+
+
+/*******************************************************************************
+Structure: Mesh_component
+Description:
+    A part of the input triangle mesh, with its own vertex indices
+*******************************************************************************/
+struct Mesh_component {
+    // The vertices of the part
+    std::vector<Point> points;
+
+    // Three vertex indices for each triangle of the part
+    std::vector<Corner_index> vertex_table;
+
+    // The seam vertex of each vertex, null_corner if the vertex only belongs
+    // to this part. Empty if the part has no seam vertex.
+    std::vector<Corner_index> seam;
+};
+
+
+/*******************************************************************************
+Function: find_components()
+Description:
+    The function finds the connected components of the input triangle mesh.
+    The components are numbered in the order of their smallest vertex index.
+    A vertex without any triangle is a component by itself.
+
+Parameters:
+    vertices_cnt: No. of vertices of the input triangle mesh
+    vertex_table: Three vertex indices for each triangle
+    component: The component of each vertex (output)
+
+Return:
+    No. of connected components
+*******************************************************************************/
+Corner_index find_components(std::size_t vertices_cnt, const std::vector<Corner_index>& vertex_table,
+                             std::vector<Corner_index>& component);
+
+
+/*******************************************************************************
+Function: split_components()
+Description:
+    The function splits the input triangle mesh into its connected components.
+    The vertices and triangles of each component keep their order.
+
+Parameters:
+    points: The vertices of the input triangle mesh
+    vertex_table: Three vertex indices for each triangle
+    component: The component of each vertex, see find_components()
+    components: The connected components (output), the size of the vector
+                must be No. of components
+*******************************************************************************/
+void split_components(const std::vector<Point>& points, const std::vector<Corner_index>& vertex_table,
+                      const std::vector<Corner_index>& component,
+                      std::vector<Mesh_component>& components);
+
+
+/*******************************************************************************
+Function: partition_mesh()
+Description:
+    The function cuts the triangle mesh into patches along a grid of equal
+    slabs across the longest side of its bounding box. Each triangle goes to
+    the slab of its centroid, and the slabs have the same No. of triangles.
+    The triangles of a slab which are connected through its edges form a
+    patch, so a slab gives more than one patch if it cuts through the mesh
+    more than once. A vertex is copied into each patch that uses it; a
+    vertex with more than one copy is a seam vertex. The encoder cannot
+    always compress a mesh with both handles and holes, nor two vertices at
+    the same position, so the slab of a patch with both handles and holes,
+    or with two fans of triangles around a vertex, is cut in two again until
+    no patch has either. The seam vertices are numbered in the order of
+    their vertex index. The vertices and triangles of each patch keep their
+    order.
+
+Parameters:
+    mesh: The input triangle mesh
+    slabs_cnt: No. of slabs
+    patches: The patches (output)
+    seams_cnt: No. of seam vertices (output)
+    cut_edges: No. of edges between the triangles of two slabs (output)
+
+Return:
+    If a vertex does not belong to any triangle, false is returned;
+    otherwise, true is returned
+*******************************************************************************/
+bool partition_mesh(const Corner_table& mesh, unsigned slabs_cnt,
+                    std::vector<Mesh_component>& patches, Corner_index& seams_cnt,
+                    Corner_index& cut_edges);
+
+
+// #include "Mesh_partition.cpp"
+#endif
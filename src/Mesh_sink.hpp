@@ -0,0 +1,102 @@
+// Mesh_sink.hpp
+// Description:
+//     The Mesh_sink class receives the decompressed triangle mesh from the
+//     decoder while it is decoded, so a program can upload the mesh to a
+//     renderer or write it out without waiting for the whole mesh.
+
+#ifndef mesh_sink_hpp
+#define mesh_sink_hpp
+
+#include "Utility.hpp"
+#include <cstddef>
+#include <vector>
+
+
+/*******************************************************************************
+Class: Mesh_sink
+Description:
+    The interface of the receiver of a decompressed triangle mesh. The No. of
+    vertices and triangles is given first, so the receiver can allocate its
+    buffers. Then each vertex is given as soon as its coordinates are final,
+    in the order the vertices are coded, and each triangle is given after its
+    three vertices. All of the functions are called by the same thread.
+*******************************************************************************/
+class Mesh_sink {
+public:
+    // Destructor
+    virtual ~Mesh_sink() {}
+
+    // Starts the mesh, called before any vertex or triangle
+    // Parameters:
+    //      vertices_cnt: No. of vertices in the mesh
+    //      triangles_cnt: No. of triangles in the mesh
+    // Returns:
+    //      False to stop the decompression; otherwise, true is returned
+    virtual bool begin(std::size_t vertices_cnt, std::size_t triangles_cnt) = 0;
+
+    // Receives a vertex
+    // Parameters:
+    //      index: The vertex index, less than vertices_cnt
+    //      p: The vertex coordinates
+    // Returns:
+    //      False to stop the decompression; otherwise, true is returned
+    virtual bool add_vertex(Vertex_index index, const Point& p) = 0;
+
+    // Receives a triangle
+    // Parameters:
+    //      tri_label: The triangle's three vertices index
+    // Returns:
+    //      False to stop the decompression; otherwise, true is returned
+    virtual bool add_triangle(const Triangle_facet& tri_label) = 0;
+
+    // Finishes the mesh, called after all of the vertices and triangles
+    // Returns:
+    //      Upon success, true is returned; otherwise, false is returned
+    virtual bool end() = 0;
+};
+
+
+/*******************************************************************************
+Class: Mesh_collector
+Description:
+    A Mesh_sink which keeps the whole mesh in a vertex vector and a triangle
+    vector, the vertices are stored in the order of their indices.
+*******************************************************************************/
+class Mesh_collector : public Mesh_sink {
+public:
+    // A constructor create a Mesh_collector object with given parameters
+    // Parameters:
+    //      vertices: The vector to store the vertices
+    //      triangles: The vector to store the triangles
+    Mesh_collector(std::vector<Point>& vertices, std::vector<Triangle_facet>& triangles)
+      : vertices(vertices), triangles(triangles) {}
+
+    bool begin(std::size_t vertices_cnt, std::size_t triangles_cnt) override {
+        vertices.resize(vertices_cnt);
+        triangles.clear();
+        triangles.reserve(triangles_cnt);
+        return true;
+    }
+
+    bool add_vertex(Vertex_index index, const Point& p) override {
+        vertices[index] = p;
+        return true;
+    }
+
+    bool add_triangle(const Triangle_facet& tri_label) override {
+        triangles.push_back(tri_label);
+        return true;
+    }
+
+    bool end() override {
+        return true;
+    }
+
+private:
+    // The vertices and the triangles of the mesh
+    std::vector<Point>& vertices;
+    std::vector<Triangle_facet>& triangles;
+};
+
+
+#endif
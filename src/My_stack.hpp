@@ -1,10 +1,11 @@
 // My_stack.hpp
 // Description:
 //      User defined stack data structures. My_stack is used in decompression 
-//      program, it can deletes an arbitrary element from the stack. 
+//      program, it can access and deletes an arbitrary element of the stack 
+//      by its position. 
 //      My_findable_stack is used in the compression program, it can finds the 
 //      internal element's position and deletes an arbitrary element from the 
-//      stack.
+//      stack in logarithmic time.
 
 #ifndef mystack_hpp
 #define mystack_hpp
@@ -12,28 +13,66 @@
 #include <iostream>
 #include <iterator>
 #include <cstdlib>
-#include <list>
-#include <map>
 #include <algorithm>
+#include <vector>
+
+
+/*******************************************************************************
+Class: Stack_rank_tree
+Description:
+    A Fenwick tree of the live element counts of the slots of a stack, which 
+    keeps tombstones of its erased elements. A slot can be appended and 
+    removed at the top, and killed anywhere. The No. of live elements below a 
+    slot and the slot of the k-th live element are found in O(log n) time.
+*******************************************************************************/
+class Stack_rank_tree {
+public:
+    // Constructor 
+    Stack_rank_tree() : tree(1, 0) {}
+    
+    // Removes all slots
+    void clear();
+    
+    // Appends a live slot at the top
+    void push_back();
+    
+    // Removes the top slot
+    void pop_back();
+    
+    // Marks the given slot as a tombstone
+    // Parameters: 
+    //      slot: The slot index (0 based)
+    void kill(std::size_t slot);
+    
+    // Returns No. of live elements in the slots [0, slot)
+    int prefix(std::size_t slot) const;
+    
+    // Returns the slot of the k-th live element (0 based, bottom first), 
+    // k must be less than the No. of live elements
+    std::size_t find_kth(int k) const;
+    
+private:
+    // The tree nodes (1 based), node i covers the slots (i - lowbit(i), i]
+    std::vector<int> tree;
+};
 
 
 /*******************************************************************************
 Class: My_stack
 Description:
-    User defined stack data structure, it uses the c++ standard list class 
-    inside. This stack can deletes an arbitrary element from the stack. This 
-    user defined stack data structure is used in the decompression program.
+    User defined stack data structure, it stores the elements in a vector. 
+    This stack can access and delete an arbitrary element by its position 
+    (counted from the bottom of the stack). An erased element leaves an empty 
+    tombstone behind, which is dropped when it reaches the top of the stack, 
+    so the other elements are never moved. Accessing or erasing an element by 
+    position costs O(log n) time. This user defined stack data structure is 
+    used in the decompression program.
 *******************************************************************************/
 template <class T>
 class My_stack {
 public:
-    // The iterator type
-    // Attention: 
-    //     The push() and clear() function will invalidate the iterator
-    using Const_iterator = typename std::list<T>::const_iterator;
-    
     // Constructor 
-    My_stack() {}
+    My_stack() : live_cnt(0) {}
     
     // Destructor
     ~My_stack() {}
@@ -72,59 +111,69 @@ public:
     // stack's size by one
     void pop();
     
-    // Returns an constant iterator pointing to the first element in the stack
-    // Returns:
-    //      An constant iterator that points to the first element in the stack
-    Const_iterator begin() const;
-    
-    // Returns an constant iterator referring to the past-the-end element 
-    // in the stack
+    // Returns a reference to the element at the given position
+    // Parameters: 
+    //      position: No. of elements below the element, must be less than size()
     // Returns:
-    //      An constant iterator to the element past the end of the sequence
-    Const_iterator end() const;
+    //      A reference to the element
+    T& at(int position);
     
     // Erases a single element from stack. It reduces the stack size by one
     // Parameters: 
-    //      pos: An constant iterator pointing to a single element to be removed 
-    //           from the list. pos must be valid
-    void erase(Const_iterator pos);
+    //      position: No. of elements below the element, must be less than size()
+    void erase(int position);
     
-    // Prints all the internal standard list elements to the given output stream
+    // Prints all the elements (bottom first) to the given output stream
     // This function is only used for debugging purpose
     // Parameters: 
-    //      ofile_stream: Given output stream to print all the internal 
-    //                    standard list elements 
+    //      ofile_stream: Given output stream to print all the elements 
     void print(std::ostream& ofile_stream) const;
     
 
 private:
-    // The standard list used as the private member of My_stack class
-    std::list<T> list;
+    // The elements and tombstones, bottom first
+    std::vector<T> slots;
+    
+    // True for the slots of the erased elements
+    std::vector<bool> tombstone;
+    
+    // The live element counts of the slots
+    Stack_rank_tree rank_tree;
+    
+    // No. of live elements
+    int live_cnt;
 };
 
 
 /*******************************************************************************
 Class: My_findable_stack
 Description:
-    User defined stack data structure, it use the c++ standard list class 
-    and standard map class inside. This stack can finds the internal 
-    element's position and deletes an arbitrary element from the stack. This 
-    user defined stack data structure is used in the compression program.
+    User defined stack data structure for integer values in the range 
+    [0, key_range), each value is on the stack at most once. This stack can 
+    find an element, get its position (counted from the bottom of the stack) 
+    and delete an arbitrary element from the stack. This user defined stack 
+    data structure is used in the compression program.
+    
+    The elements are stored in the same way as My_stack. The slot of each 
+    value is kept in a table indexed by the value, so find() is O(1), and 
+    position() and erase() are O(log n).
 *******************************************************************************/
 template <class T>
 class My_findable_stack {
 public:
-    // The iterator type
-    // Attention: 
-    //     The push() and clear() function will invalidate the iterator
-    using Const_iterator = typename std::list<T>::const_iterator;
-    
     // Constructor 
-    My_findable_stack() {}
+    // Parameters: 
+    //      key_range: The values stored in the stack are in [0, key_range)
+    explicit My_findable_stack(std::size_t key_range = 0);
     
     // Destructor
     ~My_findable_stack() {}
     
+    // Removes all elements from the stack and sets the range of the values
+    // Parameters: 
+    //      key_range: The values stored in the stack are in [0, key_range)
+    void reset(std::size_t key_range);
+    
     // Test whether the stack is empty, returns true if the stack contains 
     // no elements
     bool empty() const;
@@ -132,19 +181,15 @@ public:
     // Returns the number of the elements contained in the stack
     int size() const;
     
-    // Inserts a copy of value at the top of the stack
+    // Inserts a copy of value at the top of the stack. The value must not be 
+    // on the stack
     // Parameters: 
     //      value: Value to be copied to the new element
-    void push(T& value);
+    void push(const T& value);
     
     // Removes all elements from the stack, leaving the stack with a size of 0
     void clear();
     
-    // Returns a reference to the top element in the stack
-    // Returns:
-    //      A reference to the top element in the stack
-    T& top();
-    
     // Returns a constant reference to the top element in the stack
     // Returns:
     //      A constant reference to the top element in the stack
@@ -154,48 +199,51 @@ public:
     // stack's size by one
     void pop();
     
-    // Returns an constant iterator pointing to the first element in the stack
-    // Returns:
-    //      An constant iterator that points to the first element in the stack
-    Const_iterator begin() const;
-    
-    // Returns an constant iterator referring to the past-the-end element 
-    // in the stack
+    // Test whether the value is on the stack
+    // Parameters: 
+    //      value: Value to search for in the stack
     // Returns:
-    //      An constant iterator to the element past the end of the sequence
-    Const_iterator end() const;
+    //      True if the value is on the stack; otherwise, false
+    bool find(const T& value) const;
     
-    // Returns an constant iterator to the element that compares equal to value
-    // If no such element is found, the function returns the end iterator
+    // Returns the position of the value in the stack, the bottom element is at 
+    // position 0. The value must be on the stack
     // Parameters: 
     //      value: Value to search for in the stack
     // Returns:
-    //      An constant iterator to the element that compares equal to value. 
-    //      If no elements match, the function returns last
-    Const_iterator find(T value);
+    //      No. of elements below the value
+    int position(const T& value) const;
     
     // Erases a single element from stack. It reduces the stack size by one
     // Parameters: 
-    //      pos: An constant iterator pointing to a single element to be removed 
-    //           from the list. pos must be valid
-    void erase(Const_iterator pos);
+    //      value: Value to be removed, which must be on the stack
+    void erase(const T& value);
     
-    // Prints all the internal standard list elements to the given output stream
+    // Prints all the elements (bottom first) to the given output stream
     // This function is only used for debugging purpose
     // Parameters: 
-    //      ofile_stream: Given output stream to print all the internal 
-    //                    standard list elements 
+    //      ofile_stream: Given output stream to print all the elements 
     void print(std::ostream& ofile_stream) const;
     
 
 private:
-    // The standard list stores all the halfedge handles
-    std::list<T> list;
+    // Marks the value of an empty slot
+    static constexpr std::size_t no_slot = static_cast<std::size_t>(-1);
+    
+    // The elements and tombstones, bottom first
+    std::vector<T> slots;
+    
+    // True for the slots of the erased elements
+    std::vector<bool> tombstone;
+    
+    // The live element counts of the slots
+    Stack_rank_tree rank_tree;
+    
+    // The slot of each value, no_slot if the value is not on the stack
+    std::vector<std::size_t> slot_of;
     
-    // The map stores halfedge handles and list iterator
-    //    key = halfedge handles
-    //    value = the halfedge handles' iterator in the list
-    std::map<T, Const_iterator> map;
+    // No. of live elements
+    int live_cnt;
 };
 
 
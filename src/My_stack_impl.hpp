@@ -3,6 +3,96 @@
 
 
 
+//////////////////////////////////////////////////////////
+// Function implementation for Stack_rank_tree class 
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: void clear();
+Description:
+    Removes all slots
+*******************************************************************************/
+inline void Stack_rank_tree::clear() {
+    tree.assign(1, 0);
+}
+
+
+/*******************************************************************************
+Function: void push_back();
+Description:
+    Appends a live slot at the top. The count of the new node is computed 
+    from the prefix sums of the existing slots.
+*******************************************************************************/
+inline void Stack_rank_tree::push_back() {
+    std::size_t i = tree.size();
+    std::size_t lowbit = i & (~i + 1);
+    tree.push_back(1 + prefix(i - 1) - prefix(i - lowbit));
+}
+
+
+/*******************************************************************************
+Function: void pop_back();
+Description:
+    Removes the top slot. The nodes of the other slots do not cover it, so the 
+    tree is just shortened.
+*******************************************************************************/
+inline void Stack_rank_tree::pop_back() {
+    assert(tree.size() > 1);
+    tree.pop_back();
+}
+
+
+/*******************************************************************************
+Function: void kill(std::size_t slot);
+Description:
+    Marks the given slot as a tombstone
+*******************************************************************************/
+inline void Stack_rank_tree::kill(std::size_t slot) {
+    for (std::size_t i = slot + 1; i < tree.size(); i += i & (~i + 1)) {
+        --tree[i];
+    }
+}
+
+
+/*******************************************************************************
+Function: int prefix(std::size_t slot) const;
+Description:
+    Returns No. of live elements in the slots [0, slot)
+*******************************************************************************/
+inline int Stack_rank_tree::prefix(std::size_t slot) const {
+    int sum = 0;
+    for (std::size_t i = slot; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+
+/*******************************************************************************
+Function: std::size_t find_kth(int k) const;
+Description:
+    Returns the slot of the k-th live element. The tree is descended from the 
+    largest power of two node, skipping the nodes with at most k live elements.
+*******************************************************************************/
+inline std::size_t Stack_rank_tree::find_kth(int k) const {
+    std::size_t slots_cnt = tree.size() - 1;
+    std::size_t step = 1;
+    while (step * 2 <= slots_cnt) {
+        step *= 2;
+    }
+    
+    std::size_t pos = 0;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= slots_cnt && tree[pos + step] <= k) {
+            pos += step;
+            k -= tree[pos];
+        }
+    }
+    
+    return pos;
+}
+
+
 //////////////////////////////////////////////////////////
 // Function implementation for My_stack class 
 //////////////////////////////////////////////////////////
@@ -14,7 +104,7 @@ Description:
 *******************************************************************************/
 template <class T>
 bool My_stack<T>::empty() const {
-    return list.empty();
+    return live_cnt == 0;
 }
 
 
@@ -25,7 +115,7 @@ Description:
 *******************************************************************************/
 template <class T>
 int My_stack<T>::size() const {
-    return list.size();
+    return live_cnt;
 }
 
 
@@ -36,7 +126,10 @@ Description:
 *******************************************************************************/
 template <class T>
 void My_stack<T>::push(T& value) {
-    list.push_back(std::move(value));
+    slots.push_back(value);
+    tombstone.push_back(false);
+    rank_tree.push_back();
+    ++live_cnt;
 }
 
 
@@ -47,7 +140,10 @@ Description:
 *******************************************************************************/
 template <class T>
 void My_stack<T>::push(T&& value) {
-    list.push_back(std::move(value));
+    slots.push_back(std::move(value));
+    tombstone.push_back(false);
+    rank_tree.push_back();
+    ++live_cnt;
 }
 
 
@@ -58,7 +154,10 @@ Description:
 *******************************************************************************/
 template <class T>
 void My_stack<T>::clear() {
-    list.clear();
+    slots.clear();
+    tombstone.clear();
+    rank_tree.clear();
+    live_cnt = 0;
 }
 
 
@@ -69,7 +168,8 @@ Description:
 *******************************************************************************/
 template <class T>
 T& My_stack<T>::top() {
-    return list.back(); 
+    assert(!slots.empty() && !tombstone.back());
+    return slots.back(); 
 }
 
 
@@ -80,64 +180,75 @@ Description:
 *******************************************************************************/
 template <class T>
 const T& My_stack<T>::top() const {
-    return list.back(); 
+    assert(!slots.empty() && !tombstone.back());
+    return slots.back(); 
 }
 
 
 /*******************************************************************************
 Function: void pop();
 Description:
-    Removes the element on top of the stack, effectively reducing its size by one
+    Removes the element on top of the stack, effectively reducing its size by 
+    one. The tombstones that reach the top are dropped as well.
 *******************************************************************************/
 template <class T>
 void My_stack<T>::pop() {
-    list.pop_back();
-}
-
-
-/*******************************************************************************
-Function: Const_iterator begin() const;
-Description:
-    Returns an iterator pointing to the first element in the stack
-*******************************************************************************/
-template <class T>
-typename My_stack<T>::Const_iterator My_stack<T>::begin() const {
-    return list.begin();
+    assert(!slots.empty() && !tombstone.back());
+    --live_cnt;
+    do {
+        slots.pop_back();
+        tombstone.pop_back();
+        rank_tree.pop_back();
+    } while (!slots.empty() && tombstone.back());
 }
 
 
 /*******************************************************************************
-Function: Const_iterator end() const;
+Function: T& at(int position);
 Description:
-    Returns an iterator referring to the past-the-end element in the stack
+    Returns a reference to the element at the given position
 *******************************************************************************/
 template <class T>
-typename My_stack<T>::Const_iterator My_stack<T>::end() const {
-    return list.end();
+T& My_stack<T>::at(int position) {
+    assert(position >= 0 && position < live_cnt);
+    return slots[rank_tree.find_kth(position)];
 }
 
 
 /*******************************************************************************
-Function: void erase(Const_iterator pos);
+Function: void erase(int position);
 Description:
-    Erases a single element from stack. It reduces the stack size by one
+    Erases a single element from stack. It reduces the stack size by one. The 
+    element is replaced by an empty tombstone.
 *******************************************************************************/
 template <class T> 
-void My_stack<T>::erase(Const_iterator pos) {
-    list.erase(pos);
+void My_stack<T>::erase(int position) {
+    assert(position >= 0 && position < live_cnt);
+    std::size_t slot = rank_tree.find_kth(position);
+    if (slot + 1 == slots.size()) {
+        pop();
+        return;
+    }
+    
+    slots[slot] = T();
+    tombstone[slot] = true;
+    rank_tree.kill(slot);
+    --live_cnt;
 }
 
 
 /*******************************************************************************
 Function: void print(std::ostream& ofile_stream) const;
 Description:
-    Prints all the internal standard list elements to the given output 
-    stream. This function is only used for debugging purpose.
+    Prints all the elements (bottom first) to the given output stream. This 
+    function is only used for debugging purpose.
 *******************************************************************************/
 template <class T>
 void My_stack<T>::print(std::ostream& ofile_stream) const {
-    for(auto iter = list.begin(); iter != list.end(); ++iter) {
-        ofile_stream << *iter << " ";
+    for (std::size_t slot = 0; slot < slots.size(); ++slot) {
+        if (!tombstone[slot]) {
+            ofile_stream << slots[slot] << " ";
+        }
     }
     ofile_stream << "\n\n";
 }
@@ -147,6 +258,32 @@ void My_stack<T>::print(std::ostream& ofile_stream) const {
 // Function implementation for My_findable_stack class 
 //////////////////////////////////////////////////////////
 
+/*******************************************************************************
+Function: My_findable_stack(std::size_t key_range);
+Description:
+    My_findable_stack class constructor
+*******************************************************************************/
+template <class T>
+My_findable_stack<T>::My_findable_stack(std::size_t key_range) : live_cnt(0) {
+    reset(key_range);
+}
+
+
+/*******************************************************************************
+Function: void reset(std::size_t key_range);
+Description:
+    Removes all elements from the stack and sets the range of the values
+*******************************************************************************/
+template <class T>
+void My_findable_stack<T>::reset(std::size_t key_range) {
+    slots.clear();
+    tombstone.clear();
+    rank_tree.clear();
+    slot_of.assign(key_range, no_slot);
+    live_cnt = 0;
+}
+
+
 /*******************************************************************************
 Function: bool empty() const;
 Description:
@@ -154,8 +291,8 @@ Description:
 *******************************************************************************/
 template <class T>
 bool My_findable_stack<T>::empty() const {
-    assert(list.empty() == map.empty());
-    return list.empty();
+    assert((live_cnt == 0) == slots.empty());
+    return live_cnt == 0;
 }
 
 
@@ -166,22 +303,23 @@ Description:
 *******************************************************************************/
 template <class T>
 int My_findable_stack<T>::size() const {
-    assert(list.size() == map.size());
-    return list.size();
+    return live_cnt;
 }
 
 
 /*******************************************************************************
-Function: void push(T& value);
+Function: void push(const T& value);
 Description:
     Inserts a copy of value at the top of the stack
 *******************************************************************************/
 template <class T>
-void My_findable_stack<T>::push(T& value) {
-    list.push_back(value);
-    
-    Const_iterator value_iter = std::find(list.begin(), list.end(), value);
-    map.insert(std::pair<T, Const_iterator>(value, value_iter));
+void My_findable_stack<T>::push(const T& value) {
+    assert(!find(value));
+    slot_of[value] = slots.size();
+    slots.push_back(value);
+    tombstone.push_back(false);
+    rank_tree.push_back();
+    ++live_cnt;
 }
 
 
@@ -192,20 +330,15 @@ Description:
 *******************************************************************************/
 template <class T>
 void My_findable_stack<T>::clear() {
-    list.clear();
-    map.clear();
-}
-
-
-/*******************************************************************************
-Function: T& top();
-Description:
-    Returns a reference to the top element in the stack
-*******************************************************************************/
-template <class T>
-T& My_findable_stack<T>::top() {
-    assert(map.find(list.back()) != map.end());
-    return list.back(); 
+    for (std::size_t slot = 0; slot < slots.size(); ++slot) {
+        if (!tombstone[slot]) {
+            slot_of[slots[slot]] = no_slot;
+        }
+    }
+    slots.clear();
+    tombstone.clear();
+    rank_tree.clear();
+    live_cnt = 0;
 }
 
 
@@ -216,98 +349,88 @@ Description:
 *******************************************************************************/
 template <class T>
 const T& My_findable_stack<T>::top() const {
-    assert(map.find(list.back()) != map.end());
-    return list.back(); 
+    assert(!slots.empty() && !tombstone.back());
+    return slots.back(); 
 }
 
 
 /*******************************************************************************
 Function: void pop();
 Description:
-    Removes the element on top of the stack, effectively reducing its size by one
+    Removes the element on top of the stack, effectively reducing its size by 
+    one. The tombstones that reach the top are dropped as well.
 *******************************************************************************/
 template <class T>
 void My_findable_stack<T>::pop() {
-    T key = list.back();
-    map.erase(key);
-    list.pop_back();
-}
-
-
-/*******************************************************************************
-Function: Const_iterator begin() const;
-Description:
-    Returns an iterator pointing to the first element in the stack
-*******************************************************************************/
-template <class T>
-typename My_findable_stack<T>::Const_iterator My_findable_stack<T>::begin() const {
-    assert(map.find(*(list.begin())) != map.end());
-    return My_findable_stack<T>::Const_iterator(list.begin());
+    assert(!slots.empty() && !tombstone.back());
+    slot_of[slots.back()] = no_slot;
+    --live_cnt;
+    
+    do {
+        slots.pop_back();
+        tombstone.pop_back();
+        rank_tree.pop_back();
+    } while (!slots.empty() && tombstone.back());
 }
 
 
 /*******************************************************************************
-Function: Const_iterator end() const;
+Function: bool find(const T& value) const;
 Description:
-    Returns an iterator referring to the past-the-end element in the stack
+    Test whether the value is on the stack
 *******************************************************************************/
 template <class T>
-typename My_findable_stack<T>::Const_iterator My_findable_stack<T>::end() const {
-    return My_findable_stack<T>::Const_iterator(list.end());
+bool My_findable_stack<T>::find(const T& value) const {
+    return slot_of[value] != no_slot;
 }
 
 
 /*******************************************************************************
-Function: Const_iterator find(T value);
+Function: int position(const T& value) const;
 Description:
-    Returns an iterator to the element that compares equal to value
-    If no such element is found, the function returns the end iterator
+    Returns the position of the value in the stack (No. of elements below it)
 *******************************************************************************/
 template <class T>
-typename My_findable_stack<T>::Const_iterator My_findable_stack<T>::find(T value) {
-    typename std::map<T, Const_iterator>::iterator map_iter = map.find(value);
-    
-    if(map_iter == map.end()) {
-        return list.end();
-    }
-    
-    Const_iterator list_pos = map_iter -> second;
-    return list_pos;
+int My_findable_stack<T>::position(const T& value) const {
+    assert(find(value));
+    return rank_tree.prefix(slot_of[value]);
 }
 
 
 /*******************************************************************************
-Function: void erase(Const_iterator pos);
+Function: void erase(const T& value);
 Description:
     Erases a single element from stack. It reduces the stack size by one
 *******************************************************************************/
 template <class T> 
-void My_findable_stack<T>::erase(Const_iterator pos) {
-    T value = *pos;
-    list.erase(pos);
-    map.erase(value);
+void My_findable_stack<T>::erase(const T& value) {
+    assert(find(value));
+    std::size_t slot = slot_of[value];
+    if (slot + 1 == slots.size()) {
+        pop();
+        return;
+    }
+    
+    slot_of[value] = no_slot;
+    tombstone[slot] = true;
+    rank_tree.kill(slot);
+    --live_cnt;
 }
 
 
 /*******************************************************************************
 Function: void print(std::ostream& ofile_stream) const;
 Description:
-    Prints all the internal standard list elements to the given output 
-    stream. This function is only used for debugging purpose.
+    Prints all the elements (bottom first) to the given output stream. This 
+    function is only used for debugging purpose.
 *******************************************************************************/
 template <class T>
 void My_findable_stack<T>::print(std::ostream& ofile_stream) const {
     ofile_stream << "----------------------------------------\n";
-    ofile_stream << "Standard list part:\n";
-    for(auto iter = list.begin(); iter != list.end(); ++iter) {
-        ofile_stream << *iter << " ";
-    }
-    ofile_stream << "\n\n";
-
-    ofile_stream << "Standard map part:\n";
-    for(auto iter = map.begin(); iter != map.end(); ++iter) {
-        ofile_stream << iter -> first << " " << *(iter -> second) << "\n";
+    for (std::size_t slot = 0; slot < slots.size(); ++slot) {
+        if (!tombstone[slot]) {
+            ofile_stream << slots[slot] << " ";
+        }
     }
-    ofile_stream << "----------------------------------------\n";
+    ofile_stream << "\n----------------------------------------\n";
 }
-
@@ -0,0 +1,378 @@
+#include "Off_reader.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+//////////////////////////////////////////////////////////
+// Number scanner used by the OFF parser
+//////////////////////////////////////////////////////////
+
+namespace {
+
+// The powers of ten that can be represented exactly by a double
+const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Maximum No. of significant digits kept in the 64 bit mantissa
+const int max_mantissa_digits = 19;
+
+// Returns true if c is a white space character
+inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+// Returns true if c is a decimal digit
+inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+
+/*******************************************************************************
+Function: const char* skip_space(const char* p, const char* end);
+Description:
+    Skips the white spaces and comments (from '#' to the end of line)
+*******************************************************************************/
+inline const char* skip_space(const char* p, const char* end) {
+    while (p != end) {
+        if (*p == '#') {
+            while (p != end && *p != '\n') {
+                ++p;
+            }
+        }
+        else if (is_space(*p)) {
+            ++p;
+        }
+        else {
+            break;
+        }
+    }
+
+    return p;
+}
+
+
+/*******************************************************************************
+Function: const char* skip_line(const char* p, const char* end);
+Description:
+    Skips the rest of the current line
+*******************************************************************************/
+inline const char* skip_line(const char* p, const char* end) {
+    while (p != end && *p != '\n') {
+        ++p;
+    }
+
+    return p;
+}
+
+
+/*******************************************************************************
+Function: bool scan_int(const char*& p, const char* end, long& value);
+Description:
+    Scans a non-negative decimal integer. p is moved past the number.
+*******************************************************************************/
+inline bool scan_int(const char*& p, const char* end, long& value) {
+    p = skip_space(p, end);
+    if (p == end || !is_digit(*p)) {
+        return false;
+    }
+
+    long result = 0;
+    while (p != end && is_digit(*p)) {
+        result = result * 10 + (*p - '0');
+        if (result > std::numeric_limits<std::int32_t>::max()) {
+            return false;
+        }
+        ++p;
+    }
+
+    // The number must be followed by a white space
+    if (p != end && !is_space(*p) && *p != '#') {
+        return false;
+    }
+
+    value = result;
+    return true;
+}
+
+
+/*******************************************************************************
+Function: bool scan_real(const char*& p, const char* end, double& value);
+Description:
+    Scans a floating point number. p is moved past the number. The decimal
+    digits are accumulated into a 64 bit integer mantissa. When the mantissa
+    and the power of ten are both exactly representable by a double, the value
+    is computed with a single multiplication or division, which gives the same
+    correctly rounded result as strtod(). The other numbers (too many digits,
+    large exponents, inf, nan, ...) are handed to strtod().
+*******************************************************************************/
+inline bool scan_real(const char*& p, const char* end, double& value) {
+    p = skip_space(p, end);
+    const char* start = p;
+
+    // Sign
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    // Integer and fraction part
+    std::uint64_t mantissa = 0;
+    int mantissa_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+    bool exact = true;
+
+    while (p != end && is_digit(*p)) {
+        has_digits = true;
+        if (mantissa_digits < max_mantissa_digits) {
+            mantissa = mantissa * 10 + (*p - '0');
+            mantissa_digits += (mantissa != 0);
+        }
+        else {
+            exact = false;
+        }
+        ++p;
+    }
+
+    if (p != end && *p == '.') {
+        ++p;
+        while (p != end && is_digit(*p)) {
+            has_digits = true;
+            if (mantissa_digits < max_mantissa_digits) {
+                mantissa = mantissa * 10 + (*p - '0');
+                mantissa_digits += (mantissa != 0);
+                --exponent;
+            }
+            else {
+                exact = false;
+            }
+            ++p;
+        }
+    }
+
+    // Exponent part
+    if (has_digits && p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negative_exp = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative_exp = (*p == '-');
+            ++p;
+        }
+
+        if (p == end || !is_digit(*p)) {
+            return false;
+        }
+
+        int exp_value = 0;
+        while (p != end && is_digit(*p)) {
+            if (exp_value < 100000) {
+                exp_value = exp_value * 10 + (*p - '0');
+            }
+            ++p;
+        }
+        exponent += negative_exp ? -exp_value : exp_value;
+    }
+
+    bool token_end = (p == end || is_space(*p) || *p == '#');
+    if (has_digits && token_end && exact && mantissa <= (std::uint64_t(1) << 53) &&
+        exponent >= -22 && exponent <= 22) {
+        // Fast path
+        double result = static_cast<double>(mantissa);
+        if (exponent < 0) {
+            result /= exact_powers_of_ten[-exponent];
+        }
+        else {
+            result *= exact_powers_of_ten[exponent];
+        }
+
+        value = negative ? -result : result;
+        return true;
+    }
+
+    // Slow path, hand the whole token to strtod
+    p = start;
+    while (p != end && !is_space(*p) && *p != '#') {
+        ++p;
+    }
+
+    std::string token(start, p);
+    char* token_end_ptr = nullptr;
+    value = std::strtod(token.c_str(), &token_end_ptr);
+
+    return !token.empty() && token_end_ptr == token.c_str() + token.size();
+}
+
+}
+
+
+//////////////////////////////////////////////////////////
+// OFF file reader functions
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: bool parse_off(const char* begin, const char* end,
+                         std::vector<Point>& points,
+                         std::vector<Corner_index>& vertex_table);
+Description:
+    Parses a triangle mesh in OFF format from the given character buffer
+*******************************************************************************/
+bool parse_off(const char* begin, const char* end, std::vector<Point>& points,
+               std::vector<Corner_index>& vertex_table) {
+    const char* p = skip_space(begin, end);
+
+    // The header keyword. The optional prefixes (e.g. COFF, NOFF) only add
+    // values after the coordinates, which are skipped
+    const char* keyword = p;
+    while (p != end && !is_space(*p) && *p != '#') {
+        ++p;
+    }
+
+    std::string header(keyword, p);
+    if (header.size() < 3 || header.compare(header.size() - 3, 3, "OFF") != 0 ||
+        header.find_first_of("4n") != std::string::npos) {
+        std::cerr << "ERROR: Input file is not in OFF format!\n";
+        return false;
+    }
+
+    // Binary OFF files are not supported
+    const char* q = p;
+    while (q != end && (*q == ' ' || *q == '\t')) {
+        ++q;
+    }
+    if (end - q >= 6 && std::strncmp(q, "BINARY", 6) == 0) {
+        std::cerr << "ERROR: Binary OFF file is not supported!\n";
+        return false;
+    }
+
+    // No. of vertices, faces and edges
+    long vertices_cnt = 0, faces_cnt = 0, edges_cnt = 0;
+    if (!scan_int(p, end, vertices_cnt) || !scan_int(p, end, faces_cnt) ||
+        !scan_int(p, end, edges_cnt)) {
+        std::cerr << "ERROR: Invalid OFF file header!\n";
+        return false;
+    }
+    p = skip_line(p, end);
+
+    // Vertices
+    points.clear();
+    points.reserve(vertices_cnt);
+    for (long i = 0; i < vertices_cnt; ++i) {
+        double x = 0.0, y = 0.0, z = 0.0;
+        if (!scan_real(p, end, x) || !scan_real(p, end, y) || !scan_real(p, end, z)) {
+            std::cerr << "ERROR: Invalid vertex " << i << " in OFF file!\n";
+            return false;
+        }
+        points.push_back(Point(x, y, z));
+        p = skip_line(p, end);
+    }
+
+    // Faces
+    vertex_table.clear();
+    vertex_table.reserve(3 * faces_cnt);
+    for (long i = 0; i < faces_cnt; ++i) {
+        long face_size = 0;
+        if (!scan_int(p, end, face_size)) {
+            std::cerr << "ERROR: Invalid face " << i << " in OFF file!\n";
+            return false;
+        }
+
+        if (face_size != 3) {
+            std::cerr << "ERROR: Input mesh must be pure triangle\n";
+            return false;
+        }
+
+        for (int j = 0; j < 3; ++j) {
+            long index = 0;
+            if (!scan_int(p, end, index) || index >= vertices_cnt) {
+                std::cerr << "ERROR: Invalid face " << i << " in OFF file!\n";
+                return false;
+            }
+            vertex_table.push_back(index);
+        }
+        p = skip_line(p, end);
+    }
+
+    return true;
+}
+
+
+/*******************************************************************************
+Function: bool read_off_file(const std::string& fname,
+                             std::vector<Point>& points,
+                             std::vector<Corner_index>& vertex_table);
+Description:
+    Reads a triangle mesh in OFF format from the given file. The file is
+    memory mapped, the files that cannot be mapped (e.g. pipes) are read
+    through a file stream.
+*******************************************************************************/
+bool read_off_file(const std::string& fname, std::vector<Point>& points,
+                   std::vector<Corner_index>& vertex_table) {
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "ERROR: Cannot open input file " << fname << "\n";
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size == 0) {
+        // Not a regular file, read it through a stream
+        close(fd);
+        std::ifstream ifile(fname, std::ios::binary);
+        return read_off_stream(ifile, points, vertex_table);
+    }
+
+    std::size_t file_size = file_stat.st_size;
+    void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::ifstream ifile(fname, std::ios::binary);
+        return read_off_stream(ifile, points, vertex_table);
+    }
+
+    // The file is read once from the beginning to the end
+    madvise(data, file_size, MADV_SEQUENTIAL);
+
+    const char* begin = static_cast<const char*>(data);
+    bool result = parse_off(begin, begin + file_size, points, vertex_table);
+
+    munmap(data, file_size);
+    return result;
+}
+
+
+/*******************************************************************************
+Function: bool read_off_stream(std::istream& in, std::vector<Point>& points,
+                               std::vector<Corner_index>& vertex_table);
+Description:
+    Reads a triangle mesh in OFF format from the given input stream
+*******************************************************************************/
+bool read_off_stream(std::istream& in, std::vector<Point>& points,
+                     std::vector<Corner_index>& vertex_table) {
+    // Read the whole stream in large blocks
+    const std::size_t block_size = 1 << 20;
+    std::vector<char> buffer;
+    std::size_t buffer_len = 0;
+
+    while (in) {
+        buffer.resize(buffer_len + block_size);
+        in.read(buffer.data() + buffer_len, block_size);
+        buffer_len += in.gcount();
+    }
+
+    if (in.bad() || buffer_len == 0) {
+        std::cerr << "ERROR: Cannot read the input stream\n";
+        return false;
+    }
+
+    return parse_off(buffer.data(), buffer.data() + buffer_len, points, vertex_table);
+}
@@ -0,0 +1,78 @@
+// Off_reader.hpp
+// Description:
+//     The functions read a triangle mesh stored in OFF format directly into
+//     the vertex and triangle arrays used to build the Corner_table. The input
+//     file is memory mapped and the numbers are parsed in place.
+
+#ifndef off_reader_hpp
+#define off_reader_hpp
+
+#include "Utility.hpp"
+#include "Corner_table.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/*******************************************************************************
+Function: read_off_file()
+Description:
+    The function reads a triangle mesh in OFF format from the given file. The
+    file is memory mapped (if possible) and parsed without copying. The vertex
+    and face order of the file is kept.
+
+Parameters:
+    fname: The input file name
+    points: The vertices of the mesh
+    vertex_table: Three vertex indices for each triangle
+
+Return:
+    Upon success, true is returned; otherwise (the file cannot be read, or it
+    is not a valid OFF file that only contains triangles), false is returned
+*******************************************************************************/
+bool read_off_file(const std::string& fname, std::vector<Point>& points,
+                   std::vector<Corner_index>& vertex_table);
+
+
+/*******************************************************************************
+Function: read_off_stream()
+Description:
+    The function reads a triangle mesh in OFF format from the given input
+    stream. The whole stream is read into memory first, then it is parsed in
+    the same way as read_off_file().
+
+Parameters:
+    in: The input stream
+    points: The vertices of the mesh
+    vertex_table: Three vertex indices for each triangle
+
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool read_off_stream(std::istream& in, std::vector<Point>& points,
+                     std::vector<Corner_index>& vertex_table);
+
+
+/*******************************************************************************
+Function: parse_off()
+Description:
+    The function parses a triangle mesh in OFF format from the given character
+    buffer. Comments (from '#' to the end of line) are ignored, and anything
+    after the coordinates of a vertex or the indices of a face on the same line
+    (e.g. colors) is skipped.
+
+Parameters:
+    begin: The first character of the buffer
+    end: One past the last character of the buffer
+    points: The vertices of the mesh
+    vertex_table: Three vertex indices for each triangle
+
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool parse_off(const char* begin, const char* end, std::vector<Point>& points,
+               std::vector<Corner_index>& vertex_table);
+
+
+// #include "Off_reader.cpp"
+#endif
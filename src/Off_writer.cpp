@@ -0,0 +1,183 @@
+#include "Off_writer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+
+// Maximum No. of characters used by a double or an unsigned integer
+const std::size_t max_number_len = 32;
+
+
+//////////////////////////////////////////////////////////
+// Public functions from Off_writer class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Off_writer(int fd, std::size_t buffer_size);
+Description:
+    Off_writer class constructors
+*******************************************************************************/
+Off_writer::Off_writer(int fd, std::size_t buffer_size)
+  : fd(fd), buffer(std::max(buffer_size, 4 * max_number_len)), buffer_len(0), 
+    failed(false) {
+}
+
+
+/*******************************************************************************
+Function: ~Off_writer()
+Description:
+    Off_writer class destructors
+*******************************************************************************/
+Off_writer::~Off_writer() {
+    flush();
+}
+
+
+/*******************************************************************************
+Function: void write_header(std::size_t vertices_cnt, std::size_t faces_cnt);
+Description:
+    Write the OFF file header
+*******************************************************************************/
+void Off_writer::write_header(std::size_t vertices_cnt, std::size_t faces_cnt) {
+    write_string("OFF\n");
+    
+    reserve(3 * max_number_len);
+    put_uint(vertices_cnt);
+    buffer[buffer_len++] = ' ';
+    put_uint(faces_cnt);
+    buffer[buffer_len++] = ' ';
+    buffer[buffer_len++] = '0';
+    buffer[buffer_len++] = '\n';
+}
+
+
+/*******************************************************************************
+Function: void write_vertex(const Point& p);
+Description:
+    Write a vertex line
+*******************************************************************************/
+void Off_writer::write_vertex(const Point& p) {
+    reserve(4 * max_number_len);
+    put_real(p.x());
+    buffer[buffer_len++] = ' ';
+    put_real(p.y());
+    buffer[buffer_len++] = ' ';
+    put_real(p.z());
+    buffer[buffer_len++] = '\n';
+}
+
+
+/*******************************************************************************
+Function: void write_face(const Triangle_facet& tri_label);
+Description:
+    Write a triangle face line
+*******************************************************************************/
+void Off_writer::write_face(const Triangle_facet& tri_label) {
+    reserve(4 * max_number_len);
+    buffer[buffer_len++] = '3';
+    for (int i = 0; i < 3; ++i) {
+        buffer[buffer_len++] = ' ';
+        put_uint(tri_label.get_index(i));
+    }
+    buffer[buffer_len++] = '\n';
+}
+
+
+/*******************************************************************************
+Function: void write_string(const char* str);
+Description:
+    Write a string as it is
+*******************************************************************************/
+void Off_writer::write_string(const char* str) {
+    write_bytes(str, std::strlen(str));
+}
+
+
+/*******************************************************************************
+Function: void write_bytes(const void* data, std::size_t len);
+Description:
+    Write raw bytes as they are
+*******************************************************************************/
+void Off_writer::write_bytes(const void* data, std::size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        reserve(1);
+        std::size_t n = std::min(len, buffer.size() - buffer_len);
+        std::memcpy(buffer.data() + buffer_len, p, n);
+        buffer_len += n;
+        p += n;
+        len -= n;
+    }
+}
+
+
+/*******************************************************************************
+Function: bool flush();
+Description:
+    Write out the buffered data. The partial writes and the interrupted writes
+    are continued.
+*******************************************************************************/
+bool Off_writer::flush() {
+    const char* data = buffer.data();
+    std::size_t len = buffer_len;
+    
+    while (len > 0 && !failed) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed = true;
+        }
+        else {
+            data += n;
+            len -= n;
+        }
+    }
+    
+    buffer_len = 0;
+    return !failed;
+}
+
+
+//////////////////////////////////////////////////////////
+// Private functions from Off_writer class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: void reserve(std::size_t n);
+Description:
+    Make sure that at least n bytes are available in the buffer. The buffered 
+    data is written out if there is not enough space left.
+*******************************************************************************/
+void Off_writer::reserve(std::size_t n) {
+    if (buffer.size() - buffer_len < n) {
+        flush();
+    }
+}
+
+
+/*******************************************************************************
+Function: void put_uint(unsigned long value);
+Description:
+    Format an unsigned integer at the end of the buffer
+*******************************************************************************/
+void Off_writer::put_uint(unsigned long value) {
+    char* first = buffer.data() + buffer_len;
+    std::to_chars_result result = std::to_chars(first, first + max_number_len, value);
+    buffer_len += result.ptr - first;
+}
+
+
+/*******************************************************************************
+Function: void put_real(double value);
+Description:
+    Format a double at the end of the buffer. std::to_chars() without a 
+    precision gives the shortest representation that round-trips exactly.
+*******************************************************************************/
+void Off_writer::put_real(double value) {
+    char* first = buffer.data() + buffer_len;
+    std::to_chars_result result = std::to_chars(first, first + max_number_len, value);
+    buffer_len += result.ptr - first;
+}
@@ -0,0 +1,95 @@
+// Off_writer.hpp
+// Description:
+//     The Off_writer class writes a triangle mesh in OFF format to a file 
+//     descriptor. The numbers are formatted with std::to_chars into a large 
+//     reusable buffer, which is written out with write(2) when it is full.
+
+#ifndef off_writer_hpp
+#define off_writer_hpp
+
+#include "Utility.hpp"
+#include <cstddef>
+#include <vector>
+#include <unistd.h>
+
+
+/*******************************************************************************
+Class: Off_writer
+Description:
+    A class uses for writing a triangle mesh in OFF format. The real numbers 
+    are written in the shortest form that parses back to the same double.
+    
+Preconditions:
+    The file descriptor must be opened for writing. The file descriptor is not 
+    closed by the Off_writer object.
+*******************************************************************************/
+class Off_writer {
+public:
+    // A constructor create an Off_writer object with given parameter
+    // Parameters: 
+    //      fd: The output file descriptor
+    //      buffer_size: The size of the output buffer in bytes
+    Off_writer(int fd = STDOUT_FILENO, std::size_t buffer_size = 1 << 20);
+    
+    // Destructor, writes out the buffered data
+    ~Off_writer();
+    
+    // The Off_writer object cannot be copied
+    Off_writer(const Off_writer&) = delete;
+    Off_writer& operator=(const Off_writer&) = delete;
+    
+    // Write the OFF file header
+    // Parameters: 
+    //      vertices_cnt: No. of vertices in the mesh
+    //      faces_cnt: No. of faces in the mesh
+    void write_header(std::size_t vertices_cnt, std::size_t faces_cnt);
+    
+    // Write a vertex line
+    // Parameters: 
+    //      p: The vertex coordinates
+    void write_vertex(const Point& p);
+    
+    // Write a triangle face line
+    // Parameters: 
+    //      tri_label: The triangle's three vertices index
+    void write_face(const Triangle_facet& tri_label);
+    
+    // Write a string as it is
+    // Parameters: 
+    //      str: The null terminated string
+    void write_string(const char* str);
+    
+    // Write raw bytes as they are
+    // Parameters: 
+    //      data: The first byte to write
+    //      len: No. of bytes to write
+    void write_bytes(const void* data, std::size_t len);
+    
+    // Write out the buffered data
+    // Returns: 
+    //      Upon success, true is returned; otherwise (any write failed), false 
+    //      is returned
+    bool flush();
+    
+private:
+    // Make sure that at least n bytes are available in the buffer
+    void reserve(std::size_t n);
+    
+    // Format an unsigned integer/a double at the end of the buffer
+    void put_uint(unsigned long value);
+    void put_real(double value);
+    
+    // The output file descriptor
+    int fd;
+    
+    // The output buffer, and No. of bytes used in the buffer
+    std::vector<char> buffer;
+    std::size_t buffer_len;
+    
+    // A flag shows whether any write has failed
+    bool failed;
+};
+
+
+// #include "Off_writer.cpp"
+#endif
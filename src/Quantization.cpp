@@ -0,0 +1,242 @@
+#include "Quantization.hpp"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define EB_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+
+//////////////////////////////////////////////////////////
+// Quantization kernels
+//////////////////////////////////////////////////////////
+
+namespace {
+
+/*******************************************************************************
+Function: bool quantize_scalar(const double* coords, std::size_t cnt, double step,
+                               Quant_index max_index, Quant_index* indices);
+Description:
+    Quantizes the coordinates one at a time
+*******************************************************************************/
+bool quantize_scalar(const double* coords, std::size_t cnt, double step,
+                     Quant_index max_index, Quant_index* indices) {
+    const double limit = static_cast<double>(max_index) + 1.0;
+    for (std::size_t i = 0; i < cnt; ++i) {
+        double y = std::abs(coords[i]) / step + 0.5;
+        if (!(y < limit)) {
+            return false;
+        }
+        Quant_index index = static_cast<Quant_index>(y);
+        indices[i] = (coords[i] < 0.0) ? -index : index;
+    }
+    return true;
+}
+
+
+/*******************************************************************************
+Function: void dequantize_scalar(const Quant_index* indices, std::size_t cnt,
+                                 double step, double* coords);
+Description:
+    Re-quantizes the coordinates one at a time
+*******************************************************************************/
+void dequantize_scalar(const Quant_index* indices, std::size_t cnt, double step,
+                       double* coords) {
+    for (std::size_t i = 0; i < cnt; ++i) {
+        coords[i] = indices[i] * step;
+    }
+}
+
+
+#if defined(EB_SIMD_X86)
+
+/*******************************************************************************
+Function: bool quantize_sse41(const double* coords, std::size_t cnt, double step,
+                              Quant_index max_index, Quant_index* indices);
+Description:
+    Quantizes two coordinates at a time. The rounded magnitude (|x| / step +
+    0.5 is positive, so floor is truncation) gets the sign bit of x, then it
+    is converted to an integer. The comparison is also true for NaN.
+*******************************************************************************/
+__attribute__((target("sse4.1")))
+bool quantize_sse41(const double* coords, std::size_t cnt, double step,
+                    Quant_index max_index, Quant_index* indices) {
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d steps = _mm_set1_pd(step);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d limit = _mm_set1_pd(static_cast<double>(max_index) + 1.0);
+    __m128d overflow = _mm_setzero_pd();
+
+    std::size_t i = 0;
+    for (; i + 2 <= cnt; i += 2) {
+        __m128d x = _mm_loadu_pd(coords + i);
+        __m128d y = _mm_add_pd(_mm_div_pd(_mm_andnot_pd(sign, x), steps), half);
+        overflow = _mm_or_pd(overflow, _mm_cmpnlt_pd(y, limit));
+        __m128d t = _mm_round_pd(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        t = _mm_or_pd(t, _mm_and_pd(sign, x));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(indices + i), _mm_cvttpd_epi32(t));
+    }
+
+    if (_mm_movemask_pd(overflow) != 0) {
+        return false;
+    }
+    return quantize_scalar(coords + i, cnt - i, step, max_index, indices + i);
+}
+
+
+/*******************************************************************************
+Function: bool quantize_avx2(const double* coords, std::size_t cnt, double step,
+                             Quant_index max_index, Quant_index* indices);
+Description:
+    Quantizes four coordinates at a time, in the same way as quantize_sse41()
+*******************************************************************************/
+__attribute__((target("avx2")))
+bool quantize_avx2(const double* coords, std::size_t cnt, double step,
+                   Quant_index max_index, Quant_index* indices) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d steps = _mm256_set1_pd(step);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d limit = _mm256_set1_pd(static_cast<double>(max_index) + 1.0);
+    __m256d overflow = _mm256_setzero_pd();
+
+    std::size_t i = 0;
+    for (; i + 4 <= cnt; i += 4) {
+        __m256d x = _mm256_loadu_pd(coords + i);
+        __m256d y = _mm256_add_pd(_mm256_div_pd(_mm256_andnot_pd(sign, x), steps), half);
+        overflow = _mm256_or_pd(overflow, _mm256_cmp_pd(y, limit, _CMP_NLT_UQ));
+        __m256d t = _mm256_round_pd(y, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        t = _mm256_or_pd(t, _mm256_and_pd(sign, x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), _mm256_cvttpd_epi32(t));
+    }
+
+    if (_mm256_movemask_pd(overflow) != 0) {
+        return false;
+    }
+    return quantize_scalar(coords + i, cnt - i, step, max_index, indices + i);
+}
+
+
+/*******************************************************************************
+Function: void dequantize_sse41(const Quant_index* indices, std::size_t cnt,
+                                double step, double* coords);
+Description:
+    Re-quantizes two coordinates at a time
+*******************************************************************************/
+__attribute__((target("sse4.1")))
+void dequantize_sse41(const Quant_index* indices, std::size_t cnt, double step,
+                      double* coords) {
+    const __m128d steps = _mm_set1_pd(step);
+
+    std::size_t i = 0;
+    for (; i + 2 <= cnt; i += 2) {
+        __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i));
+        _mm_storeu_pd(coords + i, _mm_mul_pd(_mm_cvtepi32_pd(q), steps));
+    }
+    dequantize_scalar(indices + i, cnt - i, step, coords + i);
+}
+
+
+/*******************************************************************************
+Function: void dequantize_avx2(const Quant_index* indices, std::size_t cnt,
+                               double step, double* coords);
+Description:
+    Re-quantizes four coordinates at a time
+*******************************************************************************/
+__attribute__((target("avx2")))
+void dequantize_avx2(const Quant_index* indices, std::size_t cnt, double step,
+                     double* coords) {
+    const __m256d steps = _mm256_set1_pd(step);
+
+    std::size_t i = 0;
+    for (; i + 4 <= cnt; i += 4) {
+        __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i));
+        _mm256_storeu_pd(coords + i, _mm256_mul_pd(_mm256_cvtepi32_pd(q), steps));
+    }
+    dequantize_scalar(indices + i, cnt - i, step, coords + i);
+}
+
+#endif
+
+
+/*******************************************************************************
+Function: Simd_isa detect_isa();
+Description:
+    Detects the widest instruction set supported by the processor
+*******************************************************************************/
+Simd_isa detect_isa() {
+#if defined(EB_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return Simd_isa::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Simd_isa::sse41;
+    }
+#endif
+    return Simd_isa::scalar;
+}
+
+}
+
+
+//////////////////////////////////////////////////////////
+// Dispatch functions
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Simd_isa simd_isa();
+Description:
+    Returns the widest instruction set supported by the program and the
+    processor
+*******************************************************************************/
+Simd_isa simd_isa() {
+    static const Simd_isa isa = detect_isa();
+    return isa;
+}
+
+
+/*******************************************************************************
+Function: bool quantize_coordinates(const double* coords, std::size_t cnt,
+                                    double step, Quant_index max_index,
+                                    Quant_index* indices, Simd_isa isa);
+Description:
+    Quantizes one coordinate of a block of vertices with the given
+    instruction set
+*******************************************************************************/
+bool quantize_coordinates(const double* coords, std::size_t cnt, double step,
+                          Quant_index max_index, Quant_index* indices,
+                          Simd_isa isa) {
+#if defined(EB_SIMD_X86)
+    if (isa == Simd_isa::avx2) {
+        return quantize_avx2(coords, cnt, step, max_index, indices);
+    }
+    if (isa == Simd_isa::sse41) {
+        return quantize_sse41(coords, cnt, step, max_index, indices);
+    }
+#endif
+    return quantize_scalar(coords, cnt, step, max_index, indices);
+}
+
+
+/*******************************************************************************
+Function: void dequantize_coordinates(const Quant_index* indices,
+                                      std::size_t cnt, double step,
+                                      double* coords, Simd_isa isa);
+Description:
+    Re-quantizes one coordinate of a block of vertices with the given
+    instruction set
+*******************************************************************************/
+void dequantize_coordinates(const Quant_index* indices, std::size_t cnt,
+                            double step, double* coords, Simd_isa isa) {
+#if defined(EB_SIMD_X86)
+    if (isa == Simd_isa::avx2) {
+        dequantize_avx2(indices, cnt, step, coords);
+        return;
+    }
+    if (isa == Simd_isa::sse41) {
+        dequantize_sse41(indices, cnt, step, coords);
+        return;
+    }
+#endif
+    dequantize_scalar(indices, cnt, step, coords);
+}
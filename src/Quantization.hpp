@@ -0,0 +1,85 @@
+// Quantization.hpp
+// Description:
+//     Batch kernels which convert the vertex coordinates of one axis between
+//     double and quantization indices. The kernels use SSE4.1 or AVX2 when
+//     the processor supports them, the widest instruction set available is
+//     selected at run time. The results are the same for all of them.
+
+#ifndef quantization_hpp
+#define quantization_hpp
+
+#include "Utility.hpp"
+#include <cstddef>
+
+
+/*******************************************************************************
+Enum: Simd_isa
+Description:
+    The instruction set used by the quantization kernels.
+    scalar: Plain C++ code, used on every processor.
+    sse41: SSE4.1, two coordinates at a time.
+    avx2: AVX2, four coordinates at a time.
+*******************************************************************************/
+enum class Simd_isa {
+    scalar = 0,
+    sse41 = 1,
+    avx2 = 2
+};
+
+
+/*******************************************************************************
+Function: simd_isa()
+Description:
+    The function returns the widest instruction set supported by both the
+    program and the processor. It is detected once.
+
+Return:
+    The instruction set used by default
+*******************************************************************************/
+Simd_isa simd_isa();
+
+
+/*******************************************************************************
+Function: quantize_coordinates()
+Description:
+    The function quantizes one coordinate of a block of vertices. Each
+    coordinate x is mapped to signum(x) * floor(|x| / step + 0.5), which must
+    not be larger than max_index in magnitude.
+
+Parameters:
+    coords: The coordinates
+    cnt: No. of coordinates
+    step: The quantization step size (greater than 0)
+    max_index: The largest allowed magnitude of a quantization index
+    indices: The quantization indices of the coordinates (output)
+    isa: The instruction set to use, it must be supported by the processor
+
+Return:
+    True if all of the indices are in range; otherwise (including NaN
+    coordinates), false is returned and the content of indices is undefined
+*******************************************************************************/
+bool quantize_coordinates(const double* coords, std::size_t cnt, double step,
+                          Quant_index max_index, Quant_index* indices,
+                          Simd_isa isa = simd_isa());
+
+
+/*******************************************************************************
+Function: dequantize_coordinates()
+Description:
+    The function re-quantizes one coordinate of a block of vertices, i.e. each
+    quantization index is multiplied by the step size.
+
+Parameters:
+    indices: The quantization indices
+    cnt: No. of quantization indices
+    step: The quantization step size
+    coords: The coordinates (output)
+    isa: The instruction set to use, it must be supported by the processor
+*******************************************************************************/
+void dequantize_coordinates(const Quant_index* indices, std::size_t cnt,
+                            double step, double* coords,
+                            Simd_isa isa = simd_isa());
+
+
+// #include "Quantization.cpp"
+#endif
@@ -0,0 +1,103 @@
+// Ring_buffer.hpp
+// Description:
+//      A bounded first-in first-out queue between two threads. It is used by
+//      the decoder to pass the decoded values from one stage of its pipeline
+//      to the next stage.
+
+#ifndef ring_buffer_hpp
+#define ring_buffer_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+
+/*******************************************************************************
+Class: Ring_buffer
+Description:
+    A bounded queue with a single producer thread and a single consumer
+    thread. The elements are stored in a circular array whose size is a power
+    of two. The producer and the consumer only share the two positions of the
+    queue, so an element is pushed or popped without a lock. A thread only
+    takes the lock and sleeps if the queue is full (for the producer) or
+    empty (for the consumer). A sleeping thread is only woken up when a
+    quarter of the queue is free (for the producer) or filled (for the
+    consumer), so the two threads do not take turns for every element when
+    they share a processor. Either thread can close the queue, after which
+    the producer cannot push, and the consumer pops the elements left in the
+    queue.
+*******************************************************************************/
+template <class T>
+class Ring_buffer {
+public:
+    // Constructor
+    // Parameters:
+    //      capacity: The least No. of elements the queue can hold
+    explicit Ring_buffer(std::size_t capacity = 4096);
+
+    Ring_buffer(const Ring_buffer&) = delete;
+    Ring_buffer& operator=(const Ring_buffer&) = delete;
+
+    // Inserts an element at the end of the queue, waits while the queue is
+    // full. Only called by the producer thread
+    // Parameters:
+    //      value: The element to insert
+    // Returns:
+    //      If the queue is closed, false is returned; otherwise, true is
+    //      returned
+    bool push(const T& value);
+
+    // Removes the element at the front of the queue, waits while the queue
+    // is empty and not closed. Only called by the consumer thread
+    // Parameters:
+    //      value: The removed element (output)
+    // Returns:
+    //      If the queue is closed and empty, false is returned; otherwise,
+    //      true is returned
+    bool pop(T& value);
+
+    // Closes the queue and wakes up the waiting thread
+    void close();
+
+private:
+    // Sleeps until the given condition is true
+    // Parameters:
+    //      ready: The condition to wait for
+    template <class Condition>
+    void wait(Condition ready);
+
+    // Wakes up the other thread if it sleeps
+    void wake();
+
+
+    // The elements of the queue
+    std::vector<T> slots;
+
+    // The size of slots minus one
+    std::size_t mask;
+
+    // No. of free slots (for the producer) or elements (for the consumer) a
+    // sleeping thread waits for
+    std::size_t batch;
+
+    // The No. of elements popped and pushed so far, the queue holds the
+    // elements [head, tail)
+    std::atomic<std::size_t> head;
+    std::atomic<std::size_t> tail;
+
+    // Set when the queue is closed
+    std::atomic<bool> closed;
+
+    // No. of threads which sleep on ready_cond
+    std::atomic<int> sleepers;
+
+    // The lock and the condition variable of the sleeping thread
+    std::mutex sleep_mutex;
+    std::condition_variable ready_cond;
+};
+
+
+#include "Ring_buffer_impl.hpp"
+#endif
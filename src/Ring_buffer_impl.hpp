@@ -0,0 +1,132 @@
+#include <algorithm>
+#include "Ring_buffer.hpp"
+
+
+
+//////////////////////////////////////////////////////////
+// Function implementation for Ring_buffer class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Ring_buffer(std::size_t capacity);
+Description:
+    Ring_buffer class constructors, the capacity is rounded up to a power of
+    two
+*******************************************************************************/
+template <class T>
+Ring_buffer<T>::Ring_buffer(std::size_t capacity)
+  : head(0), tail(0), closed(false), sleepers(0) {
+    std::size_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    slots.resize(size);
+    mask = size - 1;
+    batch = std::max<std::size_t>(size / 4, 1);
+}
+
+
+/*******************************************************************************
+Function: bool push(const T& value);
+Description:
+    Inserts an element at the end of the queue. The new tail is published
+    after the element is stored, so the consumer never reads an unfinished
+    slot.
+*******************************************************************************/
+template <class T>
+bool Ring_buffer<T>::push(const T& value) {
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+    if (pos - head.load(std::memory_order_acquire) == slots.size()) {
+        wait([&]() { return pos - head.load() <= slots.size() - batch || closed.load(); });
+    }
+    if (closed.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    slots[pos & mask] = value;
+    tail.store(pos + 1);
+
+    // The consumer sleeps until the queue has batch elements
+    if (pos + 1 - head.load() == batch) {
+        wake();
+    }
+    return true;
+}
+
+
+/*******************************************************************************
+Function: bool pop(T& value);
+Description:
+    Removes the element at the front of the queue
+*******************************************************************************/
+template <class T>
+bool Ring_buffer<T>::pop(T& value) {
+    std::size_t pos = head.load(std::memory_order_relaxed);
+    if (tail.load(std::memory_order_acquire) == pos) {
+        wait([&]() { return tail.load() - pos >= batch || closed.load(); });
+        if (tail.load() == pos) {
+            return false;
+        }
+    }
+
+    value = slots[pos & mask];
+    head.store(pos + 1);
+
+    // The producer sleeps until the queue has batch free slots
+    if (tail.load() - (pos + 1) == slots.size() - batch) {
+        wake();
+    }
+    return true;
+}
+
+
+/*******************************************************************************
+Function: void close();
+Description:
+    Closes the queue. The lock is taken, so a thread which is about to sleep
+    either sees the closed queue or is woken up.
+*******************************************************************************/
+template <class T>
+void Ring_buffer<T>::close() {
+    closed.store(true);
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    ready_cond.notify_all();
+}
+
+
+/*******************************************************************************
+Function: void wait(Condition ready);
+Description:
+    Sleeps until the condition is true. The sleeper count is raised before
+    the condition is tested, and the other thread tests the sleeper count
+    after it moves its position, so at least one of them sees the other. The
+    other thread only wakes up this thread when the condition becomes true,
+    which happens once while this thread waits, since only the other thread
+    moves its position.
+*******************************************************************************/
+template <class T>
+template <class Condition>
+void Ring_buffer<T>::wait(Condition ready) {
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    sleepers.fetch_add(1);
+    while (!ready()) {
+        ready_cond.wait(lock);
+    }
+    sleepers.fetch_sub(1);
+}
+
+
+/*******************************************************************************
+Function: void wake();
+Description:
+    Wakes up the other thread if it sleeps. The lock is taken, so the other
+    thread is either not sleeping yet and sees the new position, or is
+    waiting on the condition variable.
+*******************************************************************************/
+template <class T>
+void Ring_buffer<T>::wake() {
+    if (sleepers.load() != 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        ready_cond.notify_all();
+    }
+}
@@ -0,0 +1,53 @@
+#include "Union_find.hpp"
+
+
+//////////////////////////////////////////////////////////
+// Functions from Union_find class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Union_find(Corner_index size);
+Description:
+    Union_find class constructors
+*******************************************************************************/
+Union_find::Union_find(Corner_index size) : parent(size), rank(size, 0) {
+    for (Corner_index v = 0; v < size; ++v) {
+        parent[v] = v;
+    }
+}
+
+
+/*******************************************************************************
+Function: Corner_index size() const;
+Description:
+    Returns No. of elements
+*******************************************************************************/
+Corner_index Union_find::size() const {
+    return static_cast<Corner_index>(parent.size());
+}
+
+
+//////////////////////////////////////////////////////////
+// Functions from Concurrent_union_find class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Concurrent_union_find(Corner_index size);
+Description:
+    Concurrent_union_find class constructors
+*******************************************************************************/
+Concurrent_union_find::Concurrent_union_find(Corner_index size) : parent(size) {
+    for (Corner_index v = 0; v < size; ++v) {
+        parent[v].store(v, std::memory_order_relaxed);
+    }
+}
+
+
+/*******************************************************************************
+Function: Corner_index size() const;
+Description:
+    Returns No. of elements
+*******************************************************************************/
+Corner_index Concurrent_union_find::size() const {
+    return static_cast<Corner_index>(parent.size());
+}
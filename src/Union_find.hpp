@@ -0,0 +1,130 @@
+// Union_find.hpp
+// Description:
+//     Disjoint set (union-find) data structures on dense vertex indices. 
+//     Union_find is used by a single thread, Concurrent_union_find can be 
+//     updated by several threads at the same time without locks.
+
+#ifndef union_find_hpp
+#define union_find_hpp
+
+#include "Corner_table.hpp"
+#include <atomic>
+#include <utility>
+#include <vector>
+
+
+/*******************************************************************************
+Class: Union_find
+Description:
+    Disjoint set forest with union by rank and path compression (path 
+    halving). Initially each element 0 ... size - 1 is in its own set.
+*******************************************************************************/
+class Union_find {
+public:
+    // A constructor create a Union_find object with given parameters
+    // Parameters: 
+    //      size: No. of elements
+    explicit Union_find(Corner_index size);
+    
+    // Returns the root element of the set containing v
+    Corner_index find(Corner_index v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    }
+    
+    // Merges the sets containing a and b
+    void unite(Corner_index a, Corner_index b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return;
+        }
+        if (rank[a] < rank[b]) {
+            parent[a] = b;
+        }
+        else if (rank[a] > rank[b]) {
+            parent[b] = a;
+        }
+        else {
+            parent[b] = a;
+            ++rank[a];
+        }
+    }
+    
+    // Returns No. of elements
+    Corner_index size() const;
+    
+private:
+    // The parent of each element, the roots are their own parents
+    std::vector<Corner_index> parent;
+    
+    // Upper bound of the height of each tree
+    std::vector<unsigned char> rank;
+};
+
+
+/*******************************************************************************
+Class: Concurrent_union_find
+Description:
+    Disjoint set forest which can be updated by several threads at the same 
+    time. A root is always linked under a root with a smaller index (with a 
+    compare and swap), so the root of each set is its smallest element. Paths 
+    are compressed by path halving.
+*******************************************************************************/
+class Concurrent_union_find {
+public:
+    // A constructor create a Concurrent_union_find object with given parameters
+    // Parameters: 
+    //      size: No. of elements
+    explicit Concurrent_union_find(Corner_index size);
+    
+    // Returns the root element of the set containing v. When it is called 
+    // concurrently with unite(), the result may be outdated at return
+    Corner_index find(Corner_index v) {
+        Corner_index p = parent[v].load(std::memory_order_relaxed);
+        while (p != v) {
+            Corner_index gp = parent[p].load(std::memory_order_relaxed);
+            if (gp != p) {
+                // Only a shortcut to an ancestor is written, so a failure 
+                // caused by another thread can be ignored
+                parent[v].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            }
+            v = p;
+            p = gp;
+        }
+        return v;
+    }
+    
+    // Merges the sets containing a and b
+    void unite(Corner_index a, Corner_index b) {
+        while (true) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return;
+            }
+            if (a < b) {
+                std::swap(a, b);
+            }
+            // Link the root a under b, retry if a is not a root any more
+            Corner_index expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+    
+    // Returns No. of elements
+    Corner_index size() const;
+    
+private:
+    // The parent of each element, the roots are their own parents
+    std::vector<std::atomic<Corner_index>> parent;
+};
+
+
+// #include "Union_find.cpp"
+#endif
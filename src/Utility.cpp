@@ -183,15 +183,17 @@ bool step_size_convert(double coord, Quant_index& coef, int& exp) {
 
 
 /*******************************************************************************
-Function: geometry_prediction(Point* a, Point* b, Point* d);
+Function: geometry_prediction(const Quant_point* a, const Quant_point* b, 
+                              const Quant_point* d);
 Description:
     Parallelogram prediction function. This function predicts the vertex c's 
-    location using parallelogram prediction scheme
+    location using parallelogram prediction scheme. The midpoint is rounded 
+    toward zero. The sums are computed in 64 bits, so they do not overflow.
 *******************************************************************************/
-Point geometry_predict(Point* a, Point* b, Point* d) {
+Quant_point geometry_predict(const Quant_point* a, const Quant_point* b, const Quant_point* d) {
     if (a == nullptr && b == nullptr && d == nullptr) {
         // No point is known before the prediction
-        return CGAL::ORIGIN;
+        return Quant_point();
     }
     else if (b == nullptr && d == nullptr) {
         // Only point a is known before the prediction
@@ -199,19 +201,19 @@ Point geometry_predict(Point* a, Point* b, Point* d) {
     }
     else if (d == nullptr) {
         // Points a and b are known before the prediction
-        int x = ((a -> x()) + (b -> x())) / 2;
-        int y = ((a -> y()) + (b -> y())) / 2;
-        int z = ((a -> z()) + (b -> z())) / 2;
+        Quant_index x = (static_cast<long long>(a -> x()) + b -> x()) / 2;
+        Quant_index y = (static_cast<long long>(a -> y()) + b -> y()) / 2;
+        Quant_index z = (static_cast<long long>(a -> z()) + b -> z()) / 2;
 
-        return Point(x, y, z);
+        return Quant_point(x, y, z);
     }
     
     // Points a, b, d are all known before the prediction
-    int x = ((a -> x()) + (b -> x()) - (d -> x()));
-    int y = ((a -> y()) + (b -> y()) - (d -> y()));
-    int z = ((a -> z()) + (b -> z()) - (d -> z()));
+    Quant_index x = static_cast<long long>(a -> x()) + b -> x() - d -> x();
+    Quant_index y = static_cast<long long>(a -> y()) + b -> y() - d -> y();
+    Quant_index z = static_cast<long long>(a -> z()) + b -> z() - d -> z();
     
-    return Point(x, y, z);
+    return Quant_point(x, y, z);
 }
 
 
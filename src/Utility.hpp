@@ -9,11 +9,14 @@
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <thread>
+#include <vector>
 #include <SPL/math.hpp>
 #include <SPL/arithCoder.hpp>
 #include <SPL/bitStream.hpp>
 #include <CGAL/Cartesian.h>
 #include "Context_selector.hpp"
+#include "Bin_coder.hpp"
 
 
 //////////////////////////////////////////////////////////
@@ -58,9 +61,16 @@ const int f_levels = 3;    // Levels of full trees in UI function
 const int max_contexts = Context_selector::total_contexts(coor_max_bits, f_levels);
 const int total_contexts_cnt = 3 * max_contexts;
 
-// Some basic types to be used with SPL BinArithEncoder/BinArithEDecoder class
-typedef SPL::BinArithEncoder MyArithEncoder;
-typedef SPL::BinArithDecoder MyArithDecoder;
+// The binary arithmetic coders of the geometry part, which code the bits with 
+// SPL BinArithEncoder/BinArithDecoder or with the range coder (see Bin_coder.hpp)
+typedef Bin_encoder MyArithEncoder;
+typedef Bin_decoder MyArithDecoder;
+
+// The code_series field of the EB file header also stores the geometry coder 
+// type (Bin_coder_type) in the bits above code_series_bits. The field of the  
+// files coded with the SPL coder only contains the code series.
+const int code_series_bits = 8;
+const int code_series_mask = (1 << code_series_bits) - 1;
 
 
 //////////////////////////////////////////////////////////
@@ -162,6 +172,93 @@ private:
 };
 
 
+/*******************************************************************************
+Class: Quant_point
+Description:
+    A vertex position in quantization indices (i.e. the coordinates divided by 
+    the quantization step sizes and rounded). The geometry prediction and the 
+    prediction errors are computed on these integers, so the encoder and the 
+    decoder get the same results regardless of the floating point rounding.
+*******************************************************************************/
+class Quant_point {
+public:
+    // Constructor, creates the point (0, 0, 0)
+    Quant_point() : coor{0, 0, 0} {}
+    
+    // A constructor create a Quant_point object with given coordinates
+    Quant_point(Quant_index x, Quant_index y, Quant_index z) : coor{x, y, z} {}
+    
+    // Gets the coordinates
+    Quant_index x() const { return coor[0]; }
+    Quant_index y() const { return coor[1]; }
+    Quant_index z() const { return coor[2]; }
+    
+    // Gets the coordinate of the given axis (0: x, 1: y, 2: z)
+    Quant_index operator[](int axis) const { return coor[axis]; }
+    
+    // Coordinate-wise sum and difference
+    Quant_point operator+(const Quant_point& other) const {
+        return Quant_point(coor[0] + other.coor[0], coor[1] + other.coor[1], 
+                           coor[2] + other.coor[2]);
+    }
+    Quant_point operator-(const Quant_point& other) const {
+        return Quant_point(coor[0] - other.coor[0], coor[1] - other.coor[1], 
+                           coor[2] - other.coor[2]);
+    }
+    
+    
+private:
+    // The x, y and z quantization indices
+    Quant_index coor[3];
+};
+
+
+/*******************************************************************************
+Class: Quant_point_array
+Description:
+    An array of Quant_point stored as a structure of arrays, i.e. one 
+    contiguous array for each coordinate. 
+*******************************************************************************/
+class Quant_point_array {
+public:
+    // Returns the No. of points
+    std::size_t size() const { return coor[0].size(); }
+    
+    // Changes the No. of points, the new points are (0, 0, 0)
+    void resize(std::size_t n) {
+        coor[0].resize(n);
+        coor[1].resize(n);
+        coor[2].resize(n);
+    }
+    
+    // Removes all points
+    void clear() {
+        resize(0);
+    }
+    
+    // Gets the point at the given index
+    Quant_point operator[](std::size_t i) const {
+        return Quant_point(coor[0][i], coor[1][i], coor[2][i]);
+    }
+    
+    // Sets the point at the given index
+    void set(std::size_t i, const Quant_point& p) {
+        coor[0][i] = p.x();
+        coor[1][i] = p.y();
+        coor[2][i] = p.z();
+    }
+    
+    // Gets the array of the coordinates of the given axis (0: x, 1: y, 2: z)
+    Quant_index* data(int axis) { return coor[axis].data(); }
+    const Quant_index* data(int axis) const { return coor[axis].data(); }
+    
+    
+private:
+    // The x, y and z coordinates of the points
+    std::vector<Quant_index> coor[3];
+};
+
+
 /*******************************************************************************
 Function: std::ostream& operator<<(std::ostream& outStream, const Triangle_facet& tri_label);
 Description:
@@ -236,10 +333,12 @@ bool step_size_convert(double coord, Quant_index& coef, int& exp);
 
 
 /*******************************************************************************
-Function: geometry_prediction(Point* a, Point* b, Point* d);
+Function: geometry_prediction(const Quant_point* a, const Quant_point* b, 
+                              const Quant_point* d);
 Description:
     Parallelogram prediction function. This function predicts the vertex c's 
-    location using parallelogram prediction scheme
+    location using parallelogram prediction scheme. Only integer arithmetic 
+    is used.
 
 Parameters: 
         a: The first vertex from current triangle (a, b, c)
@@ -249,7 +348,31 @@ Parameters:
 Returns:
         The predicted vertex location 
 *******************************************************************************/
-Point geometry_predict(Point* a, Point* b, Point* d);
+Quant_point geometry_predict(const Quant_point* a, const Quant_point* b, const Quant_point* d);
+
+
+/*******************************************************************************
+Function: void run_threads(unsigned threads_cnt, Function fn);
+Description:
+    Calls fn(t) for t = 0 ... threads_cnt - 1 in parallel, fn(0) is called by 
+    the calling thread. The function returns after all of the calls finished.
+
+Parameters: 
+        threads_cnt: No. of threads
+        fn: The function called by each thread
+*******************************************************************************/
+template <class Function>
+void run_threads(unsigned threads_cnt, Function fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(threads_cnt);
+    for (unsigned t = 1; t < threads_cnt; ++t) {
+        threads.emplace_back(fn, t);
+    }
+    fn(0);
+    for (auto it = threads.begin(); it != threads.end(); ++it) {
+        it->join();
+    }
+}
 
 
 // #include "Utility_impl.hpp"
@@ -1,7 +1,14 @@
 #include "decoder.hpp"
+#include "Component_container.hpp"
 #include <fstream>
+#include <sstream>
+#include <atomic>
+#include <numeric>
 #include <chrono>
 #include <cmath>
+#include <tuple>
+#include <fcntl.h>
+#include <sys/resource.h>
 #include <SPL/Timer.hpp>
 
 
@@ -15,14 +22,288 @@ void usage() {
               << "Usage:\n"
               << "decode_mesh [OPTIONS] \n"
               << "-r $result_file:  Writes the mesh compression information to the given file.\n"
+              << "                  The whole mesh is kept in memory to count its edges.\n"
               << "-h:   Prints the help info about the different command line options.  \n"
+              << "-o $output_file:  Writes the decompressed triangle mesh to the given file.\n"
+              << "                  If not specified, the mesh is written to the standard output.\n"
+              << "-f $format:       The output file format, one of:\n"
+              << "                  off: OFF text file (default).\n"
+              << "                  float: Binary mesh with float32 vertex coordinates.\n"
+              << "                  double: Binary mesh with float64 vertex coordinates.\n"
+              << "                  The binary mesh contains a 32 byte header, the vertex array\n"
+              << "                  and the uint32 index array (see Binary_mesh_writer.hpp).\n"
+              << "-i $input_file:   Reads the compressed triangle mesh from the given file.\n"
+              << "                  If not specified, the mesh is read from the standard input.\n"
+              << "-c $chunk:        Decodes only the given chunk (connected component or\n"
+              << "                  patch) of an EB version 2 file, the other chunks are not\n"
+              << "                  read. The seam vertices of a patch are not welded.\n"
+              << "-t:   Prints the time spent in each stage of the decoder, the time to the\n"
+              << "      first triangle and the peak memory usage. The times of the chunks of\n"
+              << "      an EB version 2 file are summed.\n"
               << "\n"
               << "The input triangle mesh is stored in EB format.\n"
-              << "The output decompressed triangle mesh is stored in OFF format.\n"
+              << "The output decompressed triangle mesh is stored in OFF format by default.\n"
               << "=============================================================================\n";
 }
 
 
+/*******************************************************************************
+Function: count_welded_edges(const std::vector<Triangle_facet>& triangles, 
+                             const std::vector<Vertex_index>& face_offset, 
+                             Vertex_index seams_cnt)
+@Description:
+    Count the edges which are shared by the triangles of two chunks after the 
+    seam vertices are welded. Each of them is counted by both chunks.
+    
+Parameter:
+    triangles: The triangles of the merged mesh
+    face_offset: The first triangle of each chunk, and No. of triangles
+    seams_cnt: No. of seam vertices, which are the first vertices
+    
+Return:
+    No. of edges between two chunks
+*******************************************************************************/
+Vertex_index count_welded_edges(const std::vector<Triangle_facet>& triangles, 
+                                const std::vector<Vertex_index>& face_offset, 
+                                Vertex_index seams_cnt) {
+    // The edges between two seam vertices, with the chunk of their triangle
+    std::vector<std::tuple<Vertex_index, Vertex_index, std::size_t>> edges;
+    for (std::size_t c = 0; c + 1 < face_offset.size(); ++c) {
+        for (Vertex_index t = face_offset[c]; t < face_offset[c + 1]; ++t) {
+            for (int i = 0; i < 3; ++i) {
+                Vertex_index a = triangles[t].get_index(i);
+                Vertex_index b = triangles[t].get_index((i + 1) % 3);
+                if (a < seams_cnt && b < seams_cnt) {
+                    edges.emplace_back(std::min(a, b), std::max(a, b), c);
+                }
+            }
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    
+    Vertex_index welded_cnt = 0;
+    for (std::size_t i = 1; i < edges.size(); ++i) {
+        if (std::get<0>(edges[i]) == std::get<0>(edges[i - 1]) && 
+            std::get<1>(edges[i]) == std::get<1>(edges[i - 1]) && 
+            std::get<2>(edges[i]) != std::get<2>(edges[i - 1])) {
+            ++welded_cnt;
+        }
+    }
+    return welded_cnt;
+}
+
+
+/*******************************************************************************
+Function: decode_components(const Eb_input& input, long chunk, int ofd, 
+                            Output_format format, bool mesh_info, 
+                            std::vector<Vertex_index>& result_vec, 
+                            Point& step_size, Decoding_times& times)
+@Description:
+    Decompress a triangle mesh which is stored in an EB version 2 container. 
+    The chunks are decoded by a pool of threads, the largest chunks first. 
+    Each chunk is decoded straight from the input, and directly into its 
+    place in the merged vertex and triangle arrays, which is known from the 
+    chunk directory. Its vertex indices are offset by No. of vertices of the 
+    chunks before it. The merged mesh is written to the output file 
+    descriptor. If a single chunk is selected, only the header, the directory 
+    and that chunk are read.
+    
+    If the chunks are patches of a mesh, the copies of each seam vertex are 
+    welded into a single vertex. The seam vertices come first in the merged 
+    vertex array, followed by the other vertices of each chunk. The chunk 
+    which lists a seam vertex first writes its coordinates. The boundary 
+    loops and genus in the mesh information are the sums over the patches.
+    
+Parameter:
+    input: The EB version 2 container
+    chunk: The chunk to decode, or -1 to decode all of the chunks
+    ofd: File descriptor to write the decompressed mesh
+    format: The output file format
+    mesh_info: Generates the mesh information if set
+    result_vec: The mesh information of the merged mesh (output)
+    step_size: The quantization step size (output)
+    times: The time spent in each stage of the decoder, summed over the 
+           chunks. The time to the first triangle is the time until the 
+           merged mesh is written (output)
+    
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool decode_components(const Eb_input& input, long chunk, int ofd, Output_format format, 
+                       bool mesh_info, std::vector<Vertex_index>& result_vec, Point& step_size, 
+                       Decoding_times& times) {
+    auto start_t = std::chrono::steady_clock::now();
+    
+    std::vector<Component_entry> entries;
+    if (!read_component_container(input.data(), input.size(), entries)) {
+        std::cerr << "ERROR: Invalid EB version 2 container! \n";
+        return false;
+    }
+    
+    if (chunk >= static_cast<long>(entries.size())) {
+        std::cerr << "ERROR: The EB file only has " << entries.size() << " chunks! \n";
+        return false;
+    }
+    if (chunk >= 0) {
+        entries = std::vector<Component_entry>(1, entries[chunk]);
+        entries.front().welds_cnt = 0;
+    }
+    
+    // The weld maps, and the first chunk which lists each seam vertex
+    std::vector<std::vector<Weld_entry>> welds(entries.size());
+    std::vector<std::size_t> owner;
+    for (std::size_t c = 0; c < entries.size(); ++c) {
+        read_weld_map(input.data(), entries[c], welds[c]);
+        if (welds[c].size() > entries[c].vertices_cnt) {
+            std::cerr << "ERROR: Invalid weld map of chunk " << c << "! \n";
+            return false;
+        }
+        for (auto it = welds[c].begin(); it != welds[c].end(); ++it) {
+            if (it->seam_vertex >= owner.size()) {
+                owner.resize(it->seam_vertex + std::size_t(1), entries.size());
+            }
+            if (owner[it->seam_vertex] == entries.size()) {
+                owner[it->seam_vertex] = c;
+            }
+        }
+    }
+    if (std::find(owner.begin(), owner.end(), entries.size()) != owner.end()) {
+        std::cerr << "ERROR: Seam vertex without any chunk! \n";
+        return false;
+    }
+    
+    // The first vertex and triangle of each component in the merged mesh, the 
+    // seam vertices are not counted
+    std::vector<Vertex_index> vertex_offset(entries.size() + 1, owner.size());
+    std::vector<Vertex_index> face_offset(entries.size() + 1, 0);
+    for (std::size_t c = 0; c < entries.size(); ++c) {
+        vertex_offset[c + 1] = vertex_offset[c] + entries[c].vertices_cnt - welds[c].size();
+        face_offset[c + 1] = face_offset[c] + entries[c].faces_cnt;
+    }
+    
+    std::vector<Point> vertices(vertex_offset.back());
+    std::vector<Triangle_facet> triangles(face_offset.back(), Triangle_facet(0, 0, 0));
+    
+    std::vector<std::size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return entries[a].size > entries[b].size;
+    });
+    
+    std::vector<std::vector<Vertex_index>> results(entries.size());
+    std::vector<Decoding_times> chunk_times(entries.size());
+    std::vector<char> failed(entries.size(), 0);
+    std::atomic<std::size_t> next_component(0);
+    
+    unsigned threads_cnt = std::max(1u, std::thread::hardware_concurrency());
+    threads_cnt = static_cast<unsigned>(std::min<std::size_t>(threads_cnt, entries.size()));
+    run_threads(threads_cnt, [&](unsigned) {
+        std::size_t k;
+        while ((k = next_component++) < order.size()) {
+            std::size_t c = order[k];
+            Chunk_buffer chunk_buf(input.data() + entries[c].offset, entries[c].size);
+            std::istream ifile(&chunk_buf);
+            Decoder dec(ifile);
+            dec.mesh_decoding();
+            chunk_times[c] = dec.get_decoding_times();
+            
+            const std::vector<Point>& dec_vertices = dec.get_vertices();
+            const std::vector<Triangle_facet>& dec_triangles = dec.get_triangles();
+            if (dec_vertices.size() != entries[c].vertices_cnt || 
+                dec_triangles.size() != entries[c].faces_cnt) {
+                failed[c] = 1;
+                continue;
+            }
+            
+            // The index of each vertex of the chunk in the merged mesh
+            const std::vector<Vertex_index>& coding_order = dec.get_coding_order();
+            Vertex_index no_vertex = vertices.size();
+            std::vector<Vertex_index> new_index(dec_vertices.size(), no_vertex);
+            bool valid = coding_order.size() == dec_vertices.size();
+            for (auto it = welds[c].begin(); valid && it != welds[c].end(); ++it) {
+                valid = it->position < coding_order.size() && 
+                        new_index[coding_order[it->position]] == no_vertex;
+                if (valid) {
+                    Vertex_index label = coding_order[it->position];
+                    new_index[label] = it->seam_vertex;
+                    if (owner[it->seam_vertex] == c) {
+                        vertices[it->seam_vertex] = dec_vertices[label];
+                    }
+                }
+            }
+            if (!valid) {
+                failed[c] = 1;
+                continue;
+            }
+            
+            Vertex_index next_vertex = vertex_offset[c];
+            for (std::size_t v = 0; v < dec_vertices.size(); ++v) {
+                if (new_index[v] == no_vertex) {
+                    new_index[v] = next_vertex;
+                    vertices[next_vertex++] = dec_vertices[v];
+                }
+            }
+            
+            auto tri = triangles.begin() + face_offset[c];
+            for (auto it = dec_triangles.begin(); it != dec_triangles.end(); ++it, ++tri) {
+                *tri = Triangle_facet(new_index[it->get_index(0)], new_index[it->get_index(1)], 
+                                      new_index[it->get_index(2)]);
+            }
+            
+            if (mesh_info) {
+                results[c] = dec.compression_result();
+            }
+            if (c == 0) {
+                step_size = dec.get_quan_step_size();
+            }
+        }
+    });
+    
+    for (std::size_t c = 0; c < entries.size(); ++c) {
+        if (failed[c]) {
+            std::cerr << "ERROR: Chunk " << c << " does not match the chunk directory! \n";
+            return false;
+        }
+    }
+    
+    // The triangles are only written once all of the chunks are merged
+    auto merged_t = std::chrono::steady_clock::now();
+    if (!write_mesh(ofd, format, vertices, triangles)) {
+        std::cerr << "ERROR: Output the decompressed triangle mesh failed!\n";
+        return false;
+    }
+    
+    times = Decoding_times();
+    times.first_triangle = std::chrono::duration<double>(merged_t - start_t).count();
+    for (auto it = chunk_times.begin(); it != chunk_times.end(); ++it) {
+        times.tables += it->tables;
+        times.residuals += it->residuals;
+        times.connectivity += it->connectivity;
+        times.reconstruction += it->reconstruction;
+        times.pipeline += it->pipeline;
+    }
+    
+    // The mesh information is the sum over the chunks, except the total No. 
+    // of bytes which includes the container directory, and No. of vertices 
+    // and edges which count the welded vertices and edges once
+    if (mesh_info) {
+        result_vec.assign(results.front().size(), 0);
+        for (auto it = results.begin(); it != results.end(); ++it) {
+            for (std::size_t i = 0; i < it->size(); ++i) {
+                result_vec[i] += (*it)[i];
+            }
+        }
+        if (!owner.empty()) {
+            result_vec[0] = vertices.size();
+            result_vec[1] -= count_welded_edges(triangles, face_offset, owner.size());
+        }
+        result_vec[5] = (chunk >= 0) ? entries.front().size : input.size();
+    }
+    
+    return true;
+}
+
+
 /*******************************************************************************
 Function: main()
 @Description:
@@ -37,10 +318,16 @@ int main(int argc, char** argv) {
     // Variable initialization
     int output_result = 0;    // Output result to given file
     std::string result_fname;    // Output result file name
+    std::string output_fname;    // Output mesh file name
+    Output_format output_format = Output_format::off;    // Output mesh file format
+    std::string format_name;
+    std::string input_fname;    // Input EB file name
+    long chunk = -1;    // The chunk to decode, -1 for all of the chunks
+    bool print_times = false;    // Print the time of each decoder stage
     
     // User specified quantization step size
     char opt;
-    while ((opt = getopt(argc, argv, "hr:")) != EOF) {
+    while ((opt = getopt(argc, argv, "hr:o:f:i:c:t")) != EOF) {
         switch (opt) {
             case 'h':
                 usage();
@@ -51,6 +338,73 @@ int main(int argc, char** argv) {
                 output_result = 1;
                 result_fname = optarg;
                 break;
+                
+            case 'o':
+                output_fname = optarg;
+                break;
+                
+            case 'f':
+                format_name = optarg;
+                if (format_name == "off") {
+                    output_format = Output_format::off;
+                }
+                else if (format_name == "float") {
+                    output_format = Output_format::binary_float;
+                }
+                else if (format_name == "double") {
+                    output_format = Output_format::binary_double;
+                }
+                else {
+                    usage();
+                    std::cerr << "ERROR: Unknown output format " << format_name << "\n";
+                    return 1;
+                }
+                break;
+                
+            case 'i':
+                input_fname = optarg;
+                break;
+                
+            case 'c':
+                chunk = atol(optarg);
+                if (chunk < 0) {
+                    std::cerr << "ERROR: The chunk cannot be negative!\n";
+                    return 1;
+                }
+                break;
+                
+            case 't':
+                print_times = true;
+                break;
+        }
+    }
+    
+    // Open the input EB file, it is memory mapped if possible
+    Eb_input input;
+    int ifile_fd = STDIN_FILENO;
+    if (!input_fname.empty()) {
+        ifile_fd = open(input_fname.c_str(), O_RDONLY);
+        if (ifile_fd < 0) {
+            std::cerr << "ERROR: Cannot open input file " << input_fname << "\n";
+            return 1;
+        }
+    }
+    bool read_input = input.open(ifile_fd);
+    if (ifile_fd != STDIN_FILENO) {
+        close(ifile_fd);
+    }
+    if (!read_input) {
+        std::cerr << "ERROR: Cannot read the compressed triangle mesh!\n";
+        return 1;
+    }
+    
+    // Open the output mesh file
+    int ofile_fd = STDOUT_FILENO;
+    if (!output_fname.empty()) {
+        ofile_fd = open(output_fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (ofile_fd < 0) {
+            std::cerr << "ERROR: Cannot open output file " << output_fname << "\n";
+            return 1;
         }
     }
     
@@ -59,10 +413,53 @@ int main(int argc, char** argv) {
     //////////////////////////////////////////////////////////
 
     auto start_t = std::chrono::high_resolution_clock::now();
-    Decoder dec(std::cin);
-    dec.mesh_decompression();
+    
+    // An EB version 1 file is a single EB stream, which is decoded straight 
+    // from the input
+    std::vector<Vertex_index> result_vec;
+    Point step_size;
+    Decoding_times times;
+    if (is_component_container(input.data(), input.size())) {
+        if (!decode_components(input, chunk, ofile_fd, output_format, output_result == 1, 
+                               result_vec, step_size, times)) {
+            return 1;
+        }
+    }
+    else {
+        if (chunk > 0) {
+            std::cerr << "ERROR: The EB version 1 file only has 1 chunk! \n";
+            return 1;
+        }
+        
+        Chunk_buffer chunk_buf(input.data(), input.size());
+        std::istream ifile(&chunk_buf);
+        Decoder dec(ifile, ofile_fd);
+        dec.set_output_format(output_format);
+        
+        // The mesh information counts the edges of the whole mesh, so the 
+        // decoder keeps the mesh; otherwise, the mesh is passed to the output 
+        // file while it is decoded
+        if (output_result == 1) {
+            dec.mesh_decompression();
+            result_vec = dec.compression_result();
+        }
+        else {
+            Mesh_file_sink sink(ofile_fd, output_format);
+            if (!dec.decode(sink)) {
+                std::cerr << "ERROR: Output the decompressed triangle mesh failed!\n";
+                return 1;
+            }
+        }
+        step_size = dec.get_quan_step_size();
+        times = dec.get_decoding_times();
+    }
     auto end_t = std::chrono::high_resolution_clock::now();
     
+    if (ofile_fd != STDOUT_FILENO && close(ofile_fd) != 0) {
+        std::cerr << "ERROR: Cannot close output file " << output_fname << "\n";
+        return 1;
+    }
+    
     
     //////////////////////////////////////////////////////////
     // Generate mesh information 
@@ -70,7 +467,6 @@ int main(int argc, char** argv) {
     
     if (output_result == 1) {
         std::ofstream ofile_result(result_fname);
-        std::vector<Vertex_index> result_vec = dec.compression_result();
         
         double run_time = std::chrono::duration<double>(end_t - start_t).count();
         double peak_mem = SPL::getPeakMemUsage();
@@ -81,8 +477,6 @@ int main(int argc, char** argv) {
         }
         
         ofile_result << run_time << " " << peak_mem << " ";
-        
-        Point step_size = dec.get_quan_step_size();
         ofile_result << step_size << "\n";
         
         ofile_result.flush();
@@ -91,6 +485,23 @@ int main(int argc, char** argv) {
             return 1;
         }
     }
+    
+    // The residual, connectivity and reconstruction stages run at the same 
+    // time, their times do not include the time they wait for each other
+    if (print_times) {
+        std::clog << "Time of reading the header and tables is: " << times.tables << " seconds \n";
+        std::clog << "Time of the residual decoding stage is: " << times.residuals << " seconds \n";
+        std::clog << "Time of the connectivity stage is: " << times.connectivity << " seconds \n";
+        std::clog << "Time of the reconstruction stage is: " << times.reconstruction << " seconds \n";
+        std::clog << "Elapsed time of the decoding pipeline is: " << times.pipeline << " seconds \n";
+        std::clog << "Time to the first triangle is: " << times.first_triangle << " seconds \n";
+        
+        // The peak resident memory, in bytes
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+            std::clog << "Peak memory usage is: " << usage.ru_maxrss * 1024LL << " bytes \n";
+        }
+    }
 
     
     return 0;
@@ -4,20 +4,36 @@
 #include <utility>
 #include <map>
 #include <limits>
+#include <chrono>
+#include <ctime>
+#include <fcntl.h>
 #include "decoder.hpp"
 
 
+/*******************************************************************************
+Function: double thread_time()
+@Description:
+    Returns the processor time (in seconds) used by the calling thread
+*******************************************************************************/
+static double thread_time() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
 //////////////////////////////////////////////////////////
 // Public functions from Decoder class
 //////////////////////////////////////////////////////////
 
 /*******************************************************************************
-Function: Decoder(std::istream& ifile);
+Function: Decoder(std::istream& ifile, int ofd);
 Description:
     Decoder class constructors
 *******************************************************************************/
-Decoder::Decoder(std::istream& ifile)
-  : ifile_eb(ifile), dec(total_contexts_cnt) {
+Decoder::Decoder(std::istream& ifile, int ofd)
+  : b_list(node_pool), ifile_eb(ifile), ofile_fd(ofd), 
+    output_format(Output_format::off), dec(total_contexts_cnt) {
     e_vertex = 0;
     triangle_cnt = 0;
     vertex_count = 0;
@@ -63,83 +79,89 @@ Function: mesh_decompression()
     should interact with to decompress the entire triangle mesh.
 *******************************************************************************/  
 void Decoder::mesh_decompression() {
-    // Read the EB file from input stream          
+    mesh_decoding();
+    
+    // Output the decompressed triangle mesh in OFF format
+    bool out = write_output();
+    if (!out) {
+        std::cerr << "ERROR: Output the decompressed triangle mesh failed!\n";
+        exit(1);
+    }
+}
+
+
+/*******************************************************************************
+Function: mesh_decoding()
+@Description:
+    Function used to decompress the triangle mesh without writing it. The 
+    decompressed mesh is kept by the decoder.
+*******************************************************************************/  
+void Decoder::mesh_decoding() {
+    // The collector does not stop the decompression
+    Mesh_collector collector(vertices_vec, tv_table);
+    decode(collector);
+}
+
+
+/*******************************************************************************
+Function: bool decode(Mesh_sink& sink)
+@Description:
+    Function used to decompress the triangle mesh into the given sink. The 
+    sink is told No. of vertices and triangles from the header before the 
+    geometry part is decoded.
+*******************************************************************************/  
+bool Decoder::decode(Mesh_sink& sink) {
+    start_time = std::chrono::steady_clock::now();
+    
+    // Read the EB file from input stream up to the geometry part
     bool file = read_ebfile();
     if (!file) {
         std::cerr << "ERROR: Failed to read the compressed triangle mesh! \n";
         exit(1);
     }
     
-    // Decompression preprocessing phase
-    initializing();
-    for (int node = 0; node <= e_vertex; ++node) {
-        b_list.push_back(node);
-    }
-
-    assert(vertex_count == 0);
-    Point delta = points_vec[vertex_count];
-    vertices_vec[e_vertex].point = delta;
-    vertices_vec[e_vertex].prediction = true;
-    
-    // // Print the predicted position and its corresponding original point
-    // std::clog << "First point to predict \n";
-    // std::clog << "Input point: " << delta << ", predicted position: " << delta << "\n";
-    
-    // Geometry reconstruct the second vertex in the mesh
-    Point a = vertices_vec[e_vertex].point;
-    
-    delta = points_vec[++vertex_count];
-    assert(vertex_count == 1);
-    
-    Quant_index c_x = delta.x() + a.x();
-    Quant_index c_y = delta.y() + a.y();
-    Quant_index c_z = delta.z() + a.z();
+    auto pipeline_t = std::chrono::steady_clock::now();
+    times.tables = std::chrono::duration<double>(pipeline_t - start_time).count();
     
-    // // Print the predicted position and its corresponding original point
-    // std::clog << "Second point to predict \n";
-    // std::clog << "Input point: " << c_x << " " << c_y << " " << c_z << ", predicted position: " << delta << "\n";
+    if (!sink.begin(quant_vertices.size(), history_vec.size())) {
+        return false;
+    }
     
-    vertices_vec[0].point = Point(c_x, c_y, c_z);
-    vertices_vec[0].prediction = true;
-        
-    // Decompression generation phase
-    table_generating();
-
-    // Re-quantization all vertices coordinates
-    for (auto vit = vertices_vec.begin(); vit != vertices_vec.end(); ++vit) {
-        Point p = (*vit).point;
-        
-        double x = 0.0, y = 0.0, z = 0.0;
-        if (step_size.x() != 1.0) {
-            x = p.x() * step_size.x();
-        }
-        else {
-            x = p.x();
-        }
-        
-        if (step_size.y() != 1.0) {
-            y = p.y() * step_size.y();
+    // Run the residual, connectivity and reconstruction stages in parallel
+    bool residuals_read = false;
+    bool reconstructed = false;
+    bool delivered = false;
+    run_threads(3, [&](unsigned stage) {
+        double stage_t = thread_time();
+        if (stage == 0) {
+            reconstructed = vertex_reconstructing(sink, delivered);
+            times.reconstruction = thread_time() - stage_t;
         }
-        else {
-            y = p.y();
-        }
-        
-        if (step_size.z() != 1.0) {
-            z = p.z() * step_size.z();
+        else if (stage == 1) {
+            connectivity_generating();
+            times.connectivity = thread_time() - stage_t;
         }
         else {
-            z = p.z();
+            residuals_read = residual_decoding();
+            times.residuals = thread_time() - stage_t;
         }
-        
-        (*vit).point = Point(x, y, z);
-    }
+    });
+    times.pipeline = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - pipeline_t).count();
     
-    // Output the decompressed triangle mesh in OFF format to the standard output
-    bool out = write_output();
-    if (!out) {
-        std::cerr << "ERROR: Output the decompressed triangle mesh failed!\n";
+    if (!delivered) {
+        return false;
+    }
+    if (!residuals_read) {
+        std::cerr << "ERROR: Failed to read the compressed triangle mesh! \n";
         exit(1);
     }
+    if (!reconstructed) {
+        std::cerr << "ERROR: The No. of vertices does not match the op-code history! \n";
+        exit(1);
+    }
+    
+    return sink.end();
 }
 
 /*******************************************************************************
@@ -295,242 +317,60 @@ Point Decoder::get_quan_step_size() {
 }
 
 
-//////////////////////////////////////////////////////////
-// private functions from Decoder class
-//////////////////////////////////////////////////////////
+/*******************************************************************************
+Function: const std::vector<Point>& get_vertices() const;
+Description:
+    Returns the decompressed vertices
+*******************************************************************************/
+const std::vector<Point>& Decoder::get_vertices() const {
+    return vertices_vec;
+}
+
 
 /*******************************************************************************
-Function: static void get_history_code1(const std::string& binary_string, 
-                                        std::vector<Triangle_type>& hist_vec);
-@Description:
-    Generate the compression history vector from the input file, this function 
-    use code series 1 from D. King's 3.67V bit paper.
+Function: const std::vector<Triangle_facet>& get_triangles() const;
+Description:
+    Returns the decompressed triangles
 *******************************************************************************/
-void Decoder::get_history_code1(const std::string& binary_string, std::vector<Triangle_type>& hist_vec) {
-    // Initialize current op-code and previous op-code
-    Triangle_type opcode = I, prev_opcode = I;
-    // Declare three characters to store the input code
-    char input_ch, char_2nd, char_3rd;
-    
-    for (int i = 0; i < binary_string.length(); ++i) {
-        input_ch = binary_string[i];
-        char_2nd = binary_string[i+1];
-        char_3rd = binary_string[i+2];
-        
-        // C type
-        if (input_ch == '0') { 
-            opcode = C; 
-        }
-        
-        // Current op-code follows a C code
-        else if (input_ch == '1' && prev_opcode == C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = S; 
-            }
-            else if (char_2nd == '1') { 
-                opcode = R; 
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Current op-code NOT follows a C code
-        else if (input_ch == '1' && prev_opcode != C) {
-            // check the second and third characters
-            if (char_2nd == '0' && char_3rd == '0') { 
-                opcode = S; 
-            }
-            else if (char_2nd == '0' && char_3rd == '1') { 
-                opcode = R; 
-            }
-            else if (char_2nd == '1' && char_3rd == '0') { 
-                opcode = L; 
-            }
-            else if (char_2nd == '1' && char_3rd == '1') { 
-                opcode = E; 
-            }
-            
-            // Update the string location count
-            i += 2;
-        }
-        
-        // Add current op-code to the history vector
-        hist_vec.push_back(opcode);
-        
-        // Update the previous op-code
-        prev_opcode = opcode;
-    }
+const std::vector<Triangle_facet>& Decoder::get_triangles() const {
+    return tv_table;
 }
 
 
 /*******************************************************************************
-Function: static void get_history_code2(const std::string& binary_string, 
-                                        std::vector<Triangle_type>& hist_vec);
-@Description:
-    Generate the compression history vector from the input file, this function 
-    use code series 2 from D. King's 3.67V bit paper.
+Function: const std::vector<Vertex_index>& get_coding_order() const;
+Description:
+    Returns the decompressed vertices in the order their coordinates are coded
 *******************************************************************************/
-void Decoder::get_history_code2(const std::string& binary_string, std::vector<Triangle_type>& hist_vec) {
-    // Initialize current op-code and previous op-code
-    Triangle_type opcode = I, prev_opcode = I;
-    // Declare three characters to store the input code
-    char input_ch, char_2nd, char_3rd;
-    
-    for (int i = 0; i < binary_string.length(); ++i) {
-        input_ch = binary_string[i];
-        char_2nd = binary_string[i+1];
-        char_3rd = binary_string[i+2];
-        
-        // C type follows another C type
-        if (input_ch == '0' && prev_opcode == C) { 
-            opcode = C; 
-        }
-        
-        // Current op-code follows a C code
-        else if (input_ch == '1' && prev_opcode == C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = S; 
-            }
-            else if (char_2nd == '1') { 
-                opcode = R; 
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Current op-code NOT follows a C code (R, L, S type)
-        else if (input_ch == '1' && prev_opcode != C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = R; 
-            }
-            else if (char_2nd == '1') {
-                // check the third character
-                if (char_3rd == '0') { 
-                    opcode = L; 
-                }
-                else if (char_3rd == '1') { 
-                    opcode = S; 
-                }
-                
-                // Update the string location count
-                i += 1;
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Current op-code NOT follows a C code (C, E type)
-        else if (input_ch == '0' && prev_opcode != C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = C; 
-            }
-            else if (char_2nd == '1') { 
-                opcode = E; 
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Add current op-code to the history vector
-        hist_vec.push_back(opcode);
-        
-        // Update the previous op-code
-        prev_opcode = opcode;
-    }
+const std::vector<Vertex_index>& Decoder::get_coding_order() const {
+    return coding_order;
 }
 
 
 /*******************************************************************************
-Function: static void get_history_code3(const std::string& binary_string, 
-                                        std::vector<Triangle_type>& hist_vec);
-@Description:
-    Generate the compression history vector from the input file, this function 
-    use code series 3 from D. King's 3.67V bit paper.
+Function: const Decoding_times& get_decoding_times() const;
+Description:
+    Returns the time spent in each stage of the decoder
 *******************************************************************************/
-void Decoder::get_history_code3(const std::string& binary_string, std::vector<Triangle_type>& hist_vec) {
-    // Initialize current op-code and previous op-code
-    Triangle_type opcode = I, prev_opcode = I;
-    // Declare three characters to store the input code
-    char input_ch, char_2nd, char_3rd;
-    
-    for (int i = 0; i < binary_string.length(); ++i) {
-        input_ch = binary_string[i];
-        char_2nd = binary_string[i+1];
-        char_3rd = binary_string[i+2];
-        
-        // C type follows another C type
-        if (input_ch == '0' && prev_opcode == C) { 
-            opcode = C; 
-        }
-        
-        // Current op-code follows a C code
-        else if (input_ch == '1' && prev_opcode == C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = S; 
-            }
-            else if (char_2nd == '1') { 
-                opcode = R; 
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Current op-code NOT follows a C code (L, E type)
-        else if (input_ch == '1' && prev_opcode != C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = L; 
-            }
-            else if (char_2nd == '1') { 
-                opcode = E; 
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Current op-code NOT follows a C code (C, S, R type)
-        else if (input_ch == '0' && prev_opcode != C) {
-            // check the second character
-            if (char_2nd == '0') { 
-                opcode = C; 
-            }
-            else if (char_2nd == '1') {
-                // check the third character
-                if (char_3rd == '0') { 
-                    opcode = S; 
-                }
-                else if (char_3rd == '1') { 
-                    opcode = R; 
-                }
-                
-                // Update the string location count
-                i += 1;
-            }
-            
-            // Update the string location count
-            i += 1;
-        }
-        
-        // Add current op-code to the history vector
-        hist_vec.push_back(opcode);
-        
-        // Update the previous op-code
-        prev_opcode = opcode;
-    }
+const Decoding_times& Decoder::get_decoding_times() const {
+    return times;
 }
 
 
+/*******************************************************************************
+Function: void set_output_format(Output_format format);
+Description:
+    Selects the file format of the decompressed triangle mesh
+*******************************************************************************/
+void Decoder::set_output_format(Output_format format) {
+    output_format = format;
+}
+
+
+//////////////////////////////////////////////////////////
+// private functions from Decoder class
+//////////////////////////////////////////////////////////
+
 /*******************************************************************************
 Function: distinguish_opcode()
 @Description:
@@ -593,12 +433,9 @@ bool Decoder::vertex_coordinate_decode(int bit_cnt, int coordinate, Quant_index&
     // Initialize coordinate
     coor = 0;
     
-    // Total context for each coordinate
-    int x_contexts = Context_selector::total_contexts(x_coor_bits, f_levels);
-    int y_contexts = Context_selector::total_contexts(y_coor_bits, f_levels);
-    
-    // Initialize the context 
-    Context_selector context(bit_cnt, f_levels); 
+    // The binarization tree of the coordinate
+    const Context_selector& context = coor_context[coordinate];
+    assert(bit_cnt == context.bits());
 
     // Initialize a string to store all bits in the digit
     std::string digits;
@@ -613,29 +450,22 @@ bool Decoder::vertex_coordinate_decode(int bit_cnt, int coordinate, Quant_index&
     }
     
     // Decode the value part using regular mode 
+    int state = context.root();
     for (int i = 0; i < bit_cnt; ++i) {
-        int context_id = context.get_context();            
-        int bit;
-        if(context_id == -1) {
-            bit = dec.decodeBypass();
-        }
-        else {
-            if (coordinate == 0) {
-                // Encode x coordinate
-                bit = dec.decodeRegular(context_id);
-            }
-            else if (coordinate == 1) {
-                // Encode x coordinate
-                int y_id = context_id + x_contexts;
-                bit = dec.decodeRegular(y_id);
-            }
-            else if (coordinate == 2) {
-                // Encode x coordinate
-                int z_id = context_id + x_contexts + y_contexts;
-                bit = dec.decodeRegular(z_id);
+        int context_id = context.get_context(state);
+        if (context_id == -1) {
+            // The remaining bits are all coded in bypass mode
+            long bits = dec.decodeBypassBits(bit_cnt - i);
+            if (bits < 0) {
+                std::cerr << "ERROR: Decode bypass failed\n";
+                return false;
             }
+            coor = (coor << (bit_cnt - i)) | bits;
+            break;
         }
         
+        int bit = dec.decodeRegular(context_id);
+        
         if (bit < 0) {
             std::cerr << "ERROR: Decode regular failed " << i << "\n";
             return false;
@@ -645,11 +475,7 @@ bool Decoder::vertex_coordinate_decode(int bit_cnt, int coordinate, Quant_index&
         coor = 2 * coor + bit;
         
         // Update context id for next bit
-        bool enc_bit = context.encode_bit(bit);
-        if (!enc_bit) {
-            std::cerr << "ERROR: Update context id failed\n";
-            return false;
-        }
+        state = context.next(state, bit);
     }
     
     // Update the coordinate
@@ -665,7 +491,8 @@ bool Decoder::vertex_coordinate_decode(int bit_cnt, int coordinate, Quant_index&
 /*******************************************************************************
 Function: bool read_ebfile()
 @Description:
-    Read the entire EB file from the given input stream
+    Read the EB file from the given input stream up to the geometry part, 
+    which is decoded by the residual stage
 *******************************************************************************/
 bool Decoder::read_ebfile() {
 
@@ -692,6 +519,16 @@ bool Decoder::read_ebfile() {
         return false;
     }
     
+    // The geometry coder type is stored above the code series
+    int coder_type = code_series >> code_series_bits;
+    code_series &= code_series_mask;
+    if (coder_type != static_cast<int>(Bin_coder_type::spl) && 
+        coder_type != static_cast<int>(Bin_coder_type::range)) {
+        std::cerr << "ERROR: Unknown geometry coder " << coder_type << "!\n";
+        return false;
+    }
+    dec.set_coder(static_cast<Bin_coder_type>(coder_type));
+    
     // hist_str_len
     if (ifile_eb.getBits(redundant_bits) < 0) {
         std::cerr << "cannot read bits 0\n";
@@ -748,6 +585,21 @@ bool Decoder::read_ebfile() {
     }
     z_coor_bits = ifile_eb.getBits(max_bits_to_put);
     
+    if (x_coor_bits < 1 || x_coor_bits > coor_max_bits || 
+        y_coor_bits < 1 || y_coor_bits > coor_max_bits || 
+        z_coor_bits < 1 || z_coor_bits > coor_max_bits) {
+        std::cerr << "ERROR: Invalid No. of coordinate bits!\n";
+        return false;
+    }
+    
+    // The binarization trees of the coordinates, the contexts of y and z 
+    // coordinates follow the contexts of the previous coordinate
+    int x_contexts = Context_selector::total_contexts(x_coor_bits, f_levels);
+    int y_contexts = Context_selector::total_contexts(y_coor_bits, f_levels);
+    coor_context[0] = Context_selector(x_coor_bits, f_levels, 0);
+    coor_context[1] = Context_selector(y_coor_bits, f_levels, x_contexts);
+    coor_context[2] = Context_selector(z_coor_bits, f_levels, x_contexts + y_contexts);
+    
     // step_size x coordinate
     if (ifile_eb.getBits(redundant_bits) < 0) {
         std::cerr << "cannot read bits 0\n";
@@ -855,36 +707,33 @@ bool Decoder::read_ebfile() {
     // Read the history part of the EB file
     //////////////////////////////////////////////////////////
     
-    // Generate the binary history string
-    std::string history_string;
-    for(auto i = 0; i < hist_str_len; ++i) {
-        int bit = ifile_eb.getBits(1);
-        if (bit < 0) {
+    // Read the packed binary history codewords, the whole bytes first, then 
+    // the bits left in the last byte
+    Vertex_index whole_bytes = hist_str_len / 8;
+    int last_bits = hist_str_len % 8;
+    std::vector<std::uint8_t> history_bytes(whole_bytes + (last_bits != 0));
+    if (ifile_eb.getBytes(history_bytes.data(), whole_bytes) < 0) {
+        std::cerr << "cannot read history bit\n";
+        return false;
+    }
+    
+    if (last_bits != 0) {
+        int bits = ifile_eb.getBits(last_bits);
+        if (bits < 0) {
             std::cerr << "cannot read history bit\n";
             return false;
         }
-        history_string += static_cast<char>(bit + '0');
+        history_bytes[whole_bytes] = bits << (8 - last_bits);
     }
     
     // Byte alignment for connectivity part
     ifile_eb.align();
 
     // Store the compression history into the history vector
-    switch(code_series) {
-        case 1:
-            // Compression history is stored in binary format using code1
-            get_history_code1(history_string, history_vec);
-            break;
-            
-        case 2:
-            // Compression history is stored in binary format using code2
-            get_history_code2(history_string, history_vec);
-            break;
-            
-        case 3:
-            // Compression history is stored in binary format using code3
-            get_history_code3(history_string, history_vec);
-            break;
+    if (code_series < 1 || code_series > 3 || 
+        !decode_history(history_bytes.data(), hist_str_len, code_series, history_vec)) {
+        std::cerr << "ERROR: Invalid op-code history!\n";
+        return false;
     }
     
     // Make sure op-code sequence vector is not empty
@@ -1018,6 +867,30 @@ bool Decoder::read_ebfile() {
     }
     
     
+    // Resize the vertices vector size to the vertices count and initialize
+    quant_vertices.resize(vertices_cnt);
+    predicted.assign(vertices_cnt, false);
+    coding_order.clear();
+    coding_order.reserve(vertices_cnt);
+    
+    // Connectivity data size in bits
+    conn_str_len = hist_str_len + 2 * hole_cnt * 32 + 3 * handle_cnt * 32 + 2 * offset_cnt * 32;
+    
+    return true;
+}
+
+
+/*******************************************************************************
+Function: bool residual_decoding()
+@Description:
+    Function for the residual stage. It decodes the prediction errors of all 
+    vertices from the geometry part of the EB file into the residuals ring 
+    buffer, in the order the vertices are coded. The ring buffer is closed 
+    when the stage finishes, so the reconstruction stage does not wait for 
+    the residuals of a broken geometry part.
+*******************************************************************************/
+bool Decoder::residual_decoding() {
+
     //////////////////////////////////////////////////////////
     // Read the geometry part of the EB file
     //////////////////////////////////////////////////////////
@@ -1029,32 +902,48 @@ bool Decoder::read_ebfile() {
     dec.setInput(&ifile_eb);
     
     // Starts the arithmetic decoder
-    dec.start();
+    if (dec.start() < 0) {
+        std::cerr << "ERROR: Cannot start the arithmetic decoder!\n";
+        residuals.close();
+        return false;
+    }
 
     Quant_index x = 0, y = 0, z = 0;
-    for (auto i = 0; i < vertices_cnt; ++i) {
+    bool decoded = true;
+    for (Vertex_index i = 0; i < quant_vertices.size(); ++i) {
         // Decode x coordinate
         bool coor_x = vertex_coordinate_decode(x_coor_bits, 0, x);
         if (!coor_x) {
             std::cerr << "ERROR: Decode x coordinate failed\n";
-            return false;
+            decoded = false;
+            break;
         }
         
         // Decode y coordinate
         bool coor_y = vertex_coordinate_decode(y_coor_bits, 1, y);
         if (!coor_y) {
             std::cerr << "ERROR: Decode y coordinate failed\n";
-            return false;
+            decoded = false;
+            break;
         }
         
         // Decode z coordinate
         bool coor_z = vertex_coordinate_decode(z_coor_bits, 2, z);
         if (!coor_z) {
             std::cerr << "ERROR: Decode z coordinate failed\n";
-            return false;
+            decoded = false;
+            break;
         }
         
-        points_vec.push_back(Point(x, y, z));
+        // The reconstruction stage closes the ring buffer if it stops early, 
+        // it reports the error
+        if (!residuals.push(Quant_point(x, y, z))) {
+            break;
+        }
+    }
+    residuals.close();
+    if (!decoded) {
+        return false;
     }
     
     // Terminate the arithmetic decoder
@@ -1063,15 +952,6 @@ bool Decoder::read_ebfile() {
         return false;
     }
     
-    // Make sure points vector size is equals to the vertices_cnt
-    assert(points_vec.size() == vertices_cnt);
-    
-    // Resize the vertices vector size to the vertices count and initialize
-    vertices_vec.resize(vertices_cnt);
-    for (auto vit = vertices_vec.begin(); vit != vertices_vec.end(); ++vit) {
-        (*vit).prediction = false;
-    }
-    
     // End bit count for the geometry part
     Vertex_index geom_end = ifile_eb.getReadCount();
     
@@ -1083,9 +963,6 @@ bool Decoder::read_ebfile() {
     // Geometry data size in bits
     geom_str_len = geom_end - geom_begin;
     
-    // Total compressed data size in bits
-    conn_str_len = hist_str_len + 2 * hole_cnt * 32 + 3 * handle_cnt * 32 + 2 * offset_cnt * 32;
-    
     // Output all the redundant bits
     while(!ifile_eb.isEof()) {
         ifile_eb.getBits(1);
@@ -1101,12 +978,174 @@ bool Decoder::read_ebfile() {
 }
 
 
+/*******************************************************************************
+Function: connectivity_generating()
+@Description:
+    Function for the connectivity stage. It runs the preprocessing and 
+    generation phases, and passes the prediction of each new vertex to the 
+    reconstruction stage, in the order the vertices are coded.
+*******************************************************************************/
+void Decoder::connectivity_generating() {
+    // Decompression preprocessing phase
+    initializing();
+    
+    // Reserve the nodes for the bounding loops, so the loop updates do not 
+    // allocate memory in most cases
+    node_pool.reserve(predicted.size() + 3);
+    for (int node = 0; node <= e_vertex; ++node) {
+        b_list.push_back(node);
+    }
+    
+    // The first vertex is coded as it is, the second vertex is predicted 
+    // from the first vertex
+    predictions.push(Triangle_prediction{no_vertex, no_vertex, no_vertex, e_vertex, true, false});
+    predicted[e_vertex] = true;
+    coding_order.push_back(e_vertex);
+    
+    predictions.push(Triangle_prediction{e_vertex, no_vertex, no_vertex, 0, true, false});
+    predicted[0] = true;
+    coding_order.push_back(0);
+    
+    // Decompression generation phase
+    table_generating();
+    
+    // No more triangles
+    predictions.close();
+}
+
+
+/*******************************************************************************
+Function: bool vertex_reconstructing(Mesh_sink& sink, bool& delivered)
+@Description:
+    Function for the reconstruction stage. It takes each triangle and the 
+    prediction of its new vertex from the ring buffer, and reconstructs the 
+    vertex from its prediction error with the parallelogram prediction 
+    scheme. The vertices (a, b, d) of a prediction are reconstructed before 
+    the vertex c, since they belong to the triangles processed before it. 
+    The new vertices are re-quantized in blocks, each axis of a block is 
+    re-quantized together. A block is passed to the sink when it is full, 
+    followed by the triangles which wait for its vertices.
+*******************************************************************************/
+bool Decoder::vertex_reconstructing(Mesh_sink& sink, bool& delivered) {
+    const double steps[3] = {step_size.x(), step_size.y(), step_size.z()};
+    const std::size_t block_size = 256;
+    
+    // The new vertices of the block in quantization indices and after the 
+    // re-quantization, and the triangles which wait for them
+    std::vector<Vertex_index> block_vertices;
+    std::vector<Quant_index> quant_coords[3];
+    std::vector<double> coords[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        quant_coords[axis].resize(block_size);
+        coords[axis].resize(block_size);
+    }
+    block_vertices.reserve(block_size);
+    std::vector<Triangle_facet> block_triangles;
+    block_triangles.reserve(2 * block_size);
+    bool first_triangle = true;
+    
+    // Passes the vertices and the triangles of the block to the sink
+    auto flush_block = [&]() {
+        std::size_t cnt = block_vertices.size();
+        for (int axis = 0; axis < 3; ++axis) {
+            dequantize_coordinates(quant_coords[axis].data(), cnt, steps[axis], 
+                                   coords[axis].data());
+        }
+        
+        bool accepted = true;
+        for (std::size_t i = 0; accepted && i < cnt; ++i) {
+            accepted = sink.add_vertex(block_vertices[i], 
+                                       Point(coords[0][i], coords[1][i], coords[2][i]));
+        }
+        for (auto it = block_triangles.begin(); accepted && it != block_triangles.end(); ++it) {
+            accepted = sink.add_triangle(*it);
+        }
+        
+        if (first_triangle && !block_triangles.empty()) {
+            times.first_triangle = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start_time).count();
+            first_triangle = false;
+        }
+        block_vertices.clear();
+        block_triangles.clear();
+        return accepted;
+    };
+    
+    Triangle_prediction tri;
+    Quant_point delta;
+    bool matched = true;
+    delivered = true;
+    while (delivered && predictions.pop(tri)) {
+        if (tri.new_vertex) {
+            matched = vertex_count < quant_vertices.size() && residuals.pop(delta);
+            if (!matched) {
+                break;
+            }
+            
+            // The first vertex is not predicted, the second vertex is 
+            // predicted by the first vertex
+            Quant_point predict;
+            if (tri.b == no_vertex) {
+                if (tri.a != no_vertex) {
+                    predict = quant_vertices[tri.a];
+                }
+            }
+            else {
+                Quant_point a = quant_vertices[tri.a];
+                Quant_point b = quant_vertices[tri.b];
+                if (tri.d == no_vertex) {
+                    // Geometry processing for the third vertex of the mesh
+                    predict = geometry_predict(&a, &b, nullptr);
+                }
+                else {
+                    Quant_point d = quant_vertices[tri.d];
+                    predict = geometry_predict(&a, &b, &d);
+                }
+            }
+            
+            // Point reconstruction
+            Quant_point c = delta + predict;
+            quant_vertices.set(tri.c, c);
+            ++vertex_count;
+            
+            for (int axis = 0; axis < 3; ++axis) {
+                quant_coords[axis][block_vertices.size()] = c[axis];
+            }
+            block_vertices.push_back(tri.c);
+        }
+        
+        if (tri.triangle) {
+            block_triangles.push_back(Triangle_facet(tri.a, tri.b, tri.c));
+        }
+        
+        if (block_vertices.size() == block_size || block_triangles.size() == 2 * block_size) {
+            delivered = flush_block();
+        }
+    }
+    
+    // Every vertex has one prediction and one prediction error. The ring 
+    // buffers are closed, so the other stages do not wait if they do not 
+    // match, or if the sink stops the decompression
+    matched = matched && vertex_count == quant_vertices.size();
+    predictions.close();
+    residuals.close();
+    if (!matched) {
+        return false;
+    }
+    
+    delivered = delivered && flush_block();
+    return true;
+}
+
+
 /*******************************************************************************
 Function: geometry_processing(Triangle_facet tri_label);
 Description:
-    Use Parallelogram Prediction scheme to reconstruct the vertex location
-    for the given point c. This function is used to process the all mesh's 
-    vertices except the start and end vertex of the initial active gate.
+    Passes the given triangle to the reconstruction stage, with the 
+    prediction of its third vertex if the vertex has not been predicted yet. 
+    The vertex is predicted from the given triangle and the vertex d of the 
+    previous processed triangle (a, b, d), which the first triangle of the 
+    mesh does not have.
     
 Parameters:
     Triangle_facet: The vertices indices of current triangle
@@ -1117,39 +1156,17 @@ void Decoder::geometry_processing(Triangle_facet tri_label) {
     Vertex_index index_b = tri_label.get_index(1);
     Vertex_index index_delta = tri_label.get_index(2);
     assert(index_a != index_b && index_a != index_delta && index_b != index_delta);
-    
-    // Get points a and b
-    Point a = vertices_vec[index_a].point;
-    Point b = vertices_vec[index_b].point;
-    assert(vertices_vec[index_a].prediction == true && vertices_vec[index_b].prediction == true);
+    assert(predicted[index_a] && predicted[index_b]);
 
-    // Initialize predicted point
-    Point predict;
-    if (triangle_cnt == 1) {
-        // Geometry processing for the third vertex of the mesh
-        // std::clog << "Geometry prediction without third vertex \n";
-        predict = geometry_predict(&a, &b, nullptr);
-    }
-    else {
-        Point d = vertices_vec[prev_vertex_d].point;
-        predict = geometry_predict(&a, &b, &d);
-    }
-    // std::clog << "Calculated position: " << predict << "\n";
-
-    // Geometry prediction for the third vertex of current triangle
-    if (vertices_vec[index_delta].prediction == false) {
-        Point delta = points_vec[++vertex_count];
-        
-        // Point reconstruction
-        Quant_index c_x = delta.x() + static_cast<Quant_index>(predict.x());
-        Quant_index c_y = delta.y() + static_cast<Quant_index>(predict.y());
-        Quant_index c_z = delta.z() + static_cast<Quant_index>(predict.z());
-        
-        // // Print the predicted position and its corresponding original point
-        // std::clog << "Input point: " << c_x << " " << c_y << " " << c_z << ", predicted position: " << delta << "\n";
-        
-        vertices_vec[index_delta].point = Point(c_x, c_y, c_z);
-        vertices_vec[index_delta].prediction = true;
+    // Geometry prediction for the third vertex of current triangle. If the 
+    // reconstruction stage has stopped, the ring buffer is closed and the 
+    // triangle is dropped
+    bool new_vertex = !predicted[index_delta];
+    Vertex_index index_d = (triangle_cnt == 1 || !new_vertex) ? no_vertex : prev_vertex_d;
+    predictions.push(Triangle_prediction{index_a, index_b, index_d, index_delta, new_vertex, true});
+    if (new_vertex) {
+        predicted[index_delta] = true;
+        coding_order.push_back(index_delta);
     }
 }
 
@@ -1260,7 +1277,10 @@ Function: table_generating()
 @Description:
     Function for the decompression generation phase. It creates the 
     Triangle-Vertices table from the compression history based on the 
-    information from the preprocessing phase
+    information from the preprocessing phase. The sub-loops created by S 
+    operations are processed iteratively, the left side sub-loops wait on 
+    list_stack until the right side sub-loop is finished. So the nesting depth 
+    of S operations is not limited by the call stack.
 *******************************************************************************/  
 void Decoder::table_generating(){    
     // Variable initialization
@@ -1269,6 +1289,7 @@ void Decoder::table_generating(){
     Triangle_facet tri_label(0, 0, 0); // Triangle_facet object for TV table
     Circ_list<Vertex_index>::Const_circulator gate = b_list.begin(); // The active gate
     Vertex_index updated_d = prev_vertex_d; // The updated point d used for next triangle
+    Vertex_index open_s = 0; // No. of S operations whose left side sub-loop is not resumed yet
     
     do {
         // Update the points for geometry reconstruction
@@ -1289,7 +1310,6 @@ void Decoder::table_generating(){
         
                 // TV table: (G.P, G, ++e)
                 tri_label = Triangle_facet(*gate_prev, *gate, ++e_vertex);
-                tv_table.push_back(tri_label);
                 
                 // Loop update: Insert ++e node between G.P and G
                 b_list.insert(gate, e_vertex);
@@ -1307,7 +1327,6 @@ void Decoder::table_generating(){
         
                 // TV table: (G.P, G, G.P.P)
                 tri_label = Triangle_facet(*gate_prev, *gate, *gate_prev_prev);
-                tv_table.push_back(tri_label);
               
                 // Loop update: Delete node G.P, connect G.P.P and G directly
                 b_list.erase(gate_prev);
@@ -1322,7 +1341,6 @@ void Decoder::table_generating(){
         
                 // TV table: (G.P, G, G.N)
                 tri_label = Triangle_facet(*gate_prev, *gate, *gate_next);
-                tv_table.push_back(tri_label);
 
                 // Loop update: Delete node G, connect G.P and G.N directly
                 b_list.erase(gate);
@@ -1343,7 +1361,6 @@ void Decoder::table_generating(){
         
                 // TV table: (G.P, G, G.N)
                 tri_label = Triangle_facet(*gate_prev, *gate, *gate_next);
-                tv_table.push_back(tri_label);
 
                 // Loop update: Pop node G
                 b_list.clear();
@@ -1361,7 +1378,6 @@ void Decoder::table_generating(){
         
                 // TV table: (G.P, G, ++e)
                 tri_label = Triangle_facet(*gate_prev, *gate, ++e_vertex);
-                tv_table.push_back(tri_label);
  
                 // Loop update: Insert (l + 1) nodes between G.P and G
                 for(int i = e_vertex; i < (e_vertex + m_table[m_cnt].second); ++i) {
@@ -1381,16 +1397,33 @@ void Decoder::table_generating(){
               
             case H:
             {
-                // Fetch the entry from stack
-                My_stack<std::pair<Circ_list<Vertex_index>, Vertex_index>>::Const_iterator gate_iter = std::next(list_stack.begin(), h_table[h_cnt].position());
-                Circ_list<Vertex_index> remove_list((*gate_iter).first);
+                // Fetch the entry from stack, the sub-loop is moved out of it
+                int position = h_table[h_cnt].position();
+                if (position < 0 || position >= list_stack.size()) {
+                    std::cerr << "ERROR: Invalid M' table!\n";
+                    exit(1);
+                }
+                Circ_list<Vertex_index> remove_list(std::move(list_stack.at(position).first));
                 
                 int remove_list_size = remove_list.size();
+                if (remove_list_size == 0) {
+                    std::cerr << "ERROR: Invalid M' table!\n";
+                    exit(1);
+                }
                 Circ_list<Vertex_index>::Const_circulator gate_d = remove_list.begin();
                 
-                // D = G.N, Repeat D=D.N for O[++s] times
-                for (int i = 1; i <= h_table[h_cnt].offset(); ++i) {
-                    ++gate_d;
+                // D = G.N, Repeat D=D.N for O[++s] times. The loop is 
+                // circular, so D is reached from the shorter side
+                int offset = h_table[h_cnt].offset() % remove_list_size;
+                if (offset <= remove_list_size / 2) {
+                    for (int i = 0; i < offset; ++i) {
+                        ++gate_d;
+                    }
+                }
+                else {
+                    for (int i = offset; i < remove_list_size; ++i) {
+                        --gate_d;
+                    }
                 }
                 
                 // Preparation for the insert node
@@ -1401,7 +1434,6 @@ void Decoder::table_generating(){
                 
                 //  TV table: (G.P, G, D)
                 tri_label = Triangle_facet(*gate_prev, *gate, *gate_d);
-                tv_table.push_back(tri_label);
                 
                 // Loop update: Insert node after G.P
                 b_list.insert(gate, *gate_d);
@@ -1413,7 +1445,7 @@ void Decoder::table_generating(){
                 
                 // Remove the entry from stack
                 remove_list.clear();
-                list_stack.erase(gate_iter);
+                list_stack.erase(position);
                 
                 // M' type count update
                 h_cnt += 1;
@@ -1439,7 +1471,6 @@ void Decoder::table_generating(){
                 
                 //  TV table: (G.P, G, D)
                 tri_label = Triangle_facet(*gate_prev, *gate, *gate_next);
-                tv_table.push_back(tri_label);
                 
                 // Geometry reconstruction for the S type triangle
                 triangle_cnt += 1;
@@ -1462,36 +1493,38 @@ void Decoder::table_generating(){
                 std::pair<Circ_list<Vertex_index>, Vertex_index> list_pair(std::move(sub_list_2), d_left);
                 list_stack.push(std::move(list_pair));
                 
-                // Generate the Triangle-Vertices table for the right side sub-loop      
-                table_generating();
-
-                // Update the triangle count for the left side sub-loop
-                triangle_cnt -= 1;
-                
-                // Compress the left side of sub mesh
-                if (!list_stack.empty()) {
-                    b_list = std::move(list_stack.top().first);
-                    updated_d = list_stack.top().second;
-                    list_stack.pop();
-                    
-                    // Gate update: gate = D
-                    gate = b_list.begin();
-                }
-                else {
-                    e_case = true;
-                }
-                
+                // Generate the Triangle-Vertices table for the right side sub-loop 
+                // first, the left side sub-loop is resumed once it is finished
+                gate = b_list.begin();
+                updated_d = prev_vertex_d;
+                ++open_s;
                 break; 
             }
         }
         
-        // Update the triangle count 
-        triangle_cnt += 1;
-        
         // Geometry prediction for the third vertex of current triangle
         if (opcode != S) {
+            // Update the triangle count 
+            triangle_cnt += 1;
+            
             geometry_processing(tri_label);
         }
+        
+        // Resume the left side sub-loop of the last S operation when the 
+        // current sub-loop is finished
+        while (e_case && open_s > 0) {
+            --open_s;
+            
+            if (!list_stack.empty()) {
+                b_list = std::move(list_stack.top().first);
+                updated_d = list_stack.top().second;
+                list_stack.pop();
+                
+                // Gate update: gate = D
+                gate = b_list.begin();
+                e_case = false;
+            }
+        }
 
     } while(!e_case);
 }
@@ -1500,29 +1533,189 @@ void Decoder::table_generating(){
 /*******************************************************************************
 Function: write_output()
 @Description:
-    Output the decompressed triangle mesh in OFF format to the standard output
+    Output the decompressed triangle mesh in the selected format to the output 
+    file descriptor
 *******************************************************************************/ 
 bool Decoder::write_output() {
-    std::cout << "OFF\n"
-              << points_vec.size() << " " << history_vec.size() << " 0\n";
+    return write_mesh(ofile_fd, output_format, vertices_vec, tv_table);
+}
+
+
+//////////////////////////////////////////////////////////
+// Output functions
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: write_binary_mesh(int fd, std::uint32_t real_size, 
+                            const std::vector<Point>& vertices, 
+                            const std::vector<Triangle_facet>& triangles)
+@Description:
+    Output the triangle mesh in the binary mesh layout to the output file 
+    descriptor
+*******************************************************************************/ 
+static bool write_binary_mesh(int fd, std::uint32_t real_size, const std::vector<Point>& vertices, 
+                              const std::vector<Triangle_facet>& triangles) {
+    Binary_mesh_writer writer(fd, real_size);
+    if (!writer.write_header(vertices.size(), triangles.size())) {
+        std::cerr << "ERROR: Too many vertices for the binary mesh layout!\n";
+        return false;
+    }
+
+    // Vertex array
+    for (auto iter = vertices.begin(); iter != vertices.end(); ++iter) {
+        writer.write_vertex(*iter);
+    }
+    
+    // Index array
+    for (auto iter = triangles.begin(); iter != triangles.end(); ++iter) {
+        writer.write_face(*iter);
+    }
+    
+    return writer.flush();
+}
+
+
+/*******************************************************************************
+Function: write_mesh(int fd, Output_format format, 
+                     const std::vector<Point>& vertices, 
+                     const std::vector<Triangle_facet>& triangles)
+@Description:
+    Output the triangle mesh in the given format to the output file 
+    descriptor. In OFF format, the vertex coordinates are written in the 
+    shortest form that parses back to the same double.
+*******************************************************************************/ 
+bool write_mesh(int fd, Output_format format, const std::vector<Point>& vertices, 
+                const std::vector<Triangle_facet>& triangles) {
+    if (format == Output_format::binary_float) {
+        return write_binary_mesh(fd, sizeof(float), vertices, triangles);
+    }
+    else if (format == Output_format::binary_double) {
+        return write_binary_mesh(fd, sizeof(double), vertices, triangles);
+    }
+    
+    Off_writer writer(fd);
+    writer.write_header(vertices.size(), triangles.size());
 
     // Geometry information of the OFF file
-    std::cout.precision(std::numeric_limits<double>::max_digits10);
-    for (auto iter = vertices_vec.begin(); iter != vertices_vec.end(); ++iter) {
-        std::cout << (*iter).point << "\n";
+    for (auto iter = vertices.begin(); iter != vertices.end(); ++iter) {
+        writer.write_vertex(*iter);
     }
     
     // Connectivity information of the OFF file
-    for (auto iter = tv_table.begin(); iter != tv_table.end(); ++iter) {
-        std::cout << "3 " << *iter << "\n";
+    for (auto iter = triangles.begin(); iter != triangles.end(); ++iter) {
+        writer.write_face(*iter);
     }
-    std::cout << "\n\n";
+    writer.write_string("\n\n");
     
-    std::cout.flush();
-    if(!std::cout) {
+    return writer.flush();
+}
+
+
+//////////////////////////////////////////////////////////
+// Public functions from Mesh_file_sink class
+//////////////////////////////////////////////////////////
+
+/*******************************************************************************
+Function: Mesh_file_sink(int fd, Output_format format);
+Description:
+    Mesh_file_sink class constructors
+*******************************************************************************/
+Mesh_file_sink::Mesh_file_sink(int fd, Output_format format)
+  : fd(fd), format(format), faces_cnt(0), header_pos(-1) {
+}
+
+
+/*******************************************************************************
+Function: bool begin(std::size_t vertices_cnt, std::size_t triangles_cnt);
+Description:
+    Allocates the vertices. In the binary mesh layout, if the file descriptor 
+    can seek and does not append, the faces are written from their position 
+    after the vertex array, which is written at the end.
+*******************************************************************************/
+bool Mesh_file_sink::begin(std::size_t vertices_cnt, std::size_t triangles_cnt) {
+    vertices.resize(vertices_cnt);
+    faces_cnt = triangles_cnt;
+    if (format == Output_format::off) {
+        triangles.reserve(triangles_cnt);
+        return true;
+    }
+    
+    if (vertices_cnt > std::numeric_limits<std::uint32_t>::max()) {
+        std::cerr << "ERROR: Too many vertices for the binary mesh layout!\n";
         return false;
     }
     
+    std::uint32_t real_size = (format == Output_format::binary_float) ? sizeof(float) : 
+                                                                      sizeof(double);
+    int flags = fcntl(fd, F_GETFL);
+    header_pos = lseek(fd, 0, SEEK_CUR);
+    off_t faces_pos = header_pos + sizeof(Binary_mesh_header) + 
+                      static_cast<off_t>(vertices_cnt) * 3 * real_size;
+    if (flags < 0 || (flags & O_APPEND) != 0 || header_pos < 0 || 
+        lseek(fd, faces_pos, SEEK_SET) < 0) {
+        header_pos = -1;
+        triangles.reserve(triangles_cnt);
+        return true;
+    }
+    
+    face_writer.reset(new Binary_mesh_writer(fd, real_size));
     return true;
 }
 
+
+/*******************************************************************************
+Function: bool add_vertex(Vertex_index index, const Point& p);
+Description:
+    Keeps a vertex until the end
+*******************************************************************************/
+bool Mesh_file_sink::add_vertex(Vertex_index index, const Point& p) {
+    vertices[index] = p;
+    return true;
+}
+
+
+/*******************************************************************************
+Function: bool add_triangle(const Triangle_facet& tri_label);
+Description:
+    Writes a face, or keeps it until the end
+*******************************************************************************/
+bool Mesh_file_sink::add_triangle(const Triangle_facet& tri_label) {
+    if (face_writer) {
+        face_writer->write_face(tri_label);
+    }
+    else {
+        triangles.push_back(tri_label);
+    }
+    return true;
+}
+
+
+/*******************************************************************************
+Function: bool end();
+Description:
+    Writes the vertices, and the faces which are kept. In the binary mesh 
+    layout the header and the vertex array are written in front of the 
+    faces, and the file position is left after the faces.
+*******************************************************************************/
+bool Mesh_file_sink::end() {
+    if (!face_writer) {
+        return write_mesh(fd, format, vertices, triangles);
+    }
+    
+    if (!face_writer->flush()) {
+        return false;
+    }
+    off_t end_pos = lseek(fd, 0, SEEK_CUR);
+    if (end_pos < 0 || lseek(fd, header_pos, SEEK_SET) < 0) {
+        return false;
+    }
+    
+    Binary_mesh_writer writer(fd, (format == Output_format::binary_float) ? sizeof(float) : 
+                                                                            sizeof(double));
+    writer.write_header(vertices.size(), faces_cnt);
+    for (auto iter = vertices.begin(); iter != vertices.end(); ++iter) {
+        writer.write_vertex(*iter);
+    }
+    
+    return writer.flush() && lseek(fd, end_pos, SEEK_SET) >= 0;
+}
@@ -8,9 +8,16 @@
 
 #include "Utility.hpp"
 #include "Circ_list.hpp"
+#include "Quantization.hpp"
 #include "My_stack.hpp"
 #include "Context_selector.hpp"
+#include "History_codec.hpp"
+#include "Off_writer.hpp"
+#include "Binary_mesh_writer.hpp"
+#include "Ring_buffer.hpp"
+#include "Mesh_sink.hpp"
 #include <iostream>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -18,24 +25,155 @@
 #include <algorithm>
 #include <iterator>
 #include <list>
+#include <memory>
 #include <stack>
 #include <queue>
 #include <unistd.h>
 
 
 /*******************************************************************************
-Structure: Mesh_vertex
+Enum: Output_format
 Description:
-    This structure represents each reconstructed mesh's vertex. Two members are 
-    included in this Mesh_vertex structure. One is the vertex coordinates, the 
-    other is a flag shows whether the current vertex has been predicted or not.
+    The file format of the decompressed triangle mesh. 
+    off: OFF text file.
+    binary_float: Binary mesh layout with float32 vertex coordinates.
+    binary_double: Binary mesh layout with float64 vertex coordinates.
+    The binary mesh layout is described in Binary_mesh_writer.hpp.
 *******************************************************************************/
-struct Mesh_vertex {
-    // The vertex coordinates 
-    Point point;
+enum class Output_format {
+    off,
+    binary_float,
+    binary_double
+};
+
+
+/*******************************************************************************
+Function: write_mesh()
+Description:
+    The function writes a triangle mesh in the given file format to the output 
+    file descriptor.
+
+Parameters:
+    fd: The output file descriptor
+    format: The output file format
+    vertices: The vertices of the mesh
+    triangles: The triangles of the mesh
+
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool write_mesh(int fd, Output_format format, const std::vector<Point>& vertices, 
+                const std::vector<Triangle_facet>& triangles);
+
+
+/*******************************************************************************
+Class: Mesh_file_sink
+Description:
+    A Mesh_sink which writes the triangle mesh in the given file format to a 
+    file descriptor. The vertices are kept until the end, since the file 
+    lists them in the order of their indices before the faces. In the binary 
+    mesh layout, the position of the faces is known from No. of vertices, so 
+    if the file descriptor can seek, each face is written as soon as it is 
+    received. Otherwise (and in OFF format), the faces are also kept until 
+    the end.
+    
+Preconditions:
+    The file descriptor must be opened for writing. The file descriptor is not 
+    closed by the Mesh_file_sink object.
+*******************************************************************************/
+class Mesh_file_sink : public Mesh_sink {
+public:
+    // A constructor create a Mesh_file_sink object with given parameters
+    // Parameters: 
+    //      fd: The output file descriptor
+    //      format: The output file format
+    Mesh_file_sink(int fd, Output_format format);
+    
+    bool begin(std::size_t vertices_cnt, std::size_t triangles_cnt) override;
+    bool add_vertex(Vertex_index index, const Point& p) override;
+    bool add_triangle(const Triangle_facet& tri_label) override;
+    bool end() override;
+    
+private:
+    // The output file descriptor
+    int fd;
     
-    // A flag shows whether the vertex has been predicted or not
-    bool prediction;
+    // The output file format
+    Output_format format;
+    
+    // The vertices, and the faces which are not written yet
+    std::vector<Point> vertices;
+    std::vector<Triangle_facet> triangles;
+    
+    // No. of faces in the mesh
+    std::size_t faces_cnt;
+    
+    // The file position of the binary mesh header
+    off_t header_pos;
+    
+    // The writer of the faces in the binary mesh layout, null if the faces 
+    // are kept until the end
+    std::unique_ptr<Binary_mesh_writer> face_writer;
+};
+
+
+/*******************************************************************************
+Structure: Triangle_prediction
+Description:
+    A triangle (a, b, c) generated by the connectivity stage, with the 
+    prediction of its vertex c if the vertex is new. The vertex c is 
+    predicted from the triangle (a, b, d) processed before it. The first two 
+    vertices are passed without a triangle: the first vertex is not 
+    predicted, and the second vertex is predicted from the first vertex only.
+*******************************************************************************/
+struct Triangle_prediction {
+    // The vertices a, b and d, no_vertex if they are not used
+    Vertex_index a;
+    Vertex_index b;
+    Vertex_index d;
+    
+    // The vertex c
+    Vertex_index c;
+    
+    // True if the vertex c is reconstructed from this prediction, false if 
+    // it has been reconstructed before
+    bool new_vertex;
+    
+    // True if (a, b, c) is a triangle of the mesh
+    bool triangle;
+};
+
+// The vertex index which marks an unused vertex of Triangle_prediction
+const Vertex_index no_vertex = std::numeric_limits<Vertex_index>::max();
+
+
+/*******************************************************************************
+Structure: Decoding_times
+Description:
+    The time (in seconds) spent in each stage of the decoder. The residual, 
+    connectivity and reconstruction stages run at the same time, the time 
+    of a stage is the processor time of its thread, so it does not include 
+    the time it waits for the other stages.
+*******************************************************************************/
+struct Decoding_times {
+    // Reading the header, the op-code history and the tables
+    double tables = 0;
+    
+    // Decoding the prediction errors from the geometry part
+    double residuals = 0;
+    
+    // Generating the triangles and the vertex predictions
+    double connectivity = 0;
+    
+    // Reconstructing and re-quantizing the vertex coordinates
+    double reconstruction = 0;
+    
+    // The elapsed time of the three stages
+    double pipeline = 0;
+    
+    // The elapsed time from the start of the decompression until the first 
+    // triangle is passed to the Mesh_sink
+    double first_triangle = 0;
 };
 
 
@@ -47,6 +185,14 @@ Description:
     scheme to decompress the triangle mesh, writes the decompressed triangle
     mesh in OFF format to the standard output stream.
     
+    The decompression is a pipeline of three threads. The first thread 
+    decodes the prediction errors from the geometry part into a ring buffer. 
+    The second thread generates the triangles from the op-code history, and 
+    passes each triangle with the vertices its new vertex is predicted from 
+    through another ring buffer. The third thread reconstructs the vertex 
+    coordinates from both of them, and passes the vertices and the triangles 
+    to a Mesh_sink as soon as they are final.
+    
 Preconditions:
     The input compressed triangle mesh must stored in EB file format
 *******************************************************************************/
@@ -55,7 +201,8 @@ public:
     // A constructor create a Decoder object with given parameter
     // Parameters: 
     //      ifile: EB file input stream
-    Decoder(std::istream& ifile);
+    //      ofd: File descriptor to write the decompressed OFF file
+    Decoder(std::istream& ifile, int ofd = STDOUT_FILENO);
     
     // Destructor
     ~Decoder();
@@ -65,6 +212,37 @@ public:
     // triangle mesh will be output to the standard output stream in OFF file format
     void mesh_decompression();
     
+    // 3D Triangle mesh decoding function. The function decompresses the 
+    // triangle mesh like mesh_decompression(), but the decompressed triangle 
+    // mesh is kept by the decoder instead of being written
+    void mesh_decoding();
+    
+    // 3D Triangle mesh streaming decompression function. The function 
+    // decompresses the triangle mesh, and passes the vertices and the 
+    // triangles to the sink while they are decoded. The decompressed mesh is 
+    // not kept by the decoder, so get_vertices(), get_triangles() and the 
+    // No. of edges and boundaries from compression_result() are not available
+    // Parameters: 
+    //      sink: The receiver of the decompressed triangle mesh
+    // Returns:
+    //      If the sink stops the decompression or fails, false is returned; 
+    //      otherwise, true is returned
+    bool decode(Mesh_sink& sink);
+    
+    // Returns the decompressed vertices, in the order of their indices
+    const std::vector<Point>& get_vertices() const;
+    
+    // Returns the decompressed triangles
+    const std::vector<Triangle_facet>& get_triangles() const;
+    
+    // Returns the index of each decompressed vertex in the order its 
+    // coordinates are coded, which is the same order as 
+    // Encoder::get_coding_order()
+    const std::vector<Vertex_index>& get_coding_order() const;
+    
+    // Returns the time spent in each stage of the last decompression
+    const Decoding_times& get_decoding_times() const;
+    
     // Generates the results information. The information generates are: number 
     // of vertices/faces/edges/boundaries in the mesh, the mesh's genus, the 
     // No. of total bytes of coded data, the No. of bytes of coded geometry data,
@@ -78,46 +256,19 @@ public:
     //      The quantization step size used in the calculation
     Point get_quan_step_size();
     
+    // Selects the file format of the decompressed triangle mesh. The OFF 
+    // format is used by default
+    // Parameters: 
+    //      format: The output file format
+    void set_output_format(Output_format format);
+    
     
 private:
-    // Op-code sequence vector generation function. The codeword from code 
-    // series 1 of King's 3.67V bit paper is used
-    // Parameters: 
-    //      binary_string: Binary op-code string use the codeword from code series 1
-    //      hist_vec: The op-code sequence vector, stores all the detected 
-    //                triangle type.
-    void get_history_code1(const std::string& binary_string, 
-                                  std::vector<Triangle_type>& hist_vec);
-    
-    // Op-code sequence vector generation function. The codeword from code 
-    // series 2 of King's 3.67V bit paper is used
-    // Parameters: 
-    //      binary_string: Binary op-code string use the codeword from code series 2
-    //      hist_vec: The op-code sequence vector, stores all the detected 
-    //                triangle type.
-    void get_history_code2(const std::string& binary_string, 
-                                  std::vector<Triangle_type>& hist_vec);
-    
-    // Op-code sequence vector generation function. The codeword from code 
-    // series 3 of King's 3.67V bit paper is used
-    // Parameters: 
-    //      binary_string: Binary op-code string use the codeword from code series 3
-    //      hist_vec: The op-code sequence vector, stores all the detected 
-    //                triangle type. 
-    void get_history_code3(const std::string& binary_string, 
-                                  std::vector<Triangle_type>& hist_vec);
-                                  
     // Operation distinguish function. This function distinguishes among the 
     // S, M and M' type of operations. This function is called if and only if 
     // the compressed triangle mesh contains handle or hole
     void distinguish_opcode();
     
-    // Arithmetic decoding function for geometry processing. This function uses 
-    // the arithmetic decode functions from the SPL library to decodes the 
-    // prediction errors for each vertex's 3 coordinates
-    // Returns:
-    //      The decoded vertex coordinate
-    
     // Arithmetic decode function. It uses the arithmetic coding scheme to decode 
     // the integer prediction error of each vertex. The arithmetic decode function 
     // from the SPL library is called inside the function
@@ -129,15 +280,39 @@ private:
     //      The integer prediction error of current vertex's given coordinate
     bool vertex_coordinate_decode(int bit_cnt, int coordinate, Quant_index& coor);
     
-    // EB file reading function. This function reads the entire EB file from the 
-    // given input stream, generates the op-code sequence vector, generates M 
-    // table and M' table
+    // EB file reading function. This function reads the EB file from the 
+    // given input stream up to the geometry part, generates the op-code 
+    // sequence vector, generates M table and M' table
     // Preconditions:
     //      The compressed triangle mesh must stored in EB file format
     bool read_ebfile();
     
-    // Geometry processing related function. It reconstructs the third vertex of 
-    // the current input triangle.
+    // Residual decoding stage function. This function decodes the prediction 
+    // errors of all vertices from the geometry part, and pushes them to the 
+    // residuals ring buffer
+    // Returns:
+    //      Upon success, true is returned; otherwise, false is returned
+    bool residual_decoding();
+    
+    // Connectivity stage function. This function generates the 
+    // triangle-vertices table, and pushes the prediction of each new vertex 
+    // to the predictions ring buffer
+    void connectivity_generating();
+    
+    // Reconstruction stage function. This function reconstructs the vertices 
+    // from the predictions and residuals ring buffers, re-quantizes them and 
+    // passes them to the sink with the triangles
+    // Parameters: 
+    //      sink: The receiver of the decompressed triangle mesh
+    //      delivered: Set if the sink receives the whole mesh (output)
+    // Returns:
+    //      If the No. of predictions and residuals does not match the No. of 
+    //      vertices, false is returned; otherwise, true is returned
+    bool vertex_reconstructing(Mesh_sink& sink, bool& delivered);
+    
+    // Geometry processing related function. It passes the current input 
+    // triangle to the reconstruction stage, with the prediction of its third 
+    // vertex if the vertex is new.
     // Parameters: 
     //      tri_label: A Triangle_facet object which contains the given 
     //                 triangle's three vertices label/index
@@ -153,19 +328,35 @@ private:
     // preprocessing phase
     void table_generating();
     
-    // OFF file written function. This function writes the decompressed triangle 
-    // mesh in OFF format to the standard output
+    // Output file written function. This function writes the decompressed 
+    // triangle mesh in the selected format to the output file descriptor
     bool write_output();
     
     
     // The op-code sequence vector, stores all the detected triangle type
     std::vector<Triangle_type> history_vec;
     
-    // The points list vector, stores the prediction error for each vertex
-    std::vector<Point> points_vec;
+    // The prediction errors, from the residual stage to the reconstruction 
+    // stage
+    Ring_buffer<Quant_point> residuals;
+    
+    // The triangles and the vertex predictions, from the connectivity stage 
+    // to the reconstruction stage
+    Ring_buffer<Triangle_prediction> predictions;
     
-    // The reconstructed vertices vector, stores all the reconstructed vertices
-    std::vector<Mesh_vertex> vertices_vec;
+    // The reconstructed vertices in quantization indices
+    Quant_point_array quant_vertices;
+    
+    // The flags show whether each vertex has been predicted or not, used by 
+    // the connectivity stage
+    std::vector<bool> predicted;
+    
+    // The vertices in the order their coordinates are decoded
+    std::vector<Vertex_index> coding_order;
+    
+    // The reconstructed vertices vector, stores all the reconstructed vertices 
+    // after the re-quantization, only kept by mesh_decoding()
+    std::vector<Point> vertices_vec;
     
     // The M table uses to store the information of each hole
     // Explain for std::pair type:
@@ -182,10 +373,13 @@ private:
     // The previous reconstructed vertex index from triangle (a, b, d) 
     Vertex_index prev_vertex_d;
     
+    // The node pool shared by the bounding loop and the sub-loops on the stack
+    Circ_pool<Vertex_index> node_pool;
+    
     // A circular doubly linked list contains all boundary vertices' index
     Circ_list<Vertex_index> b_list;
     
-    // Triangle-vertices incident table
+    // Triangle-vertices incident table, only kept by mesh_decoding()
     std::vector<Triangle_facet> tv_table;
     
     // S operation offset table
@@ -209,6 +403,12 @@ private:
     // Input stream to read the EB file
     SPL::InputBitStream ifile_eb;
     
+    // File descriptor to write the decompressed OFF file
+    int ofile_fd;
+    
+    // The file format of the decompressed triangle mesh
+    Output_format output_format;
+    
     // External vertices count
     Vertex_index e_vertex;
     
@@ -236,6 +436,12 @@ private:
     // Length of geometry part
     Vertex_index geom_str_len;
     
+    // The time spent in each stage
+    Decoding_times times;
+    
+    // The start time of the decompression
+    std::chrono::steady_clock::time_point start_time;
+    
     
     // No. of bits used to encode x coordinate
     int x_coor_bits;
@@ -246,6 +452,9 @@ private:
     // No. of bits used to encode z coordinate
     int z_coor_bits;
     
+    // The binarization trees of x, y and z coordinates
+    Context_selector coor_context[3];
+    
     // An arithmetic decoder object to decodes the geometry prediction errors
     MyArithDecoder dec;
 };
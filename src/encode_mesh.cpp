@@ -1,12 +1,19 @@
 #include "encoder.hpp"
+#include "Off_reader.hpp"
+#include "Duplicate_vertices.hpp"
+#include "Mesh_partition.hpp"
+#include "Component_container.hpp"
 #include <fstream>
+#include <sstream>
+#include <atomic>
+#include <numeric>
 #include <chrono>
 #include <cmath>
 #include <CGAL/Bbox_3.h>
 #include <SPL/Timer.hpp>
 
 
-// Some basic types to be used with CGAL Polyhedron_3 class
+// Some basic types to be used with CGAL Bbox_3 class
 typedef CGAL::Bbox_3 Bbox_3;
 
 
@@ -34,6 +41,23 @@ void usage() {
               << "-s $scaling: Scaling factor used to scaling each vertex's coordinates.\n"
               << "             If not specified, default to 1 (no scaling).\n"
               << "-c:          Calculate the coding efficiency for the compressed EB file. \n"
+              << "-i $input:   Read the input triangle mesh from the file called $input. \n"
+              << "             If not specified, the mesh is read from the standard input.\n"
+              << "-w:          Calculate the offset of each S operation by walking around its \n"
+              << "             sub-loop (slower). If not specified, the offsets are derived \n"
+              << "             from the op-code counts. Both methods give the same EB file.\n"
+              << "-g $coder:   The binary arithmetic coder of the vertex coordinates, spl or \n"
+              << "             range (faster, no divisions). If not specified, default to spl.\n"
+              << "-v $version: The EB file version, 1 or 2. Version 2 is a container with a \n"
+              << "             chunk directory, which can be decoded one chunk at a time. A \n"
+              << "             mesh with several connected components is always stored in \n"
+              << "             version 2, each component in its own chunk. If not specified, \n"
+              << "             default to 1.\n"
+              << "-k $slabs:   Cut the mesh into patches along $slabs slabs across the longest \n"
+              << "             side of its bounding box, and compress the patches in parallel. \n"
+              << "             The vertices on the cuts are welded by the decoder. The mesh is \n"
+              << "             always stored in version 2. If not specified, default to 1 \n"
+              << "             (no cuts).\n"
               << "\n"
               << "The input triangle mesh is stored in OFF format.\n"
               << "The output compressed triangle mesh is stored in EB format.\n"
@@ -42,32 +66,27 @@ void usage() {
 
 
 /*******************************************************************************
-Function: bounding_box(Polyhedron poly_mesh)
+Function: bounding_box(const std::vector<Point>& points)
 Description:
     Calculate the bounding box of the input triangle mesh
     
 Parameter:
-    poly_mesh: The input triangle mesh
+    points: The vertices of the input triangle mesh
     
 Return:
     A vector which contains the bounding box information of the input mesh. The
     sequence of bounding box info: xmin -> xmax -> ymin -> ymax -> zmin -> zmax
 *******************************************************************************/
-#ifdef BUG
-Bbox_3 bounding_box(Polyhedron poly_mesh) {
-#else
-Bbox_3 bounding_box(const Polyhedron& poly_mesh) {
-#endif
-    
+Bbox_3 bounding_box(const std::vector<Point>& points) {
     // Initialize the bounding box object
     Bbox_3 bbox;
     
     // Compute the bounding box of the mesh.
-    Point v_begin = poly_mesh.vertices_begin() -> point();
+    Point v_begin = points.front();
     bbox = Bbox_3(v_begin.x(), v_begin.y(), v_begin.z(), v_begin.x(), v_begin.y(), v_begin.z());
     
-    for (auto vit = poly_mesh.vertices_begin(); vit != poly_mesh.vertices_end(); ++vit) {
-        Point p = vit -> point();
+    for (auto vit = points.begin(); vit != points.end(); ++vit) {
+        const Point& p = *vit;
         bbox = bbox + Bbox_3(p.x(), p.y(), p.z(), p.x(), p.y(), p.z());
     }
     
@@ -75,6 +94,167 @@ Bbox_3 bounding_box(const Polyhedron& poly_mesh) {
 }
 
 
+/*******************************************************************************
+Function: erase_vertices(std::vector<Point>& points, 
+                         std::vector<Corner_index>& vertex_table, 
+                         const std::vector<char>& erased)
+Description:
+    Erase the given vertices and all of the triangles connected to them. The 
+    vertices that are left without any triangle are erased as well. The 
+    remaining vertices and triangles keep their order.
+    
+Parameter:
+    points: The vertices of the input triangle mesh
+    vertex_table: Three vertex indices for each triangle
+    erased: A flag for each vertex, set if the vertex is to be erased
+*******************************************************************************/
+void erase_vertices(std::vector<Point>& points, std::vector<Corner_index>& vertex_table, 
+                    const std::vector<char>& erased) {
+    // No. of triangles connected to each vertex before and after the erasing
+    std::vector<int> old_degree(points.size(), 0);
+    std::vector<int> new_degree(points.size(), 0);
+    
+    // Erase the triangles that connected to the erased vertices
+    std::size_t kept = 0;
+    for (std::size_t t = 0; t < vertex_table.size(); t += 3) {
+        Corner_index a = vertex_table[t], b = vertex_table[t + 1], c = vertex_table[t + 2];
+        ++old_degree[a];
+        ++old_degree[b];
+        ++old_degree[c];
+        
+        if (erased[a] || erased[b] || erased[c]) {
+            continue;
+        }
+        
+        ++new_degree[a];
+        ++new_degree[b];
+        ++new_degree[c];
+        vertex_table[kept++] = a;
+        vertex_table[kept++] = b;
+        vertex_table[kept++] = c;
+    }
+    vertex_table.resize(kept);
+    
+    // Erase the vertices and renumber the remaining ones
+    std::vector<Corner_index> new_index(points.size(), null_corner);
+    std::size_t vertices_cnt = 0;
+    for (std::size_t v = 0; v < points.size(); ++v) {
+        if (erased[v] || (old_degree[v] != 0 && new_degree[v] == 0)) {
+            continue;
+        }
+        
+        new_index[v] = vertices_cnt;
+        points[vertices_cnt++] = points[v];
+    }
+    points.resize(vertices_cnt);
+    
+    for (auto it = vertex_table.begin(); it != vertex_table.end(); ++it) {
+        *it = new_index[*it];
+    }
+}
+
+
+/*******************************************************************************
+Function: encode_components(std::vector<Mesh_component>& components, 
+                            const Point& quan_size, const int coor_bits[3], 
+                            S_offset_mode offset_mode, 
+                            Bin_coder_type geometry_coder, 
+                            std::vector<Component_entry>& entries, 
+                            std::vector<std::string>& streams, 
+                            std::vector<std::vector<Weld_entry>>& welds, 
+                            std::vector<std::vector<Vertex_index>>& results, 
+                            Point& step_size)
+Description:
+    Compress each connected component (or patch) into its own EB stream. The components 
+    are taken by a pool of threads, the largest components first. Every 
+    component has its own Encoder, so the op-code history and the arithmetic 
+    coder states are independent. All of the components use the same 
+    quantization step size and No. of bits of each coordinate. The vertices 
+    and triangles of the components are released when they are compressed. 
+    The seam vertices of each component are listed in its weld map in the 
+    order their coordinates are coded.
+    
+Parameter:
+    components: The connected components
+    quan_size: Quantization step size
+    coor_bits: No. of bits used to encode x, y and z coordinates
+    offset_mode: The S offset calculation method
+    geometry_coder: The binary arithmetic coder of the vertex coordinates
+    entries: The container directory entry of each component, the section 
+             offsets are set
+    streams: The EB stream of each component (output)
+    welds: The weld map of each component (output)
+    results: The compression results of each component (output)
+    step_size: The quantization step size used by the encoders (output)
+    
+Return:
+    Upon success, true is returned; otherwise, false is returned
+*******************************************************************************/
+bool encode_components(std::vector<Mesh_component>& components, const Point& quan_size, 
+                       const int coor_bits[3], S_offset_mode offset_mode, 
+                       Bin_coder_type geometry_coder, std::vector<Component_entry>& entries, 
+                       std::vector<std::string>& streams, 
+                       std::vector<std::vector<Weld_entry>>& welds, 
+                       std::vector<std::vector<Vertex_index>>& results, Point& step_size) {
+    std::vector<std::size_t> order(components.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return components[a].vertex_table.size() > components[b].vertex_table.size();
+    });
+    
+    streams.assign(components.size(), std::string());
+    welds.assign(components.size(), std::vector<Weld_entry>());
+    results.assign(components.size(), std::vector<Vertex_index>());
+    std::vector<char> failed(components.size(), 0);
+    std::atomic<std::size_t> next_component(0);
+    
+    unsigned threads_cnt = std::max(1u, std::thread::hardware_concurrency());
+    threads_cnt = static_cast<unsigned>(std::min<std::size_t>(threads_cnt, components.size()));
+    run_threads(threads_cnt, [&](unsigned) {
+        std::size_t k;
+        while ((k = next_component++) < order.size()) {
+            std::size_t c = order[k];
+            std::vector<Corner_index> seam = std::move(components[c].seam);
+            Corner_table table;
+            if (!table.build(std::move(components[c].points), std::move(components[c].vertex_table))) {
+                failed[c] = 1;
+                continue;
+            }
+            
+            std::ostringstream ofile;
+            Encoder enc(std::move(table), ofile, quan_size, coor_bits[0], coor_bits[1], coor_bits[2]);
+            enc.set_s_offset_mode(offset_mode);
+            enc.set_geometry_coder(geometry_coder);
+            enc.mesh_compression();
+            
+            streams[c] = ofile.str();
+            results[c] = enc.compression_result();
+            
+            std::vector<Vertex_index> sections = enc.get_section_offsets();
+            std::copy(sections.begin(), sections.end(), entries[c].section_offset);
+            
+            const std::vector<Corner_index>& coding_order = enc.get_coding_order();
+            for (std::size_t k = 0; k < coding_order.size() && !seam.empty(); ++k) {
+                if (seam[coding_order[k]] != null_corner) {
+                    welds[c].push_back(Weld_entry{static_cast<std::uint32_t>(k), 
+                                                  static_cast<std::uint32_t>(seam[coding_order[k]])});
+                }
+            }
+            if (c == 0) {
+                step_size = enc.get_quan_step_size();
+            }
+        }
+    });
+    
+    for (std::size_t c = 0; c < components.size(); ++c) {
+        if (failed[c]) {
+            std::cerr << "ERROR: Cannot build the corner table of component " << c << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
 
 /*******************************************************************************
 Function: main()
@@ -96,10 +276,15 @@ int main(int argc, char** argv) {
     bool scaling = false;   // Scaling the vertices
     bool efficiency = false;   // Code efficiency
     double scaling_factor = 1;  // The scaling factor
+    S_offset_mode offset_mode = S_offset_mode::deferred;    // S offset calculation
+    std::string input_fname;    // Input mesh file name
+    Bin_coder_type geometry_coder = Bin_coder_type::spl;    // Geometry coder
+    int eb_version = 1;    // EB file version
+    unsigned slabs_cnt = 1;    // No. of slabs to cut the mesh into
     
     // User specified quantization step size
     char opt;
-    while ((opt = getopt(argc, argv, "x:y:z:b:hr:ds:c")) != EOF) {
+    while ((opt = getopt(argc, argv, "x:y:z:b:hr:ds:cwi:g:v:k:")) != EOF) {
         switch (opt) {
             case 'x':
             {
@@ -184,6 +369,51 @@ int main(int argc, char** argv) {
             case 'c':
                 efficiency = true;
                 break;
+                
+            case 'w':
+                offset_mode = S_offset_mode::walk;
+                break;
+                
+            case 'i':
+                input_fname = optarg;
+                break;
+                
+            case 'g':
+            {
+                std::string coder = optarg;
+                if (coder == "spl") {
+                    geometry_coder = Bin_coder_type::spl;
+                }
+                else if (coder == "range") {
+                    geometry_coder = Bin_coder_type::range;
+                }
+                else {
+                    std::cerr << "ERROR: Unknown geometry coder " << coder << "!\n";
+                    return 2;
+                }
+                break;
+            }
+                
+            case 'v':
+                eb_version = atoi(optarg);
+                if (eb_version != 1 && eb_version != 2) {
+                    std::cerr << "ERROR: Unknown EB file version " << optarg << "!\n";
+                    return 2;
+                }
+                break;
+                
+            case 'k':
+            {
+                int slabs = atoi(optarg);
+                if (slabs <= 0) {
+                    std::cerr << "ERROR: No. of slabs cannot be negative or zero!\n";
+                    return 2;
+                }
+                else {
+                    slabs_cnt = slabs;
+                }
+                break;
+            }
         }
     }
     
@@ -192,48 +422,29 @@ int main(int argc, char** argv) {
     // Read the input mesh and check its type
     //////////////////////////////////////////////////////////
     
-    Polyhedron mesh;
+    std::vector<Point> points;
+    std::vector<Corner_index> vertex_table;
 
-    // Read the input mesh from standard input in OFF format.
-    if (!(std::cin >> mesh)) {
+    // Read the input mesh in OFF format from the given file or the standard 
+    // input
+    bool read_mesh = input_fname.empty() ? 
+        read_off_stream(std::cin, points, vertex_table) : 
+        read_off_file(input_fname, points, vertex_table);
+    if (!read_mesh || points.empty()) {
         usage();
         std::cerr << "ERROR: Cannot read input mesh\n";
         return 1;
     }
-
-    if (!(mesh.is_pure_triangle())) {
-        usage();
-        std::cerr << "ERROR: Input mesh must be pure triangle\n";
-        return 1;
-    }
     
     
     //////////////////////////////////////////////////////////
     // Delete the duplicated vertices
     //////////////////////////////////////////////////////////
     
-    // The polyhedron types
-    typedef Polyhedron::Vertex_iterator Vertex_iterator;
-    typedef Polyhedron::Vertex_handle Vertex_handle;
-    typedef Polyhedron::Halfedge_handle Halfedge_handle;
-    
-    // Variable initialization
-    std::set<Point> mesh_vertices;
-    std::set<Halfedge_handle> edge_to_erase;
-    std::set<Vertex_handle> vertex_to_erase;
-    bool duplicated_vertex = false;
-    
-    // Find the duplicated vertices 
-    for (auto vit = mesh.vertices_begin(); vit != mesh.vertices_end(); ++vit) {
-        Point p = (*vit).point();
-        if (mesh_vertices.find(p) != mesh_vertices.end()) {
-            vertex_to_erase.insert(&*vit);
-            duplicated_vertex = true;
-        }
-        else {
-            mesh_vertices.insert(p);
-        }
-    }
+    // Find the duplicated vertices, each of them is mapped to the first vertex 
+    // at the same position
+    std::vector<Corner_index> vertex_remap;
+    bool duplicated_vertex = find_duplicate_vertices(points, vertex_remap) != 0;
     
     if (duplicated_vertex) {
         if (!remove_vertices) {
@@ -243,18 +454,12 @@ int main(int argc, char** argv) {
             return 1;
         }
         else {
-            // Erase the halfedges that connected to the duplicated vertices 
-            for (auto it = vertex_to_erase.begin(); it != vertex_to_erase.end(); ++it) {
-                Halfedge_handle erase_halfedge = (*(*it)).halfedge();
-                Halfedge_handle return_edge = mesh.erase_center_vertex(erase_halfedge);
-                
-                edge_to_erase.insert(return_edge);
-            }
-            
-            // Erase the facets that connected to the duplicated vertices 
-            for (auto hit = edge_to_erase.begin(); hit != edge_to_erase.end(); ++hit) {
-                mesh.erase_facet(*hit);
+            // Erase the duplicated vertices and the facets that connected to them
+            std::vector<char> vertex_to_erase(points.size());
+            for (std::size_t v = 0; v < points.size(); ++v) {
+                vertex_to_erase[v] = (vertex_remap[v] != static_cast<Corner_index>(v));
             }
+            erase_vertices(points, vertex_table, vertex_to_erase);
             
             std::clog << "Remove all of the duplicated vertices.\n";
         }
@@ -268,13 +473,13 @@ int main(int argc, char** argv) {
     if (scaling) {
         // std::clog << "Scaling all of the mesh's vertices by: " << scaling_factor << "\n";
         
-        for (auto iter = mesh.vertices_begin(); iter != mesh.vertices_end(); ++iter) {
-            Point p = iter -> point();
+        for (auto iter = points.begin(); iter != points.end(); ++iter) {
+            Point p = *iter;
             double p_x = p.x() * scaling_factor;
             double p_y = p.y() * scaling_factor;
             double p_z = p.z() * scaling_factor;
             
-            iter -> point() = Point(p_x, p_y, p_z);
+            *iter = Point(p_x, p_y, p_z);
         }
     }
     
@@ -284,7 +489,7 @@ int main(int argc, char** argv) {
     //////////////////////////////////////////////////////////
 
     // Calculate the bounding box of the mesh
-    Bbox_3 bbox = bounding_box(mesh);
+    Bbox_3 bbox = bounding_box(points);
     
     // std::clog << "bounding box: "
               // << "[" << bbox.xmin() << "," << bbox.xmax() << "] x "
@@ -398,8 +603,122 @@ int main(int argc, char** argv) {
     //////////////////////////////////////////////////////////
         
     auto start_t = std::chrono::high_resolution_clock::now();
-    Encoder enc(mesh, std::cout, quan_size, x_coor_bits, y_coor_bits, z_coor_bits);
-    enc.mesh_compression();
+    
+    // A mesh with several connected components is split, and each component 
+    // is compressed on its own into a chunk of the version 2 container. A 
+    // mesh cut into patches is stored in the same way, each patch is a chunk.
+    std::vector<Corner_index> vertex_component;
+    Corner_index components_cnt = (slabs_cnt > 1) ? 0 : 
+        find_components(points.size(), vertex_table, vertex_component);
+    
+    std::vector<Vertex_index> result_vec;
+    Point step_size;
+    Corner_index seams_cnt = 0;    // No. of seam vertices between the patches
+    std::size_t copies_cnt = 0;    // No. of copies of the seam vertices
+    std::size_t container_bytes = 0;    // No. of bytes of directory and weld maps
+    if (components_cnt == 1 && eb_version == 1) {
+        Corner_table table;
+        if (!table.build(std::move(points), std::move(vertex_table))) {
+            std::cerr << "ERROR: Cannot build the corner table of input mesh\n";
+            return 1;
+        }
+        
+        // The corner table is moved into the encoder, so only one copy of the 
+        // mesh exists
+        Encoder enc(std::move(table), std::cout, quan_size, x_coor_bits, y_coor_bits, z_coor_bits);
+        enc.set_s_offset_mode(offset_mode);
+        enc.set_geometry_coder(geometry_coder);
+        enc.mesh_compression();
+        
+        result_vec = enc.compression_result();
+        step_size = enc.get_quan_step_size();
+    }
+    else {
+        std::vector<Mesh_component> components;
+        Vertex_index mesh_vertices = points.size();
+        Corner_index cut_edges = 0;
+        if (slabs_cnt > 1) {
+            Corner_table table;
+            if (!table.build(std::move(points), std::move(vertex_table))) {
+                std::cerr << "ERROR: Cannot build the corner table of input mesh\n";
+                return 1;
+            }
+            if (!partition_mesh(table, slabs_cnt, components, seams_cnt, cut_edges)) {
+                std::cerr << "ERROR: Input mesh contains vertices without any facet!\n";
+                return 1;
+            }
+        }
+        else if (components_cnt == 1) {
+            components.resize(1);
+            components[0].points = std::move(points);
+            components[0].vertex_table = std::move(vertex_table);
+        }
+        else {
+            components.resize(components_cnt);
+            split_components(points, vertex_table, vertex_component, components);
+        }
+        points = std::vector<Point>();
+        vertex_table = std::vector<Corner_index>();
+        vertex_component = std::vector<Corner_index>();
+        components_cnt = components.size();
+        
+        // Build the directory of the container
+        std::vector<Component_entry> entries(components_cnt);
+        for (Corner_index c = 0; c < components_cnt; ++c) {
+            if (components[c].vertex_table.empty()) {
+                std::cerr << "ERROR: Input mesh contains vertices without any facet!\n";
+                return 1;
+            }
+            if (components[c].points.size() > UINT32_MAX || 
+                components[c].vertex_table.size() / 3 > UINT32_MAX) {
+                std::cerr << "ERROR: Too many vertices in a connected component!\n";
+                return 1;
+            }
+            entries[c].vertices_cnt = components[c].points.size();
+            entries[c].faces_cnt = components[c].vertex_table.size() / 3;
+        }
+        
+        const int coor_bits[3] = {x_coor_bits, y_coor_bits, z_coor_bits};
+        std::vector<std::string> streams;
+        std::vector<std::vector<Weld_entry>> welds;
+        std::vector<std::vector<Vertex_index>> results;
+        if (!encode_components(components, quan_size, coor_bits, offset_mode, geometry_coder, 
+                               entries, streams, welds, results, step_size)) {
+            return 1;
+        }
+        
+        container_bytes = component_index_size(components_cnt);
+        for (auto it = welds.begin(); it != welds.end(); ++it) {
+            copies_cnt += it->size();
+        }
+        container_bytes += weld_entry_size * copies_cnt;
+        if (copies_cnt == 0) {
+            welds.clear();
+        }
+        
+        if (!write_component_container(std::cout, entries, streams, welds)) {
+            std::cerr << "ERROR: Cannot write the compressed triangle mesh!\n";
+            return 1;
+        }
+        
+        // The mesh information is the sum over the components, except the 
+        // total No. of bytes which includes the container directory and the 
+        // weld maps. The seam vertices and the cut edges of the patches are 
+        // only counted once, the boundary loops and genus are still the sums 
+        // over the patches.
+        result_vec.assign(results.front().size(), 0);
+        for (auto it = results.begin(); it != results.end(); ++it) {
+            for (std::size_t i = 0; i < it->size(); ++i) {
+                result_vec[i] += (*it)[i];
+            }
+        }
+        result_vec[0] = mesh_vertices;
+        result_vec[1] -= cut_edges;
+        result_vec[5] = container_bytes;
+        for (auto it = streams.begin(); it != streams.end(); ++it) {
+            result_vec[5] += it->size();
+        }
+    }
     auto end_t = std::chrono::high_resolution_clock::now();
     
     
@@ -424,7 +743,6 @@ int main(int argc, char** argv) {
     
     if (output_result == 1) {
         std::ofstream ofile_result(result_fname);
-        std::vector<Vertex_index> result_vec = enc.compression_result();
         
         double run_time = std::chrono::duration<double>(end_t - start_t).count();
         double peak_mem = SPL::getPeakMemUsage();
@@ -435,8 +753,6 @@ int main(int argc, char** argv) {
         }
         
         ofile_result << run_time << " " << peak_mem << " ";
-        
-        Point step_size = enc.get_quan_step_size();
         ofile_result << step_size << "\n";
         
         ofile_result.flush();
@@ -452,8 +768,6 @@ int main(int argc, char** argv) {
     //////////////////////////////////////////////////////////
     
     if (efficiency) {
-        std::vector<Vertex_index> result_vec = enc.compression_result();
-        
         // Overall coding efficiency
         double overall_eff = result_vec[5] * 8.0 / result_vec[0];
         std::clog << "Overall coding efficiency is: " << overall_eff << " bits per vertex \n";
@@ -465,6 +779,22 @@ int main(int argc, char** argv) {
         // Coding efficiency for connectivity part
         double conn_eff = result_vec[7] * 8.0 / result_vec[0];
         std::clog << "Coding efficiency for connectivity part is: " << conn_eff << " bits per vertex \n";
+        
+        // Overhead of cutting the mesh into patches: the directory and weld 
+        // maps, and the extra copies of the seam vertices, which are taken 
+        // to cost the average geometry bits per coded vertex
+        if (slabs_cnt > 1) {
+            double coded_vertices = result_vec[0] + copies_cnt - seams_cnt;
+            double extra_copies = copies_cnt - seams_cnt;
+            double container_eff = container_bytes * 8.0 / result_vec[0];
+            double seam_eff = result_vec[6] * 8.0 / coded_vertices * extra_copies / result_vec[0];
+            std::clog << "Mesh is cut into " << components_cnt << " patches with " 
+                      << seams_cnt << " seam vertices (" << copies_cnt << " copies) \n";
+            std::clog << "Overhead of the directory and weld maps is: " << container_eff 
+                      << " bits per vertex \n";
+            std::clog << "Overhead of the seam vertex copies is about: " << seam_eff 
+                      << " bits per vertex \n";
+        }
     }
     
 
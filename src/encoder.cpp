@@ -5,148 +5,6 @@
 #include <iterator>
 
 
-//////////////////////////////////////////////////////////
-// Function implementation from My_Vertex class
-//////////////////////////////////////////////////////////
-
-/*******************************************************************************
-Function: int get_vertex_mark() const;
-Description:
-    Get current vertex mark
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-int My_Vertex<Refs, Traits, P>::get_vertex_mark() const {
-    return mark;
-}
-
-
-/*******************************************************************************
-Function: void set_vertex_mark(int mark_value);
-Description:
-    Set current vertex mark
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-void My_Vertex<Refs, Traits, P>::set_vertex_mark(int mark_value) {
-    mark = mark_value;
-}
-
-
-/*******************************************************************************
-Function: Vertex_index get_index() const;
-Description:
-    Get current vertex index
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-Vertex_index My_Vertex<Refs, Traits, P>::get_index() const {
-    return index;
-}
-
-
-/*******************************************************************************
-Function: void set_index(Vertex_index index_value);
-Description:
-    Set current vertex index
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-void My_Vertex<Refs, Traits, P>::set_index(Vertex_index index_value) {
-    index = index_value;
-}
-
-
-/*******************************************************************************
-Function: bool get_flag() const;
-Description:
-    Get current vertex prediction flag
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-bool My_Vertex<Refs, Traits, P>::get_flag() const {
-    return prediction;
-}
-
-
-/*******************************************************************************
-Function: void set_flag(bool flag);
-Description:
-    Set current vertex prediction flag
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-void My_Vertex<Refs, Traits, P>::set_flag(bool flag) {
-    prediction = flag;
-}
-
-
-
-//////////////////////////////////////////////////////////
-// Function implementation from My_Vertex class
-//////////////////////////////////////////////////////////
-
-/*******************************************************************************
-Function: int get_halfedge_mark() const;
-Description:
-    Get the current vertex mark
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-int My_Halfedge<Refs, TP, TV, TF>::get_halfedge_mark() const {
-    return mark;
-}
-
-
-/*******************************************************************************
-Function: void set_halfedge_mark(int mark_value);
-Description:
-    Set the current vertex mark
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-void My_Halfedge<Refs, TP, TV, TF>::set_halfedge_mark(int mark_value) {
-    mark = mark_value;
-}
-
-
-/*******************************************************************************
-Function: Halfedge_handle prev_on_border() const;
-Description:
-    Get the previous halfedge on border
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-typename Refs::Halfedge_handle My_Halfedge<Refs, TP, TV, TF>::prev_on_border() const {
-    return prev_halfedge_on_border;
-}
-
-
-/*******************************************************************************
-Function: Halfedge_handle next_on_border() const;
-Description:
-    Get the next halfedge on border
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-typename Refs::Halfedge_handle My_Halfedge<Refs, TP, TV, TF>::next_on_border() const {
-    return next_halfedge_on_border;
-}
-
-
-/*******************************************************************************
-Function: void set_prev_on_border(Halfedge_handle prev);
-Description:
-    Set the previous halfedge on border
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-void My_Halfedge<Refs, TP, TV, TF>::set_prev_on_border(Halfedge_handle prev) {
-    prev_halfedge_on_border = prev;
-}
-
-
-/*******************************************************************************
-Function: void set_next_on_border(Halfedge_handle next);
-Description:
-    Set the next halfedge on border
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-void My_Halfedge<Refs, TP, TV, TF>::set_next_on_border(Halfedge_handle next) {
-    next_halfedge_on_border = next;
-}
-
-
-
 //////////////////////////////////////////////////////////
 // Function implementation
 //////////////////////////////////////////////////////////
@@ -154,63 +12,34 @@ void My_Halfedge<Refs, TP, TV, TF>::set_next_on_border(Halfedge_handle next) {
 /*******************************************************************************
 Function: getBorderLoops()
 Description:
-    The function finds all of the border loops in the polyhedron mesh. For each 
-    border loop that is found, one representative border halfedge from the loop 
-    is written to the iterator halfedgeIter and the loop size is written to the 
-    iterator sizeIter.
+    The function finds all of the border loops in the mesh. For each border 
+    loop that is found, all of its border edges are written to the iterator 
+    cornerIter in the loop order, and the loop size is written to the 
+    iterator sizeIter. The corners are scanned once in increasing order, a 
+    loop is walked when its first (smallest) unvisited border edge is met.
 *******************************************************************************/
-template <class P, class I1, class I2>
-int getBorderLoops(P& polyMesh, I1 halfedgeIter, I2 sizeIter) {
-    // The polyhedron types
-    typedef typename P::Halfedge_iterator Halfedge_iterator;
-    typedef typename P::Halfedge_handle Halfedge_handle;
-    
-    // Initialize for boundary and holes
-    std::set<Halfedge_handle> border_edges;     // Set for all border halfedges
-    int border_len = 0;    // Length of visited border halfedges
-    int loop_cnt = 0;   // No. of loops in the mesh
+template <class I1, class I2>
+int getBorderLoops(const Corner_table& mesh, I1 cornerIter, I2 sizeIter) {
+    const Corner_index corners_cnt = static_cast<Corner_index>(mesh.size_of_corners());
     
-    // Add all border halfedges to the border_edges set
-    for (auto hit = polyMesh.border_halfedges_begin(); hit != polyMesh.halfedges_end(); ++hit) {
-        //Move to the border halfedge
-        ++hit;   
-        
-        // Check if current halfedge is border halfedge
-        assert((*hit).is_border());
-        
-        // Add border halfedge to the border_edges vector
-        border_edges.insert(&*hit);
-    }
+    // The border edges that are already on a found loop
+    std::vector<bool> visited(corners_cnt, false);
+    int loop_cnt = 0;   // No. of loops in the mesh
     
-    while (!border_edges.empty()) {
-        Halfedge_handle border_start = *(border_edges.begin());
-        
-        // Update the beginning halfedge for current bounding loop
-        *(halfedgeIter++) = border_start;
-        
-        // Find the next halfedge for current bounding loop
-        Halfedge_handle next_border = border_start -> next();
-
-        // Erase beginning halfedge from border_edges set
-        border_edges.erase(border_start);
-        
-        // Update the length of current bounding loop
-        border_len = 1;
+    for (Corner_index border_start = 0; border_start < corners_cnt; ++border_start) {
+        if (!mesh.is_border(border_start) || visited[border_start]) {
+            continue;
+        }
         
-        // Find the rest halfedges on current bounding loop
-        while (next_border != border_start) {
-            // Update the loop length
+        // Walk around the loop
+        int border_len = 0;
+        Corner_index next_border = border_start;
+        do {
+            visited[next_border] = true;
+            *(cornerIter++) = next_border;
             ++border_len;
-            
-            // The halfedge that needs to be deleted from the set
-            Halfedge_handle edge_delete = next_border;
-            
-            // Find the next halfedge for current bounding loop
-            next_border = next_border -> next();
-            
-            // Erase the detected halfedge from border_edges set
-            border_edges.erase(edge_delete);
-        }
+            next_border = mesh.border_prev(next_border);
+        } while (next_border != border_start);
         
         // Update the loop count and the length of current loop
         ++loop_cnt;
@@ -226,86 +55,67 @@ Function: getConnectedComponents()
 Description:
     The function determines the connected components of the mesh. (Vertices are 
     in the same connected component if they are connected by a path consisting 
-    of one or more edges.) For each connected component, a handle corresponding 
-    to a single representative vertex in the component is written to the output 
-    iterator vertexIter.
+    of one or more edges.) For each connected component, the index of a single 
+    representative vertex (the smallest vertex index in the component) is 
+    written to the output iterator vertexIter, in increasing order.
+    
+    The two edges (v0, v1) and (v1, v2) of each triangle are merged in a 
+    union-find structure. With more than one thread, each thread merges the 
+    edges of one chunk of triangles in a shared lock-free union-find.
 *******************************************************************************/
-template <class P, class I>
-int getConnectedComponents(const P& polyMesh, I vertexIter) {
-    // The polyhedron types
-    typedef typename P::Halfedge_const_handle Halfedge_const_handle;
-    typedef typename P::Vertex_const_iterator Vertex_const_iterator;
-    typedef typename P::Vertex_const_handle Vertex_const_handle;
-    
-    // Initialize a set for all NOT visited vertices
-    std::set<Vertex_const_handle> not_visited_vertices;
-    // Initialize a stack for all the not visited adjacent vertices
-    std::stack<Halfedge_const_handle> edge_stack;
-    // Initialize number of components
-    int components = 0;
+template <class I>
+int getConnectedComponents(const Corner_table& mesh, I vertexIter, unsigned threads_cnt) {
+    const Corner_index vertices_cnt = static_cast<Corner_index>(mesh.size_of_vertices());
+    const Corner_index facets_cnt = static_cast<Corner_index>(mesh.size_of_facets());
+    
+    // Minimum No. of triangles handled by each thread
+    const Corner_index min_facets_per_thread = 1 << 16;
     
-    // Add all vertices to the not_visited_vertices set
-    for (auto vit = polyMesh.vertices_begin(); vit != polyMesh.vertices_end(); ++vit) {
-        not_visited_vertices.insert(&*vit);
+    if (threads_cnt == 0) {
+        threads_cnt = std::max(1u, std::thread::hardware_concurrency());
     }
+    Corner_index max_threads = std::max<Corner_index>(1, facets_cnt / min_facets_per_thread);
+    threads_cnt = static_cast<unsigned>(std::min<Corner_index>(threads_cnt, max_threads));
     
-    do {
-        // Find the initial vertex for current component
-        Vertex_const_handle vertex_start = *(not_visited_vertices.begin());
-
-        // Update the represent vertex handles
-        *(vertexIter++) = vertex_start;
-        
-        // Add the halfedge to the edge stack
-        Halfedge_const_handle halfedge_start = vertex_start -> halfedge();
-        edge_stack.push(halfedge_start);
-        
-        // Erase the initial vertex from the not_visited_vertices set
-        not_visited_vertices.erase(vertex_start);
-        
-        while (!edge_stack.empty()) {            
-            Halfedge_const_handle current_edge = edge_stack.top();
-            int valence = current_edge -> vertex_degree();
-            
-            // Initialize a count for the not visited neighbour vertex
-            int not_visited_neighbor = 0;
-            
-            // Initialize the next halfedge and next vertex
-            Halfedge_const_handle next_edge = current_edge -> next_on_vertex();
-            Vertex_const_handle next_vertex = next_edge -> opposite() -> vertex();
-            
-            // Find the not visited adjacent vertex
-            for (int i = 0; i < valence; ++i) {
-                // If next vertex is not visited, push it to the not visited stack
-                if(not_visited_vertices.find(next_vertex) != not_visited_vertices.end()) {                    
-                    // Push the current halfedge to the stack
-                    edge_stack.push(next_edge -> opposite());
-                    
-                    // Update the not visited neighbour count
-                    not_visited_neighbor = 1;
-                    
-                    // Erase the current vertex from set
-                    not_visited_vertices.erase(next_vertex);
-                    
-                    // Find the not visited neighbour, break the for loop
-                    break;
-                }
-                
-                // Update the next halfedge and vertex
-                next_edge = next_edge -> next_on_vertex();
-                next_vertex = next_edge -> opposite() -> vertex();
-            }
-            
-            // If current vertex don't have any not visited vertices, pop the stack
-            if (not_visited_neighbor == 0) {
-                edge_stack.pop();
+    // Initialize number of components
+    int components = 0;
+    
+    // Write the smallest vertex of each set. A set is met for the first time 
+    // at its smallest vertex
+    auto write_components = [&](auto& sets) {
+        std::vector<char> root_seen(vertices_cnt, 0);
+        for (Corner_index v = 0; v < vertices_cnt; ++v) {
+            Corner_index root = sets.find(v);
+            if (!root_seen[root]) {
+                root_seen[root] = 1;
+                *(vertexIter++) = v;
+                ++components;
             }
         }
-        
-        // Update the components count
-        ++components;
-        
-    } while (!not_visited_vertices.empty());
+    };
+    
+    if (threads_cnt == 1) {
+        Union_find sets(vertices_cnt);
+        for (Corner_index t = 0; t < facets_cnt; ++t) {
+            Corner_index v1 = mesh.vertex(3 * t + 1);
+            sets.unite(mesh.vertex(3 * t), v1);
+            sets.unite(v1, mesh.vertex(3 * t + 2));
+        }
+        write_components(sets);
+    }
+    else {
+        Concurrent_union_find sets(vertices_cnt);
+        run_threads(threads_cnt, [&](unsigned thread) {
+            Corner_index begin = static_cast<Corner_index>(std::int64_t(facets_cnt) * thread / threads_cnt);
+            Corner_index end = static_cast<Corner_index>(std::int64_t(facets_cnt) * (thread + 1) / threads_cnt);
+            for (Corner_index t = begin; t < end; ++t) {
+                Corner_index v1 = mesh.vertex(3 * t + 1);
+                sets.unite(mesh.vertex(3 * t), v1);
+                sets.unite(v1, mesh.vertex(3 * t + 2));
+            }
+        });
+        write_components(sets);
+    }
     
     return components;
 }
@@ -316,13 +126,49 @@ int getConnectedComponents(const P& polyMesh, I vertexIter) {
 //////////////////////////////////////////////////////////
 
 /*******************************************************************************
-Function: Encoder(Polyhedron mesh, std::ostream& ofile, Point quan_size,  
+Function: Encoder(const Corner_table& mesh, std::ostream& ofile, 
+                  Point quan_size, int x_bit, int y_bit, int z_bit);
+Description:
+    Encoder class constructors, views the given mesh
+*******************************************************************************/
+Encoder::Encoder(const Corner_table& mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit)
+  : Encoder(&mesh, nullptr, ofile, quan_size, x_bit, y_bit, z_bit) {
+}
+
+
+/*******************************************************************************
+Function: Encoder(Corner_table&& mesh, std::ostream& ofile, Point quan_size, 
                   int x_bit, int y_bit, int z_bit);
 Description:
-    Encoder class constructors
+    Encoder class constructors, moves the given mesh into the Encoder
 *******************************************************************************/
-Encoder::Encoder(Polyhedron mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit)
-  : polyMesh(mesh), ofile_eb(ofile), step_size(quan_size), x_coor_bits(x_bit), y_coor_bits(y_bit), 
+Encoder::Encoder(Corner_table&& mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit)
+  : Encoder(nullptr, std::make_unique<const Corner_table>(std::move(mesh)), ofile, quan_size, x_bit, y_bit, z_bit) {
+}
+
+
+/*******************************************************************************
+Function: Encoder(std::unique_ptr<Corner_table> mesh, std::ostream& ofile, 
+                  Point quan_size, int x_bit, int y_bit, int z_bit);
+Description:
+    Encoder class constructors, takes over the given mesh
+*******************************************************************************/
+Encoder::Encoder(std::unique_ptr<Corner_table> mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit)
+  : Encoder(nullptr, std::move(mesh), ofile, quan_size, x_bit, y_bit, z_bit) {
+}
+
+
+/*******************************************************************************
+Function: Encoder(const Corner_table* view, 
+                  std::unique_ptr<const Corner_table> owned, 
+                  std::ostream& ofile, Point quan_size, 
+                  int x_bit, int y_bit, int z_bit);
+Description:
+    Encoder class constructors, exactly one of view and owned is not null
+*******************************************************************************/
+Encoder::Encoder(const Corner_table* view, std::unique_ptr<const Corner_table> owned, 
+                 std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit)
+  : owned_mesh(std::move(owned)), mesh(view ? *view : *owned_mesh), gate(null_corner), offset_mode(S_offset_mode::deferred), ofile_eb(ofile), step_size(quan_size), x_coor_bits(x_bit), y_coor_bits(y_bit), 
     z_coor_bits(z_bit), out(geom_out), enc(total_contexts_cnt, &out) {
         
     numBorderLoops = 0;
@@ -332,10 +178,19 @@ Encoder::Encoder(Polyhedron mesh, std::ostream& ofile, Point quan_size, int x_bi
     vertices_index = 0;
     processed_cnt = 0;
     affected_s_cnt = 0;
+    e_count = 0;
     coded_data_len = 0;
     conn_str_len = 0;
     geom_str_len = 0;
     
+    // The binarization trees of the coordinates, the contexts of y and z 
+    // coordinates follow the contexts of the previous coordinate
+    int x_contexts = Context_selector::total_contexts(x_coor_bits, f_levels);
+    int y_contexts = Context_selector::total_contexts(y_coor_bits, f_levels);
+    coor_context[0] = Context_selector(x_coor_bits, f_levels, 0);
+    coor_context[1] = Context_selector(y_coor_bits, f_levels, x_contexts);
+    coor_context[2] = Context_selector(z_coor_bits, f_levels, x_contexts + y_contexts);
+    
     // Starts the arithmetic encoder
     enc.start();
 }
@@ -354,6 +209,7 @@ Encoder::~Encoder() {
     --vertices_index;
     --processed_cnt;
     --affected_s_cnt;
+    --e_count;
     --coded_data_len;
     --conn_str_len;
     --geom_str_len;
@@ -445,9 +301,9 @@ std::vector<Vertex_index> Encoder::compression_result() {
     std::vector<Vertex_index> result_vec;
     
     // Basic mesh information
-    Vertex_index vertices = polyMesh.size_of_vertices();
-    Vertex_index facets = polyMesh.size_of_facets();
-    Vertex_index halfedges = polyMesh.size_of_halfedges();
+    Vertex_index vertices = mesh.size_of_vertices();
+    Vertex_index facets = mesh.size_of_facets();
+    Vertex_index halfedges = mesh.size_of_halfedges();
     Vertex_index edges = halfedges / 2;
     int genus = 1.0 - (static_cast<double>(vertices) + facets - edges) / 2.0 - numBorderLoops / 2.0;
     
@@ -478,184 +334,51 @@ Point Encoder::get_quan_step_size() {
 }
 
 
-//////////////////////////////////////////////////////////
-// Private functions from Encoder class
-//////////////////////////////////////////////////////////
+/*******************************************************************************
+Function: std::vector<Vertex_index> get_section_offsets();
+Description:
+    Gets the position of each section of the EB stream
+*******************************************************************************/
+std::vector<Vertex_index> Encoder::get_section_offsets() {
+    return section_offsets;
+}
+
 
 /*******************************************************************************
-Function: static void Encoder::write_history_code1(const std::vector<Triangle_type>& 
-          hist_vec, std::string& binary_string)
+Function: const std::vector<Corner_index>& get_coding_order() const;
 Description:
-    Binary history string generation function (Using code series 1)
+    Gets the vertices in the order their coordinates are coded
 *******************************************************************************/
-void Encoder::write_history_code1(const std::vector<Triangle_type>& hist_vec, std::string& binary_string) {
-    // Initialize binary code
-    std::string binary_code;
-    // Initialize current op-code and previous op-code
-    Triangle_type opcode = I, prev_code = I;
-    
-    // Generate the binary history string from the history vector
-    for(auto it = hist_vec.begin(); it != hist_vec.end(); ++it) {
-        // Get the current op-code
-        opcode = *it;
-        
-        // Current triangle follows a C type triangle
-        if (prev_code == C) {
-            if (opcode == C) { 
-                binary_code = "0"; 
-            }
-            else if (opcode == S) {
-                binary_code = "10"; 
-            }
-            else if (opcode == R) {
-                binary_code = "11"; 
-            }
-        }
-        
-        // Current triangle NOT follows a C type triangle
-        else {
-            if (opcode == C) {
-                binary_code = "0";
-            }
-            else if (opcode == S) {
-                binary_code = "100";
-            }
-            else if (opcode == R) {
-                binary_code = "101";
-            }
-            else if (opcode == L) {
-                binary_code = "110";
-            }
-            else if (opcode == E) {
-                binary_code = "111";
-            }
-        }
-        
-        // Write current code to the history string
-        binary_string += binary_code;
-        
-        // Update the previous op-code
-        prev_code = opcode;
-    }
+const std::vector<Corner_index>& Encoder::get_coding_order() const {
+    return coding_order;
 }
 
 
 /*******************************************************************************
-Function: static void Encoder::write_history_code2(const std::vector<Triangle_type>& 
-          hist_vec, std::string& binary_string)
+Function: void set_s_offset_mode(S_offset_mode mode);
 Description:
-    Binary history string generation function (Using code series 2)
+    Selects the S operation offset calculation method
 *******************************************************************************/
-void Encoder::write_history_code2(const std::vector<Triangle_type>& hist_vec, std::string& binary_string) {
-    // Initialize binary code
-    std::string binary_code;
-    // Initialize current op-code and previous op-code
-    Triangle_type opcode = I, prev_code = I;
-    
-    // Generate the binary history string from the history vector
-    for(auto it = hist_vec.begin(); it != hist_vec.end(); ++it) {
-        // Get the current op-code
-        opcode = *it;
-        
-        // Current triangle follows a C type triangle
-        if (prev_code == C) {
-            if (opcode == C) {
-                binary_code = "0";
-            }
-            else if (opcode == S) {
-                binary_code = "10";
-            }
-            else if (opcode == R) {
-                binary_code = "11";
-            }
-        }
-        
-        // Current triangle NOT follows a C type triangle
-        else {
-            if (opcode == C) {
-                binary_code = "00";
-            }
-            else if (opcode == S) {
-                binary_code = "111";
-            }
-            else if (opcode == R) {
-                binary_code = "10";
-            }
-            else if (opcode == L) {
-                binary_code = "110";
-            }
-            else if (opcode == E) {
-                binary_code = "01";
-            }
-        }
-        
-        // Write current code to the history string
-        binary_string += binary_code;
-        
-        // Update the previous op-code
-        prev_code = opcode;
-    }
+void Encoder::set_s_offset_mode(S_offset_mode mode) {
+    offset_mode = mode;
 }
 
 
 /*******************************************************************************
-Function: static void Encoder::write_history_code3(const std::vector<Triangle_type>& 
-          hist_vec, std::string& binary_string)
+Function: void set_geometry_coder(Bin_coder_type type);
 Description:
-    Binary history string generation function (Using code series 3)
+    Selects the binary arithmetic coder of the geometry part, and restarts it
 *******************************************************************************/
-void Encoder::write_history_code3(const std::vector<Triangle_type>& hist_vec, std::string& binary_string) {
-    // Initialize binary code
-    std::string binary_code;
-    // Initialize current op-code and previous op-code
-    Triangle_type opcode = I, prev_code = I;
-    
-    // Generate the binary history string from the history vector
-    for(auto it = hist_vec.begin(); it != hist_vec.end(); ++it) {
-        // Get the current op-code
-        opcode = *it;
-        
-        // Current triangle follows a C type triangle
-        if (prev_code == C) {
-            if (opcode == C) {
-                binary_code = "0";
-            }
-            else if (opcode == S) {
-                binary_code = "10";
-            }
-            else if (opcode == R) {
-                binary_code = "11";
-            }
-        }
-        
-        // Current triangle NOT follows a C type triangle
-        else {
-            if (opcode == C) {
-                binary_code = "00";
-            }
-            else if (opcode == S) {
-                binary_code = "010";
-            }
-            else if (opcode == R) {
-                binary_code = "011";
-            }
-            else if (opcode == L) {
-                binary_code = "10";
-            }
-            else if (opcode == E) {
-                binary_code = "11";
-            }
-        }
-        
-        // Write current code to the history string
-        binary_string += binary_code;
-        
-        // Update the previous op-code
-        prev_code = opcode;
-    }
+void Encoder::set_geometry_coder(Bin_coder_type type) {
+    enc.set_coder(type);
+    enc.start();
 }
 
 
+//////////////////////////////////////////////////////////
+// Private functions from Encoder class
+//////////////////////////////////////////////////////////
+
 /*******************************************************************************
 Function: static int code_series_determine(const std::vector<Triangle_type>& hist_vec);
 Description:
@@ -724,140 +447,108 @@ Description:
 *******************************************************************************/
 bool Encoder::preprocessing(){
     // Test to see if the mesh contains the single component
-    std::vector<Vertex_const_handle> componentVertices;
-    int component_cnt = getConnectedComponents<Polyhedron, std::back_insert_iterator<std::vector<Vertex_const_handle>>>
-    (polyMesh, std::back_inserter(componentVertices));
+    std::vector<Corner_index> componentVertices;
+    int component_cnt = getConnectedComponents<std::back_insert_iterator<std::vector<Corner_index>>>
+    (mesh, std::back_inserter(componentVertices), 0);
     
     if(component_cnt != 1) {
         std::cerr << "ERROR: Input triangle mesh should contain ONLY one component!\n";
         exit(1);
     }
     
-    // Normalize the mesh's border
-    if (!(polyMesh.normalized_border_is_valid())) {
-        polyMesh.normalize_border();
-    }
-    
     
     //////////////////////////////////////////////////////////
     // Mesh preprocessing
     //////////////////////////////////////////////////////////
     
-    // Initialize all vertices' mark, index and flag
-    for (auto iter = polyMesh.vertices_begin(); iter != polyMesh.vertices_end(); ++iter) {
-        (*iter).set_vertex_mark(0);
-        (*iter).set_index(0);
-        (*iter).set_flag(false);
-        
-        // Get current point
-        Point p = iter -> point();
-        
-        // Get the quantization index the current point
-        Quant_index p_x = 0, p_y = 0, p_z = 0;      
-        Quant_index max_x_val = pow2int(x_coor_bits - 2);
-        Quant_index max_y_val = pow2int(y_coor_bits - 2);
-        Quant_index max_z_val = pow2int(z_coor_bits - 2);
-        
-        // x coordinate
-        double point_x = SPL::signum(p.x()) * std::floor(std::abs(p.x()) / step_size.x() + 0.5);
-        if (point_x > std::numeric_limits<Quant_index>::max()) {
-            std::cerr << "ERROR: X coordinate quantization index overflow!\n";
-            return false;
-        }
-        else {
-            if (std::abs(point_x) > max_x_val) {
-                std::cerr << "ERROR: X coordinate quantization index overflow!\n";
-                return false;
-            }
-            else {
-                p_x = static_cast<Quant_index>(point_x);
-            }
-        }
-        
-        // y coordinate
-        double point_y = SPL::signum(p.y()) * std::floor(std::abs(p.y()) / step_size.y() + 0.5);
-        if (point_y > std::numeric_limits<Quant_index>::max()) {
-            std::cerr << "ERROR: Y coordinate quantization index overflow!\n";
-            return false;
-        }
-        else {
-            if (std::abs(point_y) > max_y_val) {
-                std::cerr << "ERROR: Y coordinate quantization index overflow!\n";
-                return false;
-            }
-            else {
-                p_y = static_cast<Quant_index>(point_y);
-            }
+    // Initialize all vertices' mark and flag
+    vertex_mark.assign(mesh.size_of_vertices(), 0);
+    vertex_flag.assign(mesh.size_of_vertices(), false);
+    coding_order.clear();
+    coding_order.reserve(mesh.size_of_vertices());
+    quant_points.resize(mesh.size_of_vertices());
+    
+    // Quantize all vertices, the coordinates of a block of vertices are 
+    // gathered for each axis and quantized together
+    const double steps[3] = {step_size.x(), step_size.y(), step_size.z()};
+    const Quant_index max_vals[3] = {
+        static_cast<Quant_index>(pow2int(x_coor_bits - 2)), 
+        static_cast<Quant_index>(pow2int(y_coor_bits - 2)), 
+        static_cast<Quant_index>(pow2int(z_coor_bits - 2))
+    };
+    const char* axis_names[3] = {"X", "Y", "Z"};
+    
+    const std::size_t block_size = 1024;
+    std::vector<double> coords[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        coords[axis].resize(block_size);
+    }
+    
+    for (std::size_t begin = 0; begin < mesh.size_of_vertices(); begin += block_size) {
+        std::size_t cnt = std::min(block_size, mesh.size_of_vertices() - begin);
+        for (std::size_t i = 0; i < cnt; ++i) {
+            const Point& p = mesh.point(begin + i);
+            coords[0][i] = p.x();
+            coords[1][i] = p.y();
+            coords[2][i] = p.z();
         }
         
-        // z coordinate
-        double point_z = SPL::signum(p.z()) * std::floor(std::abs(p.z()) / step_size.z() + 0.5);
-        if (point_z > std::numeric_limits<Quant_index>::max()) {
-            std::cerr << "ERROR: Z coordinate quantization index overflow!\n";
-            return false;
-        }
-        else {
-            if (std::abs(point_z) > max_z_val) {
-                std::cerr << "ERROR: Z coordinate quantization index overflow!\n";
+        for (int axis = 0; axis < 3; ++axis) {
+            if (!quantize_coordinates(coords[axis].data(), cnt, steps[axis], max_vals[axis], 
+                                      quant_points.data(axis) + begin)) {
+                std::cerr << "ERROR: " << axis_names[axis] << " coordinate quantization index overflow!\n";
                 return false;
             }
-            else {
-                p_z = static_cast<Quant_index>(point_z);
-            }
         }
-        
-        iter -> point() = Point(p_x, p_y, p_z);
     }
     
     // Check for duplicated vertices after quantization
-    std::set<Point> mesh_vertices;
-    for (auto vit = polyMesh.vertices_begin(); vit != polyMesh.vertices_end(); ++vit) {
-        Point p = vit -> point();
-        if (mesh_vertices.find(p) != mesh_vertices.end()) {
-            std::cerr << "ERROR: The quantized mesh contains duplicated vertices!\n";
-            exit(1);
-        }
-        else {
-            mesh_vertices.insert(p);
-        }
+    std::vector<Corner_index> quant_remap;
+    if (find_duplicate_vertices(quant_points, quant_remap) != 0) {
+        std::cerr << "ERROR: The quantized mesh contains duplicated vertices!\n";
+        exit(1);
     }
 
+    // Initialize all edges' mark and links on the bounding loop
+    corner_mark.assign(mesh.size_of_corners(), 0);
+    s_gate.reset(mesh.size_of_corners());
+    prev_on_border.assign(mesh.size_of_corners(), null_corner);
+    next_on_border.assign(mesh.size_of_corners(), null_corner);
+
     // Initialize all border vertices' mark
-    for (auto hit = polyMesh.border_halfedges_begin(); hit != polyMesh.halfedges_end(); ++hit) {
-        (*hit).vertex() -> set_vertex_mark(2);
-        ++hit;  // Move to the border half edge
-    }
-    
-    // Initialize all halfedges' mark
-    for (auto hit = polyMesh.halfedges_begin(); hit != polyMesh.halfedges_end(); ++hit) {
-        (*hit).set_halfedge_mark(0);
+    for (Corner_index c = 0; c < static_cast<Corner_index>(mesh.size_of_corners()); ++c) {
+        if (mesh.is_border(c)) {
+            vertex_mark[mesh.vertex(Corner_table::prev(c))] = 2;
+            vertex_mark[mesh.vertex(Corner_table::next(c))] = 2;
+        }
     }
         
     // Mesh preprocessing for the closed triangle mesh
-    if (polyMesh.is_closed()) {
+    if (mesh.is_closed()) {
         // Get the initial gate for mesh compression
-        gate = polyMesh.halfedges_begin();
+        gate = 0;
         
         // Make sure the vertices_index is zero
         assert(vertices_index == 0);
         
-        // Update the vertex mark and index for the end vertex of the initial gate
-        Vertex_handle v1 = gate -> vertex();
-        v1 -> set_vertex_mark(1);
-        v1 -> set_index(vertices_index);
+        // Update the vertex mark for the end vertex of the initial gate
+        vertex_mark[mesh.vertex(Corner_table::prev(gate))] = 1;
         
-        // Update the vertex mark and index for the start vertex of the initial gate
-        Vertex_handle v2 = gate -> opposite() -> vertex();
-        v2 -> set_vertex_mark(1);
+        // Update the vertex mark for the start vertex of the initial gate
+        vertex_mark[mesh.vertex(Corner_table::next(gate))] = 1;
         ++vertices_index;
-        v2 -> set_index(vertices_index);
         
-        // Update the .N and .P relationship for the gate
-        gate -> set_prev_on_border(gate -> opposite());
-        gate -> set_next_on_border(gate -> opposite());
+        // Update the .N and .P relationship for the gate. The initial bounding 
+        // loop is formed by the gate and its opposite edge
+        Corner_index gate_o = mesh.opposite(gate);
+        prev_on_border[gate] = gate_o;
+        next_on_border[gate] = gate_o;
+        prev_on_border[gate_o] = gate;
+        next_on_border[gate_o] = gate;
         
-        // update the halfedge mark for the initial gate
-        gate -> set_halfedge_mark(1);
+        // update the edge mark for the initial bounding loop
+        corner_mark[gate] = 1;
+        corner_mark[gate_o] = 1;
         
         // Make sure the vertices_index is 1 after the gate initialization
         assert(vertices_index == 1);
@@ -869,10 +560,12 @@ bool Encoder::preprocessing(){
     }
     
     // Resize the history vector to the No. of triangles in the mesh
-    history_vec.resize(polyMesh.size_of_facets());
+    history_vec.resize(mesh.size_of_facets());
 
     // Geometry processing the start vertex of the initial gate
-    Point c = gate -> opposite() -> vertex() -> point();
+    Corner_index va = mesh.vertex(Corner_table::next(gate));
+    Corner_index vb = mesh.vertex(Corner_table::prev(gate));
+    Quant_point c = quant_points[va];
     
     // // Print the original points and its corresponding predicted position
     // std::clog << "First point to predict \n";
@@ -898,17 +591,18 @@ bool Encoder::preprocessing(){
     }    
     
     // Update the vertex's flag
-    Vertex_handle vc = gate -> opposite() -> vertex();
-    (*vc).set_flag(true);
+    vertex_flag[va] = true;
+    coding_order.push_back(va);
     
     // Geometry processing the end vertex of the initial gate
-    Point a = gate -> opposite() -> vertex() -> point();
-    c = gate -> vertex() -> point();
+    Quant_point a = quant_points[va];
+    c = quant_points[vb];
     
     // Get the integer difference between the actual and predicted position
-    Quant_index x = c.x() - a.x();
-    Quant_index y = c.y() - a.y();
-    Quant_index z = c.z() - a.z();
+    Quant_point error = c - a;
+    Quant_index x = error.x();
+    Quant_index y = error.y();
+    Quant_index z = error.z();
     
     // // Print the original points and its corresponding predicted position
     // std::clog << "Second point to predict \n";
@@ -934,8 +628,8 @@ bool Encoder::preprocessing(){
     } 
     
     // Update the third vertex's flag
-    vc = gate -> vertex();
-    (*vc).set_flag(true);
+    vertex_flag[vb] = true;
+    coding_order.push_back(vb);
     
     return true;
 }
@@ -947,102 +641,56 @@ Description:
     Detect the boundary of the mesh (longest bounding loop) 
 *******************************************************************************/
 void Encoder::boundary_detection() {
-    // Initialize border_vec vector and loop_sizes vector
-    std::vector<Halfedge_handle> border_vec;
+    // All border edges (in loop order) and the size of each loop
+    std::vector<Corner_index> border_vec;
     std::vector<int> loop_sizes;
     
     // Get the number of border loops from the mesh
-    numBorderLoops = getBorderLoops<Polyhedron, std::back_insert_iterator<std::vector<Halfedge_handle>>, 
-    std::back_insert_iterator<std::vector<int>>>(polyMesh, std::back_inserter(border_vec),std::back_inserter(loop_sizes));
-    
-    // Initialize boundary length
-    int boundary_len = 0;
-    
-    // Mesh contains only one bounding loop
-    if(numBorderLoops == 1) {
-        // Get the initial gate for compression
-        gate = border_vec[0] -> opposite();
-        boundary_len = loop_sizes[0];
+    border_vec.reserve(mesh.size_of_border_edges());
+    numBorderLoops = getBorderLoops<std::back_insert_iterator<std::vector<Corner_index>>, 
+    std::back_insert_iterator<std::vector<int>>>(mesh, std::back_inserter(border_vec),std::back_inserter(loop_sizes));
+    
+    // The first edge of each loop in border_vec
+    std::vector<std::size_t> loop_begin(numBorderLoops + 1, 0);
+    for (int i = 0; i < numBorderLoops; ++i) {
+        loop_begin[i + 1] = loop_begin[i] + loop_sizes[i];
     }
     
-    // Mesh contains more than one bounding loop
-    else {
-        int loop_id = 0;
-        boundary_len = loop_sizes[loop_id];
-    
-        // Find the longest boundary loop from boundary vector
-        for (auto it = loop_sizes.begin(); it != loop_sizes.end(); ++it) {
-            if (*it > boundary_len) {
-                boundary_len = *it;
-                loop_id = it - loop_sizes.begin();
-            }
+    // Find the longest boundary loop, the first one if there are several
+    int loop_id = 0;
+    for (int i = 1; i < numBorderLoops; ++i) {
+        if (loop_sizes[i] > loop_sizes[loop_id]) {
+            loop_id = i;
         }
-        
-        // Get the initial gate for compression
-        gate = border_vec[loop_id] -> opposite();
-        
-        // Make sure the boundary length we get is the largest length from vector
-        assert(boundary_len == loop_sizes[loop_id]);
-        
-        // Update the .N and .P relationship and mark for all holes
-        for(int i = 0; i < loop_sizes.size(); ++i) {
-            if (i == loop_id) {
-                continue;
-            }
-            
-            // Update the hole's start half edge
-            Halfedge_handle hole_start = border_vec[i];
-            hole_start -> opposite() -> set_halfedge_mark(2);
-            hole_start -> opposite() -> set_prev_on_border(hole_start -> next() -> opposite());
-            hole_start -> opposite() -> set_next_on_border(hole_start -> prev() -> opposite());
+    }
+    int boundary_len = loop_sizes[loop_id];
+    
+    // Get the initial gate for compression
+    gate = border_vec[loop_begin[loop_id]];
+    
+    // Make sure initial gate is a border edge
+    assert(mesh.is_border(gate));
+    
+    // Update the .N and .P relationship and mark for all edges. The edge 
+    // following border_vec[k] in a loop is its .P edge
+    for (int i = 0; i < numBorderLoops; ++i) {
+        char mark = (i == loop_id) ? 1 : 2;
+        std::size_t begin = loop_begin[i], end = loop_begin[i + 1];
+        for (std::size_t k = begin; k < end; ++k) {
+            Corner_index border = border_vec[k];
+            Corner_index border_prev = border_vec[(k + 1 < end) ? k + 1 : begin];
+            corner_mark[border] = mark;
+            prev_on_border[border] = border_prev;
+            next_on_border[border_prev] = border;
             
-            // Update the rest hole's half edges
-            Halfedge_handle hole_next = hole_start -> next();
-            while (hole_next != hole_start) {
-                hole_next -> opposite() -> set_halfedge_mark(2);
-                hole_next -> opposite() -> set_prev_on_border(hole_next -> next() -> opposite());
-                hole_next -> opposite() -> set_next_on_border(hole_next -> prev() -> opposite());
-                
-                hole_next = hole_next -> next();
+            if (i == loop_id) {
+                vertex_mark[mesh.vertex(Corner_table::next(border))] = 1;
             }
         }
     }
     
-    // Make sure initial gate is not border halfedge
-    assert(!((*gate).is_border()));
-    
-    // Initialize index value for the boundary vertices
-    int index = boundary_len - 1;
-    
-    // Update the .N and .P relationship and mark for the start boundary halfedge
-    Halfedge_handle boundary_start = gate -> opposite();
-    gate -> set_halfedge_mark(1);
-    gate -> set_prev_on_border(boundary_start -> next() -> opposite());
-    gate -> set_next_on_border(boundary_start -> prev() -> opposite());
-    
-    boundary_start -> vertex() -> set_vertex_mark(1);
-    boundary_start -> vertex() -> set_index(index);
-    --index;
-    
-    // Update the .N and .P relationship and mark for the rest boundary halfedges
-    Halfedge_handle next_border = boundary_start -> next();
-    while (next_border != boundary_start) {
-        next_border -> opposite() -> set_halfedge_mark(1);
-        next_border -> opposite() -> set_prev_on_border(next_border -> next() -> opposite());
-        next_border -> opposite() -> set_next_on_border(next_border -> prev() -> opposite());
-        
-        next_border -> vertex() -> set_vertex_mark(1);
-        next_border -> vertex() -> set_index(index);
-        
-        next_border = next_border -> next();
-        --index;
-        
-        // Update the vertices index count
-        ++vertices_index;
-    }
-    
-    // Make sure the vertices_index is boundary_len - 1
-    assert(vertices_index == (boundary_len - 1));
+    // Update the vertices index count
+    vertices_index += boundary_len - 1;
 }
 
 
@@ -1055,32 +703,34 @@ Description:
 *******************************************************************************/
 bool Encoder::geometry_processing() {
     // Initialize the point a, b, and c
-    Point a = gate -> opposite() -> vertex() -> point();
-    Point b = gate -> vertex() -> point();
-    Point c = gate -> next() -> vertex() -> point();
+    Quant_point a = quant_points[mesh.vertex(Corner_table::next(gate))];
+    Quant_point b = quant_points[mesh.vertex(Corner_table::prev(gate))];
+    Quant_point c = quant_points[mesh.vertex(gate)];
     
-    // Get vertex handle for point c
-    Vertex_handle vc = gate -> next() -> vertex();
+    // Get vertex index for point c
+    Corner_index vc = mesh.vertex(gate);
     
     // Get the predict position
-    Point predict;
+    Quant_point predict;
     if (processed_cnt == 0) {
         // Geometry processing for the third vertex of the mesh
         // std::clog << "Geometry prediction without third vertex \n";
         predict = geometry_predict(&a, &b, nullptr);
     }
     else {
-        Point d = gate -> opposite() -> next() -> vertex() -> point();
+        assert(!mesh.is_border(gate));
+        Quant_point d = quant_points[mesh.vertex(mesh.opposite(gate))];
         predict = geometry_predict(&a, &b, &d);
     }
     // std::clog << "Calculated position: " << predict << "\n";
 
     // Geometry prediction for the third vertex of current triangle
-    if (!(*vc).get_flag()) {
+    if (!vertex_flag[vc]) {
         // Get the integer difference between the actual and predicted position
-        Quant_index x = c.x() - static_cast<Quant_index>(predict.x());
-        Quant_index y = c.y() - static_cast<Quant_index>(predict.y());
-        Quant_index z = c.z() - static_cast<Quant_index>(predict.z());
+        Quant_point error = c - predict;
+        Quant_index x = error.x();
+        Quant_index y = error.y();
+        Quant_index z = error.z();
         
         // // Print the original points and its corresponding predicted position
         // std::clog << "Input point: " << c << ", predicted position: " << x << " " << y << " " << z << "\n";
@@ -1105,7 +755,8 @@ bool Encoder::geometry_processing() {
         }
         
         // Update vertex's flag
-        (*vc).set_flag(true);
+        vertex_flag[vc] = true;
+        coding_order.push_back(vc);
     }
     
     return true;
@@ -1123,7 +774,7 @@ Triangle_type Encoder::tri_type_identify() {
     Triangle_type tri_type = I;
     
     // Get the third vertex mark value
-    int mark_value = gate -> next() -> vertex() -> get_vertex_mark();
+    int mark_value = vertex_mark[mesh.vertex(gate)];
     
     // Make sure the vertex mark is correct
     assert(mark_value == 0 || mark_value == 1 || mark_value == 2 || mark_value == 3);
@@ -1139,8 +790,8 @@ Triangle_type Encoder::tri_type_identify() {
     }
     
     else {
-        if (gate -> next() == gate -> next_on_border()) {
-            if (gate -> prev() == gate -> prev_on_border()) {
+        if (Corner_table::next(gate) == next_on_border[gate]) {
+            if (Corner_table::prev(gate) == prev_on_border[gate]) {
                 // v precedes and follows g
                 tri_type = E;
             }
@@ -1150,17 +801,20 @@ Triangle_type Encoder::tri_type_identify() {
             }
         }
         else {
-            if (gate -> prev() == gate -> prev_on_border()) {
+            if (Corner_table::prev(gate) == prev_on_border[gate]) {
                 // v immediately precedes g
                 tri_type = L;
             }
             else {
-                // //  v is else where on the boundary
-                if (mark_value == 3) {
-                    tri_type = H;
+                // //  v is else where on the boundary. The vertex where an S 
+                // type triangle splits the bounding loop is on both of the 
+                // sub-loops, so v is on the current bounding loop if an edge 
+                // of the loop ends at v, whatever its mark value is
+                if (find_gate_b(1) != null_corner) {
+                    tri_type = S;
                 }
                 else {
-                    tri_type = S;
+                    tri_type = H;
                 }
             }
         }
@@ -1176,29 +830,39 @@ Description:
     C type triangle processing function
 *******************************************************************************/
 void Encoder::process_c_type_triangle() {
+    // Corners that relate to the current gate
+    Corner_index g_n_o = mesh.opposite(Corner_table::next(gate));
+    Corner_index g_p_o = mesh.opposite(Corner_table::prev(gate));
+    Corner_index g_P = prev_on_border[gate];
+    Corner_index g_N = next_on_border[gate];
+    assert(g_n_o != null_corner && g_p_o != null_corner);
+    
     // Update the third vertex's index and mark
-    gate -> next() -> vertex() -> set_index(++vertices_index);
-    gate -> next() -> vertex() -> set_vertex_mark(1);
+    ++vertices_index;
+    vertex_mark[mesh.vertex(gate)] = 1;
+    
+    // The bounding loop grows by one edge
+    e_count -= 1;
     
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> prev() -> opposite() -> set_halfedge_mark(1);
-    gate -> next() -> opposite() -> set_halfedge_mark(1);
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[g_p_o] = 1;
+    corner_mark[g_n_o] = 1;
     
     // Fixed the first link: g.p.o.P=g.P; g.P.N=g.p.o;
-    gate -> prev() -> opposite() -> set_prev_on_border(gate -> prev_on_border());
-    gate -> prev_on_border() -> set_next_on_border(gate -> prev() -> opposite());
+    prev_on_border[g_p_o] = g_P;
+    next_on_border[g_P] = g_p_o;
     
     // Fixed the second link: g.p.o.N=g.n.o; g.n.o.P=g.p.o;
-    gate -> prev() -> opposite() -> set_next_on_border(gate -> next() -> opposite());
-    gate -> next() -> opposite() -> set_prev_on_border(gate -> prev() -> opposite());
+    next_on_border[g_p_o] = g_n_o;
+    prev_on_border[g_n_o] = g_p_o;
     
     // Fixed the third link: g.n.o.N=g.N; g.N.P=g.n.o 
-    gate -> next() -> opposite() -> set_next_on_border(gate -> next_on_border());
-    gate -> next_on_border() -> set_prev_on_border(gate -> next() -> opposite());
+    next_on_border[g_n_o] = g_N;
+    prev_on_border[g_N] = g_n_o;
     
     // Gate update
-    gate = gate -> next() -> opposite();
+    gate = g_n_o;
 }
 
 
@@ -1208,22 +872,22 @@ Description:
     E type triangle processing function
 *******************************************************************************/
 void Encoder::process_e_type_triangle() {
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> prev() -> set_halfedge_mark(0);
-    gate -> next() -> set_halfedge_mark(0);
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[Corner_table::prev(gate)] = 0;
+    corner_mark[Corner_table::next(gate)] = 0;
+    
+    // The last three edges of the bounding loop are removed
+    e_count += 3;
     
     // Pop the corresponding offset value for the normal S operation
     if (offset_vec.size() > affected_s_cnt) {
         offset_vec.pop_back();
+        open_s_vec.pop_back();
     }
     
     // Current sub mesh is compressed completely, set active gate to null
-#ifdef BUG
-    gate = nullptr;
-#else
-    gate = Halfedge_handle();
-#endif
+    gate = null_corner;
 }
 
 
@@ -1233,21 +897,31 @@ Description:
     L type triangle processing function
 *******************************************************************************/
 void Encoder::process_l_type_triangle() {
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> prev_on_border() -> set_halfedge_mark(0);
-    gate -> next() -> opposite() -> set_halfedge_mark(1);
+    // Corners that relate to the current gate
+    Corner_index g_n_o = mesh.opposite(Corner_table::next(gate));
+    Corner_index g_P = prev_on_border[gate];
+    Corner_index g_P_P = prev_on_border[g_P];
+    Corner_index g_N = next_on_border[gate];
+    assert(g_n_o != null_corner);
+    
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[g_P] = 0;
+    corner_mark[g_n_o] = 1;
+    
+    // The bounding loop shrinks by one edge
+    e_count += 1;
     
     // Fixed the first link: g.P.P.N=g.n.o; g.n.o.P=g.P.P; 
-    gate -> prev_on_border() -> prev_on_border() -> set_next_on_border(gate -> next() -> opposite());
-    gate -> next() -> opposite() -> set_prev_on_border(gate -> prev_on_border() -> prev_on_border());
+    next_on_border[g_P_P] = g_n_o;
+    prev_on_border[g_n_o] = g_P_P;
     
     // Fixed the second link: g.n.o.N=g.N; g.N.P=g.n.o;
-    gate -> next() -> opposite() -> set_next_on_border(gate -> next_on_border());
-    gate -> next_on_border() -> set_prev_on_border(gate -> next() -> opposite());
+    next_on_border[g_n_o] = g_N;
+    prev_on_border[g_N] = g_n_o;
     
     // Gate update
-    gate = gate -> next() -> opposite();
+    gate = g_n_o;
 }
 
 
@@ -1257,56 +931,156 @@ Description:
     R type triangle processing function
 *******************************************************************************/
 void Encoder::process_r_type_triangle() {
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> next_on_border() -> set_halfedge_mark(0);
-    gate -> prev() -> opposite() -> set_halfedge_mark(1);
+    // Corners that relate to the current gate
+    Corner_index g_p_o = mesh.opposite(Corner_table::prev(gate));
+    Corner_index g_N = next_on_border[gate];
+    Corner_index g_N_N = next_on_border[g_N];
+    Corner_index g_P = prev_on_border[gate];
+    assert(g_p_o != null_corner);
+    
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[g_N] = 0;
+    corner_mark[g_p_o] = 1;
+    
+    // The bounding loop shrinks by one edge
+    e_count += 1;
     
     // Fixed the first link: g.N.N.P=g.p.o; g.p.o.N=g.N.N; 
-    gate -> next_on_border() -> next_on_border() -> set_prev_on_border(gate -> prev() -> opposite());
-    gate -> prev() -> opposite() -> set_next_on_border(gate -> next_on_border() -> next_on_border());
+    prev_on_border[g_N_N] = g_p_o;
+    next_on_border[g_p_o] = g_N_N;
     
     // Fixed the second link: g.p.o.P=g.P; g.P.N=g.p.o;
-    gate -> prev() -> opposite() -> set_prev_on_border(gate -> prev_on_border());
-    gate -> prev_on_border() -> set_next_on_border(gate -> prev() -> opposite());
+    prev_on_border[g_p_o] = g_P;
+    next_on_border[g_P] = g_p_o;
     
     // Gate update
-    gate = gate -> prev() -> opposite();
+    gate = g_p_o;
 }
 
 
 /*******************************************************************************
-Function: process_s_type_triangle()
+Function: Corner_index find_gate_b(int mark_value);
 Description:
-    S type triangle processing function
+    Swings around the third vertex of the current triangle, starting from the 
+    edge g.n, until it finds the edge with the given mark value that ends at 
+    the third vertex. A border edge is swung over the hole to the border edge
+    on the other side, like the halfedge h -> opposite() -> prev() of a 
+    halfedge data structure. The swing stops when it is back at g.n.
 *******************************************************************************/
-void Encoder::process_s_type_triangle() {
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> prev() -> opposite() -> set_halfedge_mark(1);
-    gate -> next() -> opposite() -> set_halfedge_mark(1);
-    
+Corner_index Encoder::find_gate_b(int mark_value) const {
     // Initial candidate for gate_b
-    Halfedge_handle gate_b = gate -> next();
-    while(gate_b -> get_halfedge_mark() != 1) {
-        gate_b = gate_b -> opposite() -> prev();
-    }
+    Corner_index gate_b = Corner_table::next(gate);
+    do {
+        if (corner_mark[gate_b] == mark_value) {
+            return gate_b;
+        }
+        
+        if (mesh.is_border(gate_b)) {
+            gate_b = Corner_table::prev(mesh.border_next(gate_b));
+        }
+        else {
+            gate_b = Corner_table::prev(mesh.opposite(gate_b));
+        }
+    } while (gate_b != Corner_table::next(gate));
+    
+    return null_corner;
+}
+
+
+/*******************************************************************************
+Function: void link_split_loop(Corner_index gate_b);
+Description:
+    Updates the predecessor and successor relation on the bounding loop for 
+    the S, M and M' type triangle. The bounding loop is split (S) or merged 
+    (M and M') at the third vertex of the current triangle, gate_b is the 
+    edge on the loop (or on the hole) that ends at the third vertex.
+*******************************************************************************/
+void Encoder::link_split_loop(Corner_index gate_b) {
+    // Corners that relate to the current gate
+    Corner_index g_n_o = mesh.opposite(Corner_table::next(gate));
+    Corner_index g_p_o = mesh.opposite(Corner_table::prev(gate));
+    Corner_index g_P = prev_on_border[gate];
+    Corner_index g_N = next_on_border[gate];
+    Corner_index b_N = next_on_border[gate_b];
     
     // Fixed the first link: g.P.N=g.p.o; g.p.o.P=g.P; 
-    gate -> prev_on_border() -> set_next_on_border(gate -> prev() -> opposite());
-    gate -> prev() -> opposite() -> set_prev_on_border(gate -> prev_on_border());
+    next_on_border[g_P] = g_p_o;
+    prev_on_border[g_p_o] = g_P;
     
     // Fixed the second link: g.p.o.N=b.N; b.N.P=g.p.o; 
-    gate -> prev() -> opposite() -> set_next_on_border(gate_b -> next_on_border());
-    gate_b -> next_on_border() -> set_prev_on_border(gate -> prev() -> opposite());
+    next_on_border[g_p_o] = b_N;
+    prev_on_border[b_N] = g_p_o;
     
     // Fixed the third link: b.N=g.n.o; g.n.o.P=b; 
-    gate_b -> set_next_on_border(gate -> next() -> opposite());
-    gate -> next() -> opposite() -> set_prev_on_border(gate_b);
+    next_on_border[gate_b] = g_n_o;
+    prev_on_border[g_n_o] = gate_b;
     
     // Fixed the fourth link: g.n.o.N=g.N; g.N.P=g.n.o;
-    gate -> next() -> opposite() -> set_next_on_border(gate -> next_on_border());
-    gate -> next_on_border() -> set_prev_on_border(gate -> next() -> opposite());
+    next_on_border[g_n_o] = g_N;
+    prev_on_border[g_N] = g_n_o;
+}
+
+
+/*******************************************************************************
+Function: void resolve_s_offsets();
+Description:
+    The S operations after the last M' operation form a nested chain S_1, ..., 
+    S_m (the ones whose offset is still in offset_vec above affected_s_cnt). 
+    Since no M' operation happened inside their right side sub-mesh yet, the 
+    loops of the sub-mesh are only split and consumed, so the right side 
+    sub-loop length of S_k equals to the op-code count since S_k, plus the 
+    edges that are not consumed yet: the current bounding loop and the left 
+    side sub-loops of S_(k+1), ..., S_m:
+        length(S_k) = e_count - e_k + length(current) + sum(left(S_j), j > k)
+    The loops are walked once, the left side sub-loops are never walked again 
+    since their S operations are no longer open after the M' operation.
+*******************************************************************************/
+void Encoder::resolve_s_offsets() {
+    // Length of the current bounding loop
+    int loop_len = 1;
+    for (Corner_index c = next_on_border[gate]; c != gate; c = next_on_border[c]) {
+        ++loop_len;
+    }
+    
+    // Resolve from the innermost S operation outwards
+    int stacked_len = 0;
+    for (auto i = offset_vec.size(); i > affected_s_cnt; --i) {
+        int right_len = e_count - open_s_vec[i - 1].first + loop_len + stacked_len;
+        
+        // Subtract the 2 vertices of gate from the offset value
+        offset_vec[i - 1].second = right_len - 2;
+        
+        // Add the left side sub-loop of current S operation
+        Corner_index sub_gate = open_s_vec[i - 1].second;
+        stacked_len += 1;
+        for (Corner_index c = next_on_border[sub_gate]; c != sub_gate; c = next_on_border[c]) {
+            ++stacked_len;
+        }
+    }
+}
+
+
+/*******************************************************************************
+Function: process_s_type_triangle()
+Description:
+    S type triangle processing function
+*******************************************************************************/
+void Encoder::process_s_type_triangle() {
+    // Corners that relate to the current gate
+    Corner_index g_n_o = mesh.opposite(Corner_table::next(gate));
+    Corner_index g_p_o = mesh.opposite(Corner_table::prev(gate));
+    assert(g_n_o != null_corner && g_p_o != null_corner);
+    
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[g_p_o] = 1;
+    corner_mark[g_n_o] = 1;
+    
+    // Find gate_b and update the links on the bounding loop
+    Corner_index gate_b = find_gate_b(1);
+    assert(gate_b != null_corner);
+    link_split_loop(gate_b);
     
     // Update the skip S count for both M and M' type of triangle
     skip_m += 1;
@@ -1315,54 +1089,73 @@ void Encoder::process_s_type_triangle() {
     // Update S type triangle count
     s_cnt += 1;
     
-    // Calculate the offset value for current S operation
-    int offset_value = 1;
-    Halfedge_handle offset_gate = gate -> next() -> opposite() -> next_on_border();
-    while (offset_gate != gate -> next() -> opposite()) {
-        offset_value += 1;
-        offset_gate = offset_gate -> next_on_border();
+    // The two sub-loops have one more edge than the split bounding loop
+    e_count -= 1;
+    
+    // Calculate the offset value for current S operation. With the deferred 
+    // method, the value is left to be resolved by resolve_s_offsets() and it
+    // is only needed if the S operation is affected by an M' operation
+    int offset_value = 0;
+    if (offset_mode == S_offset_mode::walk) {
+        offset_value = 1;
+        Corner_index offset_gate = next_on_border[g_n_o];
+        while (offset_gate != g_n_o) {
+            offset_value += 1;
+            offset_gate = next_on_border[offset_gate];
+        }
+        
+        // Subtract the 2 vertices of gate from the offset value
+        offset_value -= 2;
     }
     
-    // Subtract the 2 vertices of gate from the offset value
-    offset_value -= 2;
-    
     // Add current offset value to the stack
     std::pair<int, int> offset_pair(s_cnt, offset_value);
     offset_vec.push_back(offset_pair);
+    open_s_vec.push_back(std::make_pair(e_count, g_p_o));
     
-    // Update the vertices and halfedges mark for the left side sub mesh
-    Halfedge_handle sub_gate = gate -> prev() -> opposite();
-    sub_gate -> set_halfedge_mark(3);
+    // Update the vertices and edges mark for the left side sub mesh
+    Corner_index sub_gate = g_p_o;
+    corner_mark[sub_gate] = 3;
     
-    Halfedge_handle next_border = sub_gate -> next_on_border();
+    Corner_index next_border = next_on_border[sub_gate];
     while (next_border != sub_gate) {
-        next_border -> set_halfedge_mark(3);
-        next_border -> vertex() -> set_vertex_mark(3);
-        next_border = next_border -> next_on_border();
+        corner_mark[next_border] = 3;
+        vertex_mark[mesh.vertex(Corner_table::prev(next_border))] = 3;
+        next_border = next_on_border[next_border];
     }
     
     // Store the gate for the left side sub mesh
-    assert(sub_gate -> get_halfedge_mark() == 3);
+    assert(corner_mark[sub_gate] == 3);
     s_gate.push(sub_gate);
     
-    // Compress the right side of sub mesh
-    gate = gate -> next() -> opposite();
-    compressing();
-    
+    // Compress the right side of sub mesh, the left side is resumed by 
+    // restore_s_gate() once the right side is finished
+    gate = g_n_o;
+}
+
+
+/*******************************************************************************
+Function: void restore_s_gate();
+Description:
+    Moves the active gate to the left side sub mesh of the last S type triangle
+    (the top of the s_gate stack), and marks its bounding loop as the current 
+    bounding loop again. The gate remains null if the stack is empty.
+*******************************************************************************/
+void Encoder::restore_s_gate() {
     // Compress the left side of sub mesh
     if (!s_gate.empty()) {
         gate = s_gate.top();
         s_gate.pop();
         
-        // Update the vertices and halfedges mark for the popped left side sub mesh
-        gate -> set_halfedge_mark(1);
-        gate -> vertex() -> set_vertex_mark(1);
+        // Update the vertices and edges mark for the popped left side sub mesh
+        corner_mark[gate] = 1;
+        vertex_mark[mesh.vertex(Corner_table::prev(gate))] = 1;
         
-        Halfedge_handle sub_border = gate -> next_on_border();
+        Corner_index sub_border = next_on_border[gate];
         while (sub_border != gate) {
-            sub_border -> set_halfedge_mark(1);
-            sub_border -> vertex() -> set_vertex_mark(1);
-            sub_border = sub_border -> next_on_border();
+            corner_mark[sub_border] = 1;
+            vertex_mark[mesh.vertex(Corner_table::prev(sub_border))] = 1;
+            sub_border = next_on_border[sub_border];
         }    
     }
 }
@@ -1374,49 +1167,43 @@ Description:
     M type triangle processing function
 *******************************************************************************/
 void Encoder::process_m_type_triangle() {
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> prev() -> opposite() -> set_halfedge_mark(1);
-    gate -> next() -> opposite() -> set_halfedge_mark(1);
+    // Corners that relate to the current gate
+    Corner_index g_n_o = mesh.opposite(Corner_table::next(gate));
+    Corner_index g_p_o = mesh.opposite(Corner_table::prev(gate));
+    assert(g_n_o != null_corner && g_p_o != null_corner);
+    
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[g_p_o] = 1;
+    corner_mark[g_n_o] = 1;
     
     // Initial candidate for gate_b
-    Halfedge_handle gate_b = gate -> next();
-    while(gate_b -> get_halfedge_mark() != 2) {
-        gate_b = gate_b -> opposite() -> prev();
-    }
+    Corner_index gate_b = find_gate_b(2);
+    assert(gate_b != null_corner);
 
     // Traversal of the new edge
+    Corner_index third_vertex = mesh.vertex(gate);
     int hole_len = 0;
     do {
         // Update the holes' boundary vertices index and mark
-        gate_b -> vertex() -> set_index(++vertices_index);
-        gate_b -> vertex() -> set_vertex_mark(1);
+        ++vertices_index;
+        vertex_mark[mesh.vertex(Corner_table::prev(gate_b))] = 1;
         
-        // Update halfedges' mark
-        gate_b -> set_halfedge_mark(1);
+        // Update edges' mark
+        corner_mark[gate_b] = 1;
         
         // Update the hole length
         hole_len += 1;
         
         // Move to next edge around hole
-        gate_b = gate_b -> next_on_border();
-    } while(gate_b -> vertex() != gate -> next() -> vertex());
-    
-    // Fixed the first link: g.P.N=g.p.o; g.p.o.P=g.P; 
-    gate -> prev_on_border() -> set_next_on_border(gate -> prev() -> opposite());
-    gate -> prev() -> opposite() -> set_prev_on_border(gate -> prev_on_border());
+        gate_b = next_on_border[gate_b];
+    } while(mesh.vertex(Corner_table::prev(gate_b)) != third_vertex);
     
-    // Fixed the second link: g.p.o.N=b.N; b.N.P=g.p.o; 
-    gate -> prev() -> opposite() -> set_next_on_border(gate_b -> next_on_border());
-    gate_b -> next_on_border() -> set_prev_on_border(gate -> prev() -> opposite());
+    // Update the links on the bounding loop
+    link_split_loop(gate_b);
     
-    // Fixed the third link: b.N=g.n.o; g.n.o.P=b; 
-    gate_b -> set_next_on_border(gate -> next() -> opposite());
-    gate -> next() -> opposite() -> set_prev_on_border(gate_b);
-    
-    // Fixed the fourth link: g.n.o.N=g.N; g.N.P=g.n.o;
-    gate -> next() -> opposite() -> set_next_on_border(gate -> next_on_border());
-    gate -> next_on_border() -> set_prev_on_border(gate -> next() -> opposite());
+    // The edges of the hole are merged into the bounding loop
+    e_count -= hole_len + 1;
     
     // Update the M table
     std::pair<int, int> m_item = std::make_pair(skip_m, hole_len);
@@ -1426,7 +1213,7 @@ void Encoder::process_m_type_triangle() {
     skip_m = 0;
     
     // Gate update
-    gate = gate -> next() -> opposite();
+    gate = g_n_o;
 }
 
 
@@ -1437,81 +1224,75 @@ Description:
     best guess, the pseudo-code is missing from the paper.
 *******************************************************************************/
 void Encoder::process_h_type_triangle() {
-    // Update halfedges' mark
-    gate -> set_halfedge_mark(0);
-    gate -> prev() -> opposite() -> set_halfedge_mark(1);
-    gate -> next() -> opposite() -> set_halfedge_mark(1);
+    // Corners that relate to the current gate
+    Corner_index g_n_o = mesh.opposite(Corner_table::next(gate));
+    Corner_index g_p_o = mesh.opposite(Corner_table::prev(gate));
+    assert(g_n_o != null_corner && g_p_o != null_corner);
+    
+    // Update edges' mark
+    corner_mark[gate] = 0;
+    corner_mark[g_p_o] = 1;
+    corner_mark[g_n_o] = 1;
+    
+    // Resolve the offset value of the affected S operations
+    if (offset_mode == S_offset_mode::deferred) {
+        resolve_s_offsets();
+    }
     
     // Initial candidate for gate_b
-    Halfedge_handle gate_b = gate -> next();
-    while(gate_b -> get_halfedge_mark() != 3) {
-        gate_b = gate_b -> opposite() -> prev();
-    }
+    Corner_index gate_b = find_gate_b(3);
+    assert(gate_b != null_corner);
     
-    // Update vertex and halfedge mark on the merging border loop
-    gate_b -> set_halfedge_mark(1);
-    gate_b -> vertex() -> set_vertex_mark(1);
+    // Update vertex and edge mark on the merging border loop
+    corner_mark[gate_b] = 1;
+    vertex_mark[mesh.vertex(Corner_table::prev(gate_b))] = 1;
     
-    Halfedge_handle merge_border = gate_b -> next_on_border();
+    Corner_index merge_border = next_on_border[gate_b];
     while (merge_border != gate_b) {
-        merge_border -> set_halfedge_mark(1);
-        merge_border -> vertex() -> set_vertex_mark(1);
+        corner_mark[merge_border] = 1;
+        vertex_mark[mesh.vertex(Corner_table::prev(merge_border))] = 1;
         
-        merge_border = merge_border -> next_on_border();
+        merge_border = next_on_border[merge_border];
     }
     
     // Initialize offset value for M' case
     Vertex_index position = 0, offset = 0;
     
     // Find the associate gate in the stack and remove
-    if (s_gate.find(gate_b) != s_gate.end()) {
+    if (s_gate.find(gate_b)) {
         // gate_b is the associate gate
-        My_findable_stack<Halfedge_handle>::Const_iterator pos_iter = s_gate.find(gate_b);
-        position = std::distance(s_gate.begin(), pos_iter);
+        position = s_gate.position(gate_b);
         
         // Erase the associate gate from stack
-        s_gate.erase(pos_iter);
+        s_gate.erase(gate_b);
     }
     else {
-        Halfedge_handle next_merge_border = gate_b -> next_on_border();
-        while (s_gate.find(next_merge_border) == s_gate.end()) {
-            // Current border halfedge is not the associate gate
-            next_merge_border = next_merge_border -> next_on_border();
+        Corner_index next_merge_border = next_on_border[gate_b];
+        while (!s_gate.find(next_merge_border)) {
+            // Current border edge is not the associate gate
+            next_merge_border = next_on_border[next_merge_border];
         }
         
         // Find the associate gate in the stack
-        My_findable_stack<Halfedge_handle>::Const_iterator pos_iter = s_gate.find(next_merge_border);
-        position = std::distance(s_gate.begin(), pos_iter);
+        Corner_index associate_gate = next_merge_border;
+        position = s_gate.position(associate_gate);
         
         // Update the offset value
         while (next_merge_border != gate_b) {
             ++offset;
-            next_merge_border = next_merge_border -> next_on_border();
+            next_merge_border = next_on_border[next_merge_border];
         }
         
         // Erase the associate gate from stack
-        s_gate.erase(pos_iter);
+        s_gate.erase(associate_gate);
     }
     
     // Update the H table
     Mesh_handle handle_item(position, offset, skip_h);
     h_table.push_back(handle_item);
     
-    // Fixed the first link: g.P.N=g.p.o; g.p.o.P=g.P; 
-    gate -> prev_on_border() -> set_next_on_border(gate -> prev() -> opposite());
-    gate -> prev() -> opposite() -> set_prev_on_border(gate -> prev_on_border());
-    
-    // Fixed the second link: g.p.o.N=b.N; b.N.P=g.p.o; 
-    gate -> prev() -> opposite() -> set_next_on_border(gate_b -> next_on_border());
-    gate_b -> next_on_border() -> set_prev_on_border(gate -> prev() -> opposite());
-    
-    // Fixed the third link: b.N=g.n.o; g.n.o.P=b; 
-    gate_b -> set_next_on_border(gate -> next() -> opposite());
-    gate -> next() -> opposite() -> set_prev_on_border(gate_b);
-    
-    // Fixed the fourth link: g.n.o.N=g.N; g.N.P=g.n.o;
-    gate -> next() -> opposite() -> set_next_on_border(gate -> next_on_border());
-    gate -> next_on_border() -> set_prev_on_border(gate -> next() -> opposite());
+    // Update the links on the bounding loop
+    link_split_loop(gate_b);
     
     // Update the skip S count
     skip_h = 0;
@@ -1520,30 +1301,35 @@ void Encoder::process_h_type_triangle() {
     affected_s_cnt = offset_vec.size();
     
     // Gate update
-    gate = gate -> next() -> opposite();
+    gate = g_n_o;
 }
 
 
 /*******************************************************************************
 Function: void compressing()
 Description:
-    Triangle mesh compression function. 
+    Triangle mesh compression function. The sub meshes created by S type 
+    triangles are compressed iteratively: the right side sub mesh is compressed
+    first, and the left side sub mesh of the last S type triangle is resumed 
+    from the s_gate stack whenever the current sub mesh is finished. So the 
+    nesting depth of S operations is not limited by the call stack.
 *******************************************************************************/
 void Encoder::compressing() {
-    // Initialize stop condition
-    bool e_case = false;
-    
-    do {
-        // Stop condition for compression recursive process
-#ifdef BUG
-        if (gate == nullptr) {
-            return;
-        }
-#else
-        if (gate == Halfedge_handle()) {
-            return;
+    // No. of S type triangles whose left side sub mesh is not resumed yet
+    Vertex_index open_s = 0;
+    
+    while (true) {
+        // Current sub mesh is finished
+        if (gate == null_corner) {
+            if (open_s == 0) {
+                return;
+            }
+            
+            // Resume the left side sub mesh of the last S type triangle
+            --open_s;
+            restore_s_gate();
+            continue;
         }
-#endif
         
         // Identify the triangle type and add to history vector
         Triangle_type tri_type = tri_type_identify();
@@ -1582,14 +1368,13 @@ void Encoder::compressing() {
                 break;
                 
             case E:
+                // No more triangle in current sub mesh, the gate is set to null
                 process_e_type_triangle();
-                
-                // No more triangle in current mesh, stop the compression
-                e_case = true;                
                 break;
                 
             case S:
                 process_s_type_triangle();
+                ++open_s;
                 break;
                 
             case M:
@@ -1601,8 +1386,7 @@ void Encoder::compressing() {
                 process_h_type_triangle();
                 break;
         }
-
-    } while (!e_case);
+    }
 }
 
 
@@ -1613,7 +1397,7 @@ Description:
 *******************************************************************************/
 bool Encoder::write_ebfile() {
     // Make sure the vertices_index is equals to No. of mesh vertices - 1
-    assert(vertices_index == (polyMesh.size_of_vertices() - 1));
+    assert(vertices_index == (mesh.size_of_vertices() - 1));
     
     // Update the hole information count
     unsigned int hole_cnt = 0;
@@ -1631,17 +1415,10 @@ bool Encoder::write_ebfile() {
     int code_series = code_series_determine(history_vec);
     assert(code_series == 1 || code_series == 2 || code_series == 3);
     
-    // Generate the binary history string
-    std::string history_string;
-    if(code_series == 1) {
-        write_history_code1(history_vec, history_string);
-    }
-    else if(code_series == 2) {
-        write_history_code2(history_vec, history_string);
-    }
-    else if(code_series == 3) {
-        write_history_code3(history_vec, history_string);
-    }
+    // Generate the packed binary history codewords
+    History_bit_writer history_bits;
+    encode_history(history_vec, code_series, history_bits);
+    history_bits.finish();
     
     // Update the offset information count
     unsigned int offset_cnt = 0;
@@ -1653,23 +1430,36 @@ bool Encoder::write_ebfile() {
     // Write the header part of the EB file
     //////////////////////////////////////////////////////////
     
+    // Every section starts at a byte boundary. The padding bits are not 
+    // counted by the bit stream, so each section is rounded up to whole bytes
+    section_offsets.assign(eb_sections_cnt, 0);
+    Vertex_index section_begin = 0;
+    Vertex_index section_bits = ofile_eb.getWriteCount();
+    auto next_section = [&](Eb_section section) {
+        Vertex_index bits = ofile_eb.getWriteCount();
+        section_begin += (bits - section_bits + 7) / 8;
+        section_bits = bits;
+        section_offsets[section] = section_begin;
+    };
+    
      // Signature
     unsigned int sig = 696610198;
     ofile_eb.putBits(0, redundant_bits);
     ofile_eb.putBits(sig, max_bits_to_put);
     
-    // code_series
+    // code_series and the geometry coder type
+    int coder_type = static_cast<int>(enc.get_coder());
     ofile_eb.putBits(0, redundant_bits);
-    ofile_eb.putBits(code_series, max_bits_to_put);
+    ofile_eb.putBits(code_series | (coder_type << code_series_bits), max_bits_to_put);
     
     // hist_str_len
-    assert(history_string.length() > 0);
-    Vertex_index hist_str_len = history_string.length();
+    assert(history_bits.size() > 0);
+    Vertex_index hist_str_len = history_bits.size();
     ofile_eb.putBits(0, redundant_bits);
     ofile_eb.putBits(hist_str_len, max_bits_to_put);
     
     // vertices_cnt
-    Vertex_index vertices_cnt = polyMesh.size_of_vertices();
+    Vertex_index vertices_cnt = mesh.size_of_vertices();
     ofile_eb.putBits(0, redundant_bits);
     ofile_eb.putBits(vertices_cnt, max_bits_to_put);
     
@@ -1721,6 +1511,7 @@ bool Encoder::write_ebfile() {
     
     // Byte alignment for header part
     ofile_eb.align();
+    next_section(eb_history);
     
     // // Print out the header information
     // std::clog << "==========================================\n";
@@ -1743,13 +1534,19 @@ bool Encoder::write_ebfile() {
     //////////////////////////////////////////////////////////
     
     
-    for (char& c : history_string) {
-        int bit = c - '0';
-        ofile_eb.putBits(bit, 1);
+    // The whole bytes first, then the bits left in the last byte
+    const std::vector<std::uint8_t>& history_bytes = history_bits.bytes();
+    Vertex_index whole_bytes = hist_str_len / 8;
+    ofile_eb.putBytes(history_bytes.data(), whole_bytes);
+    
+    int last_bits = hist_str_len % 8;
+    if (last_bits != 0) {
+        ofile_eb.putBits(history_bytes[whole_bytes] >> (8 - last_bits), last_bits);
     }
 
     // Byte alignment for connectivity part
     ofile_eb.align();
+    next_section(eb_m_table);
     
     
     //////////////////////////////////////////////////////////
@@ -1770,6 +1567,7 @@ bool Encoder::write_ebfile() {
         // Byte alignment
         ofile_eb.align();
     }
+    next_section(eb_h_table);
     
     
     //////////////////////////////////////////////////////////
@@ -1794,6 +1592,7 @@ bool Encoder::write_ebfile() {
         // Byte alignment 
         ofile_eb.align();
     }
+    next_section(eb_offset_table);
     
     
     //////////////////////////////////////////////////////////
@@ -1814,21 +1613,16 @@ bool Encoder::write_ebfile() {
         // Byte alignment 
         ofile_eb.align();
     }
+    next_section(eb_geometry);
     
     
     ///////////////////////////////////////////////////////////
     // Write the geometry part of the EB file
     ///////////////////////////////////////////////////////////
 
-    for (char& c : geom_out.str()) {
-        int geom_char = c;
-        
-        for (int i = 0; i < 8; ++i) {
-            // Get current bit for encoding (From MSB to LSB)
-            int bit = (geom_char >> (8 - i - 1)) & 1; 
-            ofile_eb.putBits(bit, 1);
-        }
-    }
+    const std::string geom_str = geom_out.str();
+    ofile_eb.putBytes(reinterpret_cast<const unsigned char*>(geom_str.data()), 
+                      geom_str.length());
     
     // Flush any pending output
     ofile_eb.flush();
@@ -1844,7 +1638,7 @@ bool Encoder::write_ebfile() {
     ///////////////////////////////////////////////////////////
     
     // Geometry data size in byte
-    geom_str_len = geom_out.str().length();
+    geom_str_len = geom_str.length();
     
     // Total compressed data size in bits
     conn_str_len = hist_str_len + 2 * hole_cnt * 32 + 3 * handle_cnt * 32 + 2 * offset_cnt * 32;
@@ -1866,12 +1660,9 @@ bool Encoder::vertex_coordinate_encode(Quant_index predict_error, int bit_cnt, i
     // check if input coordinate is valid
     assert(coordinate == 0 || coordinate == 1 || coordinate == 2);
     
-    // Total context for each coordinate
-    int x_contexts = Context_selector::total_contexts(x_coor_bits, f_levels);
-    int y_contexts = Context_selector::total_contexts(y_coor_bits, f_levels);
-    
-    // Initialize the context 
-    Context_selector context(bit_cnt, f_levels); 
+    // The binarization tree of the coordinate
+    const Context_selector& context = coor_context[coordinate];
+    assert(bit_cnt == context.bits());
     
     // Encode the sign bit using bypass mode 
     // Use bit = 1 to represents both zero and positive value
@@ -1891,43 +1682,29 @@ bool Encoder::vertex_coordinate_encode(Quant_index predict_error, int bit_cnt, i
     }
     
     // Encode the value part using regular mode 
+    Quant_index value = std::abs(predict_error);
+    int state = context.root();
     for (int i = 0; i < bit_cnt; ++i) {
         // Get current bit for encoding (From MSB to LSB)
-        int bit = (std::abs(predict_error) >> (bit_cnt - i - 1)) & 1; 
+        int bit = (value >> (bit_cnt - i - 1)) & 1; 
         
-        int context_id = context.get_context();
-        int retVal;
-        if(context_id == -1) {
-            retVal = enc.encodeBypass(bit);
-        }
-        else {
-            if (coordinate == 0) {
-                // Encode x coordinate
-                retVal = enc.encodeRegular(context_id, bit);
-            }
-            else if (coordinate == 1) {
-                // Encode x coordinate
-                int y_id = context_id + x_contexts;
-                retVal = enc.encodeRegular(y_id, bit);
-            }
-            else if (coordinate == 2) {
-                // Encode x coordinate
-                int z_id = context_id + x_contexts + y_contexts;
-                retVal = enc.encodeRegular(z_id, bit);
+        int context_id = context.get_context(state);
+        if (context_id == -1) {
+            // The remaining bits are all coded in bypass mode
+            if (enc.encodeBypassBits(value, bit_cnt - i)) {
+                std::cerr << "ERROR: Encode bypass failed\n";
+                return false;
             }
+            break;
         }
         
-        if (retVal) {
+        if (enc.encodeRegular(context_id, bit)) {
             std::cerr << "ERROR: Encode regular failed\n";
             return false;
         }
         
         // Update context id for next bit
-        bool enc_bit = context.encode_bit(bit);
-        if (!enc_bit) {
-            std::cerr << "ERROR: Update context id failed\n";
-            return false;
-        }
+        state = context.next(state, bit);
     }
     
     return true;
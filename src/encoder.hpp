@@ -7,8 +7,14 @@
 #define Encoder_hpp
 
 #include "Utility.hpp"
+#include "Corner_table.hpp"
+#include "Duplicate_vertices.hpp"
+#include "Union_find.hpp"
+#include "Quantization.hpp"
 #include "My_stack.hpp"
 #include "Context_selector.hpp"
+#include "History_codec.hpp"
+#include "Component_container.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -19,157 +25,32 @@
 #include <cstdlib>
 #include <list>
 #include <algorithm>
+#include <memory>
 #include <unistd.h>
 #include <SPL/bitStream.hpp>
-#include <CGAL/Polyhedron_3.h>
-#include <CGAL/IO/Polyhedron_iostream.h>
-
-
-//////////////////////////////////////////////////////////
-// Class inheritance from the CGAL library
-//////////////////////////////////////////////////////////
-
-/*******************************************************************************
-Class: My_Vertex
-Description:
-    A vertex type to be used with Polyhedron_3 class that includes some 
-    self defined information. Two elements are added to the original vertex 
-    type: vertex index and vertex mark. Mark value is used for triangle type 
-    distinguish, index value is used for geometry prediction.
-*******************************************************************************/
-template <class Refs, class Traits, class P>
-class My_Vertex : public CGAL::HalfedgeDS_vertex_base<Refs, Traits, P> {
-public:
-    // Constructor
-	My_Vertex() : CGAL::HalfedgeDS_vertex_base<Refs, Traits, P>(),
-	  mark(0), index(0), prediction(false) {}
-    My_Vertex(const Kernel::Point_3& p) : 
-        CGAL::HalfedgeDS_vertex_base<Refs, Traits, P>(p),
-		mark(0), index(0), prediction(false) {}
-    
-    // Get current vertex mark
-	int get_vertex_mark() const;
-    
-    // Set current vertex mark
-    void set_vertex_mark(int mark_value);
-    
-    // Get current vertex index
-    Vertex_index get_index() const;
-    
-    // Set current vertex index
-    void set_index(Vertex_index index_value);
-    
-    // Get current vertex prediction flag
-	bool get_flag() const;
-    
-    // Set current vertex prediction flag
-    void set_flag(bool flag);
-
-    
-private:    
-    // The mark value of the vertex
-    int mark; 
-    
-    // The index of the vertex
-    Vertex_index index;
-    
-    // A flag shows whether the vertex has been predicted or not
-    bool prediction;
-};
-
-
-/*******************************************************************************
-Class: My_Halfedge
-Description:
-    A halfedge type to be used with Polyhedron_3 class that includes some 
-    self defined information. Mark value is added to the halfedge class, it is 
-    used to indicate whether the current halfedge is on the bounding loop. 
-    Two halfedge handle members are added to the class, they are used to 
-    represent the predecessor and successor halfedge on the bounding loop.
-*******************************************************************************/
-template < class Refs, class TP, class TV, class TF>
-class My_Halfedge : public CGAL::HalfedgeDS_halfedge_base<Refs, TP, TV, TF> {
-public:
-    typedef typename Refs::Halfedge_handle Halfedge_handle;
-    
-    // Constructor
-	My_Halfedge() : CGAL::HalfedgeDS_halfedge_base<Refs, TP, TV, TF>(),
-	  mark(0), prev_halfedge_on_border(), next_halfedge_on_border() {}
-    
-    // Get the current halfedge mark
-	int get_halfedge_mark() const;
-    
-    // Set the current halfedge mark
-    void set_halfedge_mark(int mark_value);
-    
-    // Get the previous halfedge on border
-	Halfedge_handle prev_on_border() const;
-    
-    // Get the next halfedge on border
-	Halfedge_handle next_on_border() const;
-    
-    // Set the previous halfedge on border
-    void set_prev_on_border(Halfedge_handle prev);
-    
-    // Set the next halfedge on border
-    void set_next_on_border(Halfedge_handle next);
-
-    
-private:
-    // The mark value of the vertex
-    int mark; 
-    
-    // The previous halfedge on border
-    Halfedge_handle prev_halfedge_on_border;
-
-    // The next halfedge on border
-    Halfedge_handle next_halfedge_on_border;
-};
-
-
-/*******************************************************************************
-Class: MyItems
-Description:
-    An items type to be used with Polyhedron_3 class that makes use of the 
-    above My_Vertex and My_Halfedge type
-*******************************************************************************/
-struct MyItems : public CGAL::Polyhedron_items_3 {
-	template <class Refs, class Traits>
-	struct Vertex_wrapper {
-		typedef My_Vertex<Refs, CGAL::Tag_true, typename Traits::Point_3> Vertex;
-	};
-    
-    template < class Refs, class Traits>
-    struct Halfedge_wrapper {
-        typedef My_Halfedge<Refs, CGAL::Tag_true, CGAL::Tag_true, CGAL::Tag_true> Halfedge;
-    };
-};
-
-// The polyhedron types
-typedef CGAL::Polyhedron_3<Kernel, MyItems> Polyhedron;
 
 
 /*******************************************************************************
 Function: getBorderLoops()
 Description:
-    The function finds all of the border loops in the polyhedron mesh. For each 
-    border loop that is found, one representative border halfedge from the loop 
-    is written to the iterator halfedgeIter and the loop size is written to the 
-    iterator sizeIter.
-    
-Preconditions:
-    The border must be normalized
+    The function finds all of the border loops in the mesh. For each border 
+    loop that is found, all of its border edges (corners whose opposite corner 
+    is null) are written to the iterator cornerIter in the loop order: the 
+    first edge is the border edge with the smallest index on the loop, and 
+    each following edge is the border_prev() of the previous one. The loop 
+    size is written to the iterator sizeIter. The loops are ordered by their 
+    first edge. The running time is linear in the size of the mesh.
     
 Parameters:
-    mesh: The polyhedron mesh
-    halfedgeIter: An iterator for writing each representative halfedge
+    mesh: The corner table mesh
+    cornerIter: An iterator for writing the border edges of each loop
     sizeIter: An iterator for writing the size of each loop
 
 Return:
     int: Number of border loops
 *******************************************************************************/
-template <class P, class I1, class I2>
-int getBorderLoops(const P& polyMesh, I1 halfedgeIter, I2 sizeIter);
+template <class I1, class I2>
+int getBorderLoops(const Corner_table& mesh, I1 cornerIter, I2 sizeIter);
 
 
 /*******************************************************************************
@@ -177,19 +58,39 @@ Function: getConnectedComponents()
 Description:
     The function determines the connected components of the mesh. (Vertices are 
     in the same connected component if they are connected by a path consisting 
-    of one or more edges.) For each connected component, a handle corresponding 
-    to a single representative vertex in the component is written to the output 
-    iterator vertexIter.
+    of one or more edges.) For each connected component, the index of a single 
+    representative vertex in the component (its smallest vertex index) is 
+    written to the output iterator vertexIter. The representatives are written 
+    in increasing order.
 
 Parameters:
-    mesh: The polyhedron mesh
-    vertexIter: An output iterator for writing vertex handles
+    mesh: The corner table mesh
+    vertexIter: An output iterator for writing vertex indices
+    threads_cnt: No. of threads used, 0 means the No. of hardware threads
 
 Return:
     int: Number of connected components
 *******************************************************************************/
-template <class P, class I>
-int getConnectedComponents(const P& polyMesh, I vertexIter);
+template <class I>
+int getConnectedComponents(const Corner_table& mesh, I vertexIter, unsigned threads_cnt = 1);
+
+
+/*******************************************************************************
+Enum: S_offset_mode
+Description:
+    The method used to calculate the offset value of each S operation. 
+    walk: the offset is found by walking around the right side sub-loop right 
+          after the split, which costs O(loop length) for every S operation.
+    deferred: the offset is derived from the op-code counts (the same counting 
+          rule as the decoder), and only resolved for the S operations that 
+          are still open when an M' operation is met. The total cost is linear 
+          in the size of the mesh.
+    Both methods produce the same offset values.
+*******************************************************************************/
+enum class S_offset_mode {
+    walk,
+    deferred
+};
 
 
 /*******************************************************************************
@@ -202,29 +103,38 @@ Description:
     and generates the final EB file. The output EB file is written to the given 
     output stream.
     
+    The input mesh is never copied. It is either moved into the Encoder 
+    (the rvalue and std::unique_ptr constructors), or only viewed (the const 
+    reference constructor), in which case the caller must keep the mesh alive 
+    and unchanged until the Encoder is destroyed. The mesh is not modified, 
+    the quantized vertices are stored by the Encoder.
+    
 Preconditions:
-    The input polygon mesh must in the triangle type
+    The input mesh must be a manifold triangle mesh stored in a Corner_table
 *******************************************************************************/
 class Encoder {
 public:
-    // Typedef for halfedge and vertex
-    typedef Polyhedron::Halfedge_handle Halfedge_handle;
-    typedef Polyhedron::Halfedge_iterator Halfedge_iterator;
-    typedef Polyhedron::Halfedge_const_iterator Halfedge_const_iterator;
-    typedef Polyhedron::Vertex_handle Vertex_handle;
-    typedef Polyhedron::Vertex_const_handle Vertex_const_handle;
-    typedef Polyhedron::Vertex_iterator Vertex_iterator;
-    typedef Polyhedron::Vertex_const_iterator Vertex_const_iterator;
-
-    // A constructor create a Encoder object with given parameters
+    // A constructor create a Encoder object which views the given mesh
     // Parameters: 
-    //      mesh: Input triangle mesh
+    //      mesh: Input triangle mesh, which must outlive the Encoder
     //      ofile: EB file output stream
     //      quan_size: Quantization step size
     //      x_bit: No. of bits to encode x coordinate
     //      y_bit: No. of bits to encode y coordinate
     //      z_bit: No. of bits to encode z coordinate
-    Encoder(Polyhedron mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit);
+    Encoder(const Corner_table& mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit);
+    
+    // A constructor create a Encoder object which takes over the given mesh
+    // Parameters: 
+    //      mesh: Input triangle mesh, which is moved into the Encoder
+    //      ofile, quan_size, x_bit, y_bit, z_bit: The same as above
+    Encoder(Corner_table&& mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit);
+    
+    // A constructor create a Encoder object which takes over the given mesh
+    // Parameters: 
+    //      mesh: Input triangle mesh (must not be null)
+    //      ofile, quan_size, x_bit, y_bit, z_bit: The same as above
+    Encoder(std::unique_ptr<Corner_table> mesh, std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit);
     
     // Destructor
     ~Encoder();
@@ -249,37 +159,38 @@ public:
     //      The quantization step size used in the calculation
     Point get_quan_step_size();
     
+    // Gets the position of each section of the EB stream, see Eb_section
+    // Returns: 
+    //      The byte offset of each section from the beginning of the EB stream
+    std::vector<Vertex_index> get_section_offsets();
+    
+    // Gets the vertices in the order their coordinates are coded, which is 
+    // the same order as Decoder::get_coding_order()
+    // Returns: 
+    //      The mesh vertex of each coded position
+    const std::vector<Corner_index>& get_coding_order() const;
     
-private: 
-    // Binary history string generation function. The codeword from code series 
-    // 1 of King's 3.67V bit paper is used
+    // Selects the S operation offset calculation method. The deferred method 
+    // is used by default
     // Parameters: 
-    //      hist_vec: The op-code sequence vector, stores all the detected 
-    //                triangle type
-    //      binary_string: The binary op-code string use the codeword from 
-    //                     code series 1 
-    void write_history_code1(const std::vector<Triangle_type>& hist_vec, 
-                                    std::string& binary_string);
+    //      mode: The offset calculation method
+    void set_s_offset_mode(S_offset_mode mode);
     
-    // Binary history string generation function. The codeword from code series 
-    // 2 of King's 3.67V bit paper is used
+    // Selects the binary arithmetic coder of the geometry part. The SPL coder 
+    // is used by default. Must be called before mesh_compression()
     // Parameters: 
-    //      hist_vec: The op-code sequence vector, stores all the detected 
-    //                triangle type
-    //      binary_string: The binary op-code string use the codeword from 
-    //                     code series 2
-    void write_history_code2(const std::vector<Triangle_type>& hist_vec, 
-                                    std::string& binary_string);
+    //      type: The coder type
+    void set_geometry_coder(Bin_coder_type type);
+    
     
-    // Binary history string generation function. The codeword from code series 
-    // 3 of King's 3.67V bit paper is used
+private: 
+    // The constructor that all public constructors delegate to
     // Parameters: 
-    //      hist_vec: The op-code sequence vector, stores all the detected 
-    //                triangle type
-    //      binary_string: The binary op-code string use the codeword from 
-    //                     code series 3
-    void write_history_code3(const std::vector<Triangle_type>& hist_vec, 
-                                    std::string& binary_string);
+    //      view: The viewed mesh, or nullptr if the mesh is owned
+    //      owned: The owned mesh, or nullptr if the mesh is viewed
+    //      ofile, quan_size, x_bit, y_bit, z_bit: The same as above
+    Encoder(const Corner_table* view, std::unique_ptr<const Corner_table> owned, 
+            std::ostream& ofile, Point quan_size, int x_bit, int y_bit, int z_bit);
     
     // Code series determine function. This function decides codeword from which 
     // code series is used in the binary history string
@@ -338,11 +249,38 @@ private:
     // loop. The active gate is also updates to the given position
     void process_r_type_triangle();
     
+    // Finds the edge gate_b for the S, M and M' type triangle. gate_b is the
+    // edge on the bounding loop (or on the hole) that ends at the third vertex
+    // of the current triangle
+    // Parameters:
+    //      mark_value: The mark value of the edge to be found
+    // Returns:
+    //      The corner of the found edge, null_corner if no edge with the mark
+    //      value ends at the third vertex
+    Corner_index find_gate_b(int mark_value) const;
+
+    // Updates the predecessor and successor relation on the bounding loop for
+    // the S, M and M' type triangle
+    // Parameters:
+    //      gate_b: The edge on the bounding loop that ends at the third vertex
+    void link_split_loop(Corner_index gate_b);
+
+    // Resolves the offset value of the S operations that are still open (the
+    // ones after the last M' operation whose right side sub-mesh is not 
+    // finished yet) with the deferred method. The function must be called 
+    // before the current M' type triangle updates the bounding loop
+    void resolve_s_offsets();
+
     // S type triangle processing function. It updates vertices' and halfedges' 
     // mark, updates predecessor and successor relation on the current bounding 
     // loop. The active gate is also updates to the given position
     void process_s_type_triangle();
     
+    // Resumes the left side sub mesh of the last S type triangle once its 
+    // right side sub mesh is finished. The active gate is updated to the gate
+    // popped from the s_gate stack
+    void restore_s_gate();
+    
     // M' type triangle processing function. It updates vertices' and halfedges' 
     // mark, updates predecessor and successor relation on the current bounding 
     // loop. The active gate is also updates to the given position
@@ -374,11 +312,39 @@ private:
     bool write_ebfile();
     
     
+    // The input triangle mesh owned by the Encoder (null in the view mode)
+    std::unique_ptr<const Corner_table> owned_mesh;
+    
     // Input triangle mesh
-    Polyhedron polyMesh;
+    const Corner_table& mesh;
+    
+    // The quantized vertices, the coordinates are the quantization indices
+    Quant_point_array quant_points;
+    
+    // The active gate (the corner whose edge the compression procedure works 
+    // with). The gate is set to null_corner when the sub mesh is finished
+    Corner_index gate;
     
-    // The active gate (a halfedge that compression procedure works with)
-    Halfedge_handle gate;
+    // The mark value of each vertex. Mark value is used for triangle type 
+    // distinguish: 0 (not visited), 1 (on the bounding loop), 2 (on the 
+    // boundary of a hole), 3 (on a bounding loop stored by S operation)
+    std::vector<char> vertex_mark;
+    
+    // A flag for each vertex shows whether the vertex has been predicted or not
+    std::vector<char> vertex_flag;
+    
+    // The vertices in the order their coordinates are coded
+    std::vector<Corner_index> coding_order;
+    
+    // The mark value of each corner's edge. It indicates whether the edge is 
+    // on the bounding loop, uses the same mark values as the vertex
+    std::vector<char> corner_mark;
+    
+    // The previous edge on the bounding loop of each corner's edge
+    std::vector<Corner_index> prev_on_border;
+    
+    // The next edge on the bounding loop of each corner's edge
+    std::vector<Corner_index> next_on_border;
     
     // The quantization step size
     Point step_size;
@@ -402,8 +368,8 @@ private:
     std::vector<Mesh_handle> h_table;
     
     // A findable stack stores the active gate of the left side sub-mesh of each
-    // S type triangle
-    My_findable_stack<Halfedge_handle> s_gate;
+    // S type triangle. It is indexed by corner, so finding a gate is O(1)
+    My_findable_stack<Corner_index> s_gate;
     
     // A vector stores the offset value for all the affected S operations 
     // Explain for std::pair type:
@@ -411,6 +377,21 @@ private:
     //      Second: the corresponding offset value
     std::vector<std::pair<int, int>> offset_vec;
     
+    // The S operation offset calculation method
+    S_offset_mode offset_mode;
+    
+    // The running op-code count used by the deferred offset calculation. It 
+    // is decreased by the growth of the bounding loop for each triangle 
+    // (C: -1, L/R: +1, E: +3, S: -1, M: -(hole length + 1))
+    int e_count;
+    
+    // Information of each S operation in offset_vec for the deferred offset 
+    // calculation
+    // Explain for std::pair type:
+    //      First: e_count right after the S operation
+    //      Second: the gate of the left side sub-loop
+    std::vector<std::pair<int, Corner_index>> open_s_vec;
+    
     // No. of boundary loops in current mesh
     int numBorderLoops;
     
@@ -426,7 +407,7 @@ private:
     // No. of S type triangles be skipped by the M' op-code
     int skip_h;
     
-    // Index of each vertex
+    // No. of vertices reached so far minus 1
     Vertex_index vertices_index;
     
     // Count for processed triangle
@@ -435,6 +416,9 @@ private:
     // Length of total coded data
     Vertex_index coded_data_len;
     
+    // The byte offset of each section of the EB stream
+    std::vector<Vertex_index> section_offsets;
+    
     // Length of connectivity part
     Vertex_index conn_str_len;
     
@@ -454,6 +438,9 @@ private:
     // No. of bits used to encode z coordinate
     int z_coor_bits;
     
+    // The binarization trees of x, y and z coordinates
+    Context_selector coor_context[3];
+    
     // A string stream stores the encoded integer geometry prediction errors of 
     // each mesh's vertex
     std::stringstream geom_out;
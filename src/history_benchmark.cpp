@@ -0,0 +1,129 @@
+#include "History_codec.hpp"
+#include <chrono>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+
+/*******************************************************************************
+Function: usage()
+@Description:
+    Print the usage info to the standard output stream
+*******************************************************************************/
+void usage() {
+    std::cout << "=============================================================================\n"
+              << "Usage:\n"
+              << "history_benchmark [OPTIONS] \n"
+              << "-n $count:   No. of op-codes in the generated history. If not specified,\n"
+              << "             default to 10000000.\n"
+              << "-k $repeat:  No. of times each coding pass is repeated. If not specified,\n"
+              << "             default to 5.\n"
+              << "-h:          Print the help info about the different command line options.  \n"
+              << "\n"
+              << "Measures the op-code history encoding and decoding throughput of each\n"
+              << "code series, in op-codes per second.\n"
+              << "=============================================================================\n";
+}
+
+
+/*******************************************************************************
+Function: generate_history(std::size_t count, std::vector<Triangle_type>& hist_vec)
+Description:
+    Generates a random op-code sequence. The op-codes follow the typical 
+    frequencies of a manifold triangle mesh (about half of the triangles are 
+    C type), and L or E type never follows a C type.
+    
+Parameter:
+    count: No. of op-codes to generate
+    hist_vec: The generated op-code sequence
+*******************************************************************************/
+void generate_history(std::size_t count, std::vector<Triangle_type>& hist_vec) {
+    std::mt19937 gen(1);
+    std::discrete_distribution<int> after_c({50, 0, 0, 40, 10});
+    std::discrete_distribution<int> after_other({50, 5, 5, 35, 5});
+    const Triangle_type opcodes[] = {C, L, E, R, S};
+    
+    hist_vec.resize(count);
+    Triangle_type prev_code = I;
+    for (std::size_t i = 0; i < count; ++i) {
+        int op = (prev_code == C) ? after_c(gen) : after_other(gen);
+        hist_vec[i] = opcodes[op];
+        prev_code = hist_vec[i];
+    }
+}
+
+
+/*******************************************************************************
+Function: main()
+@Description:
+    Main function for the op-code history coding benchmark
+*******************************************************************************/
+int main(int argc, char** argv) {
+    std::size_t count = 10000000;
+    int repeat = 5;
+    
+    int opt;
+    while ((opt = getopt(argc, argv, "n:k:h")) != EOF) {
+        switch (opt) {
+            case 'n':
+                count = std::stoul(optarg);
+                break;
+                
+            case 'k':
+                repeat = std::stoi(optarg);
+                break;
+                
+            case 'h':
+                usage();
+                return 0;
+                
+            default:
+                usage();
+                return 1;
+        }
+    }
+    
+    if (count == 0 || repeat <= 0) {
+        std::cerr << "ERROR: The op-code count and the repeat count must be positive\n";
+        return 1;
+    }
+    
+    std::vector<Triangle_type> history_vec;
+    generate_history(count, history_vec);
+    
+    std::cout << "op-codes: " << count << "\n";
+    for (int code_series = 1; code_series <= 3; ++code_series) {
+        double enc_time = 0.0, dec_time = 0.0;
+        std::size_t bit_cnt = 0;
+        
+        for (int k = 0; k < repeat; ++k) {
+            auto start_t = std::chrono::high_resolution_clock::now();
+            History_bit_writer writer;
+            encode_history(history_vec, code_series, writer);
+            writer.finish();
+            auto mid_t = std::chrono::high_resolution_clock::now();
+            
+            std::vector<Triangle_type> decoded_vec;
+            bool decoded = decode_history(writer.bytes().data(), writer.size(), code_series, 
+                                          decoded_vec);
+            auto end_t = std::chrono::high_resolution_clock::now();
+            
+            if (!decoded || decoded_vec != history_vec) {
+                std::cerr << "ERROR: Code series " << code_series << " round trip failed\n";
+                return 1;
+            }
+            
+            enc_time += std::chrono::duration<double>(mid_t - start_t).count();
+            dec_time += std::chrono::duration<double>(end_t - mid_t).count();
+            bit_cnt = writer.size();
+        }
+        
+        double total = static_cast<double>(count) * repeat;
+        std::cout << "code series " << code_series 
+                  << ": bits/op-code " << static_cast<double>(bit_cnt) / count
+                  << ", encode op-codes/s " << total / enc_time
+                  << ", decode op-codes/s " << total / dec_time << "\n";
+    }
+    
+    return 0;
+}
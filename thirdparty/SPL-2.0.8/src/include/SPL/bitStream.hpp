@@ -204,6 +204,10 @@ inline void BitStream::setIoStateBits(BitStream::IoState mask)
 
 /*!
  * @brief Input bit stream class
+ *
+ * The bit stream reads data from the underlying (character) stream up to
+ * eight bytes at a time, so the underlying stream may be positioned ahead
+ * of the bit stream.
  */
 
 class InputBitStream : public BitStream
@@ -289,6 +293,18 @@ public:
 	 */
 	long getBits(int numBits);
 
+	/*!
+	 * @brief Read the specified number of bytes from the bit stream.
+	 *
+	 * The bytes are read in the same order as by calling getBits(8) for
+	 * each byte, but the bit stream need not be byte aligned.
+	 * When the bit stream is byte aligned, the data is copied directly
+	 * from the underlying (character) stream.
+	 * This function returns a nonnegative value upon success and a
+	 * negative value if an error (e.g., EOF) is encountered.
+	 */
+	int getBytes(unsigned char* data, Size count);
+
 	////////////////////////////////////////////////////////////
 	// Alignment
 	////////////////////////////////////////////////////////////
@@ -321,13 +337,15 @@ private:
 	// prevent copy assignment.
 	InputBitStream& operator=(const InputBitStream&);
 	
+	// Read as many whole bytes as fit into the input buffer.
 	bool fillBuf();
 
 	// The underlying character stream.
 	std::istream* in_;
 
-	// The input buffer.
-	unsigned char buf_;
+	// The input buffer (the unread bits are the count_ least-significant
+	// bits).
+	unsigned long long buf_;
 
 	// The number of bits remaining before the buffer is empty.
 	int count_;
@@ -367,6 +385,10 @@ inline InputBitStream::Offset InputBitStream::getReadLimit() const
 
 /*!
  * @brief Output bit stream class
+ *
+ * The bit stream writes data to the underlying (character) stream up to
+ * eight bytes at a time.  All pending output is written when the bit stream
+ * is aligned or flushed.
  */
 
 class OutputBitStream : public BitStream
@@ -453,6 +475,18 @@ public:
 	 */
 	int putBits(long data, int numBits);
 
+	/*!
+	 * @brief Output the specified number of bytes to the bit stream.
+	 *
+	 * The bytes are written in the same order as by calling putBits(..., 8)
+	 * for each byte, but the bit stream need not be byte aligned.
+	 * When the bit stream is byte aligned, the data is copied directly to
+	 * the underlying (character) stream.
+	 * This function returns a nonnegative value upon success and a
+	 * negative value if an error is encountered.
+	 */
+	int putBytes(const unsigned char* data, Size count);
+
 	////////////////////////////////////////////////////////////
 	// Alignment and flushing
 	////////////////////////////////////////////////////////////
@@ -491,15 +525,19 @@ private:
 	// prevent copy assignment.
 	OutputBitStream& operator=(const OutputBitStream&);
 	
-	bool flushBuf();
+	// Write all of the whole bytes in the output buffer to the underlying
+	// stream.  If pad is true, the last partial byte is padded with zeros
+	// and written as well.
+	bool flushBuf(bool pad = true);
 
 	// The underlying character stream.
 	std::ostream* out_;
 
-	// The output buffer.
-	unsigned char buf_;
+	// The output buffer (the pending bits are the count_ least-significant
+	// bits).
+	unsigned long long buf_;
 
-	// The number of bits remaining before the buffer is full.
+	// The number of bits in the output buffer.
 	int count_;
 
 	// The number of bits written to the underlying stream.
@@ -26,6 +26,7 @@
 
 #include <SPL/config.hpp>
 #include <cstdlib>
+#include <algorithm>
 #include <cassert>
 #include <SPL/bitStream.hpp>
 
@@ -84,55 +85,105 @@ long InputBitStream::getBits(int numBits)
 #if defined(SPL_InputBitStream_Debug)
 	std::cerr << "getBits(" << numBits << ")" << "... ";
 #endif
-	long data = 0;
-	while (numBits > 0) {
-		if (count_ <= 0) {
-			if (!fillBuf()) {
+	unsigned long long data = 0;
+	if (numBits <= count_) {
+		// All of the bits are already in the input buffer.
+		count_ -= numBits;
+		data = (buf_ >> count_) & ((1ULL << numBits) - 1);
+	} else {
+		int remaining = numBits;
+		while (remaining > 0) {
+			if (count_ <= 0) {
+				if (!fillBuf()) {
 // XXXXXXXX
-				setIoStateBits(eofBit);
-				return -1;
+					setIoStateBits(eofBit);
+					return -1;
+				}
 			}
+			int n = std::min(count_, remaining);
+			count_ -= n;
+			data = (data << n) | ((buf_ >> count_) & ((1ULL << n) - 1));
+			remaining -= n;
 		}
-		int n = std::min<Size>(count_, numBits);
-		int v = (buf_ >> (count_ - n)) & ((1 << n) - 1);
-		data = (data << n) | v;
-		numBits -= n;
-		count_ -= n;
-		if (readLimit_ >= 0) {
-			readLimit_ = std::max<Offset>(readLimit_ - n, 0LL);
-		}
-		readCount_ += n;
 	}
+	if (readLimit_ >= 0) {
+		readLimit_ -= numBits;
+	}
+	readCount_ += numBits;
 #if defined(SPL_InputBitStream_Debug)
 	std::cerr << "returning " << std::hex << "0x" << data << std::dec << "\n";
 #endif
 	return data;
 }
 
+int InputBitStream::getBytes(unsigned char* data, Size count)
+{
+//	assert(isOkay());
+	if (readLimit_ >= 0 && 8 * count > static_cast<Size>(readLimit_)) {
+		setIoStateBits(limitBit);
+		return -1;
+	}
+	Size done = 0;
+	if (!(count_ % 8)) {
+		// The bit stream is byte aligned.  Take the whole bytes that are
+		// already in the input buffer, and copy the rest directly from the
+		// underlying stream.
+		while (done < count && count_ > 0) {
+			count_ -= 8;
+			data[done++] = buf_ >> count_;
+		}
+		if (done < count) {
+			in_->read(reinterpret_cast<char*>(data + done), count - done);
+			done += in_->gcount();
+		}
+	} else {
+		// The bit stream is not byte aligned.  Refill the input buffer
+		// a word at a time and shift the bytes out of it.
+		while (done < count) {
+			if (count_ < 8 && !fillBuf()) {
+				break;
+			}
+			while (done < count && count_ >= 8) {
+				count_ -= 8;
+				data[done++] = buf_ >> count_;
+			}
+		}
+	}
+	if (readLimit_ >= 0) {
+		readLimit_ -= 8 * done;
+	}
+	readCount_ += 8 * done;
+	if (done < count) {
+		setIoStateBits(eofBit | badBit);
+		return -1;
+	}
+	return 0;
+}
+
 void InputBitStream::align()
 {
 //	assert(isOkay());
-	count_ = 0;
-	buf_ = 0;
+	count_ -= count_ % 8;
 }
 
 bool InputBitStream::fillBuf()
 {
-	if (count_ <= 0) {
-		char c;
-		in_->get(c);
-		if (*in_) {
-			buf_ = c;
-			count_ = 8;
-		} else {
-			if (in_->eof()) {
-				setIoStateBits(eofBit);
-			}
-			setIoStateBits(badBit);
-			buf_ = 0;
-			count_ = 0;
+	// Read as many whole bytes as fit into the input buffer.
+	char data[8];
+	int numBytes = (64 - count_) / 8;
+	in_->read(data, numBytes);
+	int n = in_->gcount();
+	if (!n) {
+		if (in_->eof()) {
+			setIoStateBits(eofBit);
 		}
+		setIoStateBits(badBit);
+		return false;
+	}
+	for (int i = 0; i < n; ++i) {
+		buf_ = (buf_ << 8) | static_cast<unsigned char>(data[i]);
 	}
+	count_ += 8 * n;
 	return isOkay();
 }
 
@@ -182,7 +233,7 @@ void OutputBitStream::setOutput(std::ostream* out)
 {
 	out_ = out;
 	buf_ = 0;
-	count_ = 8;
+	count_ = 0;
 }
 
 std::ostream* OutputBitStream::getOutput() const
@@ -208,22 +259,86 @@ int OutputBitStream::putBits(long data, int numBits)
 		setIoStateBits(limitBit);
 		return -1;
 	}
-	while (numBits > 0) {
-		int n = std::min<Size>(count_, numBits);
-		int v = (data >> (numBits - n)) & ((1 << n) - 1);
-		buf_ = (buf_ & (~(((1 << n) - 1) << (count_ - n)))) | (v << (count_ - n));
-		count_ -= n;
-		numBits -= n;
-		writeCount_ += n;
-		if (writeLimit_ > 0) {
-			writeLimit_ = std::max<Offset>(0LL, writeLimit_ - n);
+	if (count_ + numBits < 64) {
+		// All of the bits fit into the output buffer.
+		buf_ = (buf_ << numBits) | data;
+		count_ += numBits;
+	} else {
+		// Fill up the output buffer, write it out, and keep the
+		// remaining bits.
+		int n = 64 - count_;
+		buf_ = (buf_ << n) | (data >> (numBits - n));
+		count_ = 64;
+		if (!flushBuf(false)) {
+			return -1;
 		}
-		if (count_ <= 0) {
-			if (!flushBuf()) {
+		buf_ = data & ((1ULL << (numBits - n)) - 1);
+		count_ = numBits - n;
+	}
+	writeCount_ += numBits;
+	if (writeLimit_ >= 0) {
+		writeLimit_ -= numBits;
+	}
+	return 0;
+}
+
+int OutputBitStream::putBytes(const unsigned char* data, Size count)
+{
+//	assert(isOkay());
+	if (writeLimit_ >= 0 && 8 * count > static_cast<Size>(writeLimit_)) {
+		setIoStateBits(limitBit);
+		return -1;
+	}
+	if (!flushBuf(false)) {
+		return -1;
+	}
+	Size done = 0;
+	if (!count_) {
+		// The bit stream is byte aligned.  Copy the data directly to the
+		// underlying stream.
+		out_->write(reinterpret_cast<const char*>(data), count);
+		if (!(*out_)) {
+			setIoStateBits(badBit);
+			return -1;
+		}
+		done = count;
+	} else {
+		// The bit stream is not byte aligned.  Shift the data a word at a
+		// time behind the pending bits, and write it out in chunks.
+		const int shift = count_;
+		char chunk[512];
+		while (count - done >= 8) {
+			int chunkLen = 0;
+			while (count - done >= 8 && chunkLen + 8 <= int(sizeof(chunk))) {
+				unsigned long long word = 0;
+				for (int i = 0; i < 8; ++i) {
+					word = (word << 8) | data[done + i];
+				}
+				unsigned long long outWord = (buf_ << (64 - shift)) |
+				  (word >> shift);
+				for (int i = 0; i < 8; ++i) {
+					chunk[chunkLen + i] = outWord >> (56 - 8 * i);
+				}
+				buf_ = word;
+				chunkLen += 8;
+				done += 8;
+			}
+			out_->write(chunk, chunkLen);
+			if (!(*out_)) {
+				setIoStateBits(badBit);
 				return -1;
 			}
 		}
 	}
+	// The last few bytes go into the output buffer.
+	for (; done < count; ++done) {
+		buf_ = (buf_ << 8) | data[done];
+		count_ += 8;
+	}
+	writeCount_ += 8 * count;
+	if (writeLimit_ >= 0) {
+		writeLimit_ -= 8 * count;
+	}
 	return 0;
 }
 
@@ -231,13 +346,21 @@ int OutputBitStream::putBits(long data, int numBits)
 // Alignment and flushing
 ////////////////////////////////////////////////////////////
 
-bool OutputBitStream::flushBuf()
+bool OutputBitStream::flushBuf(bool pad)
 {
+	char data[9];
+	int numBytes = 0;
+	while (count_ >= 8) {
+		count_ -= 8;
+		data[numBytes++] = buf_ >> count_;
+	}
+	if (pad && count_ > 0) {
+		data[numBytes++] = buf_ << (8 - count_);
+		count_ = 0;
+	}
 	// If the buffer is not empty...
-	if (count_ < 8) {
-		out_->put(buf_);
-		count_ = 8;
-		buf_ = 0;
+	if (numBytes > 0) {
+		out_->write(data, numBytes);
 		if (!(*out_)) {
 			setIoStateBits(badBit);
 			return false;